@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+#endif
+
+// One address returned by the resolver, for either address family
+struct ResolvedAddress {
+    struct sockaddr_storage addr {};
+    socklen_t length = 0;
+    int family = AF_UNSPEC;
+
+    const struct sockaddr* sockaddrPtr() const { return reinterpret_cast<const struct sockaddr*>(&addr); }
+
+    // Same address with a different port, e.g. the UDP endpoint of the TCP server
+    ResolvedAddress withPort(int port) const;
+
+    // Numeric form for logs, e.g. "[::1]:7777" or "127.0.0.1:7777"
+    std::string toString() const;
+
+    // True if a received sockaddr is this address
+    bool matches(const struct sockaddr_storage& other) const;
+};
+
+// Resolves host names with getaddrinfo on a worker thread so a slow resolver never
+// blocks the render thread. The owner polls once per frame.
+class AddressResolver {
+public:
+    enum class State {
+        IDLE,
+        RESOLVING,
+        RESOLVED,
+        FAILED
+    };
+
+    AddressResolver() = default;
+    ~AddressResolver();
+
+    AddressResolver(const AddressResolver&) = delete;
+    AddressResolver& operator=(const AddressResolver&) = delete;
+
+    // Start resolving host for a TCP port. Any earlier request is abandoned.
+    void start(const std::string& host, int port);
+
+    // Abandon the current request. getaddrinfo cannot be interrupted, so the worker
+    // finishes in the background and its result is discarded.
+    void cancel();
+
+    // Check on the current request
+    State poll();
+
+    // Addresses in connection order, families interleaved (RFC 8305 section 4)
+    const std::vector<ResolvedAddress>& getAddresses() const { return addresses; }
+    const std::string& getError() const { return error; }
+
+private:
+    // Shared with the worker thread, which may outlive a cancelled request
+    struct Request {
+        std::mutex mutex;
+        bool done = false;
+        std::vector<ResolvedAddress> addresses;
+        std::string error;
+    };
+
+    static void resolve(std::shared_ptr<Request> request, std::string host, int port);
+    static std::vector<ResolvedAddress> interleaveFamilies(const std::vector<ResolvedAddress>& input);
+
+    std::shared_ptr<Request> request;
+    State state = State::IDLE;
+    std::vector<ResolvedAddress> addresses;
+    std::string error;
+};
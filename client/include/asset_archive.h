@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "asset_format.h"
+
+// Read-only view of a packed asset archive, memory-mapped as a whole. Opening it
+// validates the header and where the index lies and touches nothing else; entries
+// are bounds-checked when they are looked up, and asset bytes are paged in
+// by the OS when first read. The mapping is shared, so every client on a machine,
+// windowed or headless, reads the same physical pages.
+class AssetArchive {
+public:
+    AssetArchive() = default;
+    ~AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    // Map an archive file. Returns false, with getError() set, if it is missing or malformed.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // Index entry for a name, or null if it is missing or points outside the file
+    const AssetIndexEntry* find(std::string_view name) const;
+
+    // Bytes of an entry, pointing into the mapping; empty if it points outside the file
+    std::string_view data(const AssetIndexEntry& entry) const;
+    std::string_view name(const AssetIndexEntry& entry) const;
+
+    size_t getEntryCount() const { return entryCount; }
+    const AssetIndexEntry* entries() const { return index; }
+    size_t getMappedBytes() const { return size; }
+    const std::string& getError() const { return error; }
+
+private:
+    bool fail(const std::string& message);
+    bool inBounds(const AssetIndexEntry& entry) const;
+
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    const AssetIndexEntry* index = nullptr;
+    size_t entryCount = 0;
+    std::string error;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
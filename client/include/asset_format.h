@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// On-disk layout of a packed asset archive (.gmpk), shared by the client and the
+// asset_packer tool. All integers are little-endian.
+//
+//   AssetArchiveHeader
+//   AssetIndexEntry[entryCount]     sorted by nameHash, then name
+//   name strings                    not terminated; referenced by offset and length
+//   asset data                      each blob aligned to ASSET_DATA_ALIGNMENT
+//
+// The index is searched in place from the mapped file and entries are bounds-checked
+// as they are looked up, so opening an archive costs the same however many assets it
+// holds.
+
+constexpr char ASSET_ARCHIVE_MAGIC[4] = { 'G', 'M', 'P', 'K' };
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+constexpr uint64_t ASSET_DATA_ALIGNMENT = 16;
+
+enum class AssetType : uint32_t {
+    RAW = 0,        // Bytes handed to the caller as they are
+    IMAGE = 1,      // Encoded image (png, bmp, qoi, ...) decoded to a texture
+    FONT = 2        // TrueType/OpenType font decoded to a raylib Font
+};
+
+struct AssetArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+    uint64_t fileSize;
+};
+
+struct AssetIndexEntry {
+    uint64_t nameHash;
+    uint64_t nameOffset;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint32_t nameLength;
+    AssetType type;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 32, "archive header layout changed");
+static_assert(sizeof(AssetIndexEntry) == 40, "archive index layout changed");
+
+// 64-bit FNV-1a of an asset name
+inline uint64_t hashAssetName(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <raylib.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "asset_archive.h"
+
+// Textures and fonts backed by a packed asset archive. Nothing is decoded at open;
+// each asset is decoded from the mapped bytes the first time it is asked for and kept
+// until unloadAll(). Decoding needs a graphics context, so headless clients only use
+// the archive's raw bytes.
+class AssetManager {
+public:
+    AssetManager() = default;
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Map an archive; decoded assets from a previous archive are released
+    bool open(const std::string& path);
+    bool isOpen() const { return archive.isOpen(); }
+
+    // Decoded on first use; null if the asset is missing or fails to decode
+    const Texture2D* getTexture(std::string_view name);
+    const Font* getFont(std::string_view name, int size);
+
+    // Undecoded bytes, valid while the archive stays open
+    std::string_view getRaw(std::string_view name) const;
+
+    // Release every decoded asset. Must run before the window closes.
+    void unloadAll();
+
+    const AssetArchive& getArchive() const { return archive; }
+    size_t getDecodedCount() const { return textures.size() + fonts.size(); }
+
+private:
+    // Image decoders are picked by file extension, e.g. ".png"
+    static std::string fileExtension(std::string_view name);
+
+    AssetArchive archive;
+    std::unordered_map<std::string, Texture2D> textures;
+    std::unordered_map<std::string, Font> fonts;    // keyed by "name@size"
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "network.h"
+
+// Streams tiled map chunks from the server and keeps them as GPU textures, one texel
+// per tile, in an LRU cache with a memory budget. Chunks around the camera and ahead
+// of its movement are requested on demand, so world size costs neither startup time
+// nor unbounded memory.
+class ChunkCache {
+public:
+    explicit ChunkCache(size_t memoryBudgetBytes = 16 * 1024 * 1024);
+    ~ChunkCache();
+
+    ChunkCache(const ChunkCache&) = delete;
+    ChunkCache& operator=(const ChunkCache&) = delete;
+
+    // Decode a chunk from the server into a texture
+    void store(const ChunkData& chunk);
+
+    // Keep the chunks under the view resident and request missing ones, nearest first,
+    // including the area the view will cover after lookAheadSeconds at velocity
+    void update(NetworkClient& network, const std::string& mapId, Rectangle view, Vector2 velocity);
+
+    // Request the chunks around a position on a map we are about to enter
+    void prefetch(NetworkClient& network, const std::string& mapId, Vector2 position, Vector2 viewSize);
+
+    // Draw the cached chunks overlapping the view, in world coordinates
+    void draw(const std::string& mapId, Rectangle view) const;
+
+    // Unload every texture and forget pending requests
+    void clear();
+
+    // World size in pixels once the server has described the map, else zero
+    Vector2 getWorldSize(const std::string& mapId) const;
+
+    // Metrics
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getChunkCount() const { return entries.size(); }
+    size_t getPendingCount() const { return pending.size(); }
+    uint64_t getEvictions() const { return evictions; }
+
+private:
+    struct ChunkKey {
+        std::string mapId;
+        int cx = 0;
+        int cy = 0;
+
+        bool operator==(const ChunkKey& other) const {
+            return cx == other.cx && cy == other.cy && mapId == other.mapId;
+        }
+    };
+
+    struct ChunkKeyHash {
+        size_t operator()(const ChunkKey& key) const;
+    };
+
+    struct Entry {
+        ChunkKey key;
+        Texture2D texture{};
+        bool hasTexture = false;    // False for chunks outside the map
+        size_t bytes = 0;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    // Map geometry as reported by the server
+    struct MapInfo {
+        int chunkSize = 32;         // tiles per chunk side
+        int tileSize = 32;          // pixels per tile
+        int width = 0;              // map size in chunks, 0 while unknown
+        int height = 0;
+    };
+
+    const MapInfo& mapInfo(const std::string& mapId) const;
+
+    // Request the chunks overlapping area that are neither cached nor in flight
+    void requestArea(NetworkClient& network, const std::string& mapId, Rectangle area, double now);
+
+    // Drop least recently used chunks not needed this frame until under budget
+    void evict();
+
+    void unload(Entry& entry);
+
+    size_t memoryBudgetBytes;
+    size_t bytesUsed = 0;
+    uint64_t frame = 0;
+    uint64_t evictions = 0;
+
+    std::list<Entry> entries;       // Most recently used first
+    std::unordered_map<ChunkKey, std::list<Entry>::iterator, ChunkKeyHash> index;
+    std::unordered_map<ChunkKey, double, ChunkKeyHash> pending;     // Request time
+    std::unordered_map<std::string, MapInfo> maps;
+
+    const size_t maxPendingRequests = 16;
+    const double requestTimeout = 2.0;      // seconds before asking again
+    const float lookAheadSeconds = 0.75f;
+};
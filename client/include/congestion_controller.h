@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <cstdint>
+#include "sequence.h"
+
+// Bounds and tuning for the state send rate
+struct CongestionConfig {
+    double minRateHz = 5.0;         // floor under heavy congestion
+    double maxRateHz = 30.0;        // ceiling with a clean link
+    double initialRateHz = 20.0;
+    double lossThreshold = 0.05;    // loss ratio treated as congestion
+    double queueingDelayMs = 40.0;  // RTT above the path minimum treated as congestion
+};
+
+// Adapts how often state is sent to what the link can carry (AIMD, as TCP does).
+//
+// Every state packet is tracked until the server acknowledges it, which yields an RTT
+// sample, or until it is written off as lost. Once per evaluation period the loss
+// ratio and the smoothed RTT's rise over the lowest RTT seen recently are checked:
+// either above its threshold cuts the rate multiplicatively, otherwise it grows by a
+// fixed step. Rising RTT shows a filling queue before packets start dropping, so the
+// rate usually backs off before loss.
+class CongestionController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CongestionController(const CongestionConfig& config = CongestionConfig());
+
+    void configure(const CongestionConfig& config);
+
+    // A state packet identified by sequence was sent
+    void onSent(SequenceNumber sequence, Clock::time_point now);
+
+    // The server acknowledged sequence; older unacknowledged packets count as lost
+    void onAcked(SequenceNumber sequence, Clock::time_point now);
+
+    // Re-evaluate the rate if a period has passed
+    void update(Clock::time_point now);
+
+    // Seconds between state sends
+    double getSendInterval() const { return 1.0 / rateHz; }
+
+    // Metrics
+    double getRateHz() const { return rateHz; }
+    double getSmoothedRttMs() const { return smoothedRttMs; }
+    double getMinRttMs() const { return minRttMs; }
+    double getLossRatio() const { return lastLossRatio; }
+    uint64_t getBackoffCount() const { return backoffCount; }
+
+    void reset();
+
+private:
+    struct SentPacket {
+        SequenceNumber sequence;
+        Clock::time_point sentAt;
+    };
+
+    void addRttSample(double sampleMs, Clock::time_point now);
+
+    CongestionConfig config;
+    double rateHz;
+
+    std::deque<SentPacket> inFlight;
+
+    // Current evaluation period
+    Clock::time_point periodStart;
+    bool periodStarted = false;
+    uint32_t periodAcked = 0;
+    uint32_t periodLost = 0;
+
+    // RTT estimate and the path minimum it is compared against
+    bool hasRttSample = false;
+    double smoothedRttMs = 0.0;
+    double minRttMs = 0.0;
+    Clock::time_point minRttTime;
+
+    double lastLossRatio = 0.0;
+    uint64_t backoffCount = 0;
+};
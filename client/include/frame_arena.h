@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <nlohmann/json_fwd.hpp>
+
+// Bump allocator for objects that live no longer than one network frame: decoded
+// JSON documents, parsed fields and temporary lists. Allocation is a pointer bump,
+// deallocation is free, and reset() reclaims everything at once while keeping the
+// blocks, so steady-state decoding stops touching the heap after the first frames.
+class FrameArena {
+public:
+    explicit FrameArena(size_t blockSize = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Carve out size bytes; never returns null
+    void* allocate(size_t size, size_t alignment);
+
+    // Reclaim every allocation. Blocks are kept for the next frame.
+    void reset();
+
+    // Metrics
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getHighWaterBytes() const { return highWaterBytes; }
+    size_t getBlockCount() const { return blocks.size(); }
+    uint64_t getHeapAllocations() const { return heapAllocations; }
+
+    // Arena that ArenaAllocator draws from on this thread, or null for the heap
+    static FrameArena* current();
+
+    // Makes an arena current for its lifetime and resets it on exit, so everything
+    // decoded inside the scope is released when the frame ends
+    class FrameScope {
+    public:
+        explicit FrameScope(FrameArena& arena);
+        ~FrameScope();
+
+        FrameScope(const FrameScope&) = delete;
+        FrameScope& operator=(const FrameScope&) = delete;
+
+    private:
+        FrameArena& arena;
+        FrameArena* previous;
+    };
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    void addBlock(size_t minimumSize);
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t activeBlock = 0;
+    size_t bytesUsed = 0;
+    size_t highWaterBytes = 0;
+    uint64_t heapAllocations = 0;
+};
+
+// Standard allocator over the FrameArena current when it is constructed; with none
+// current it uses the heap. The arena pointer records where the memory came from, so
+// deallocation is a single branch. nlohmann::json default-constructs a fresh allocator
+// for each node it frees, which picks up whatever is current then: FrameJson values
+// must therefore be created and destroyed inside the same FrameScope, or both outside
+// any, as the decoders in NetworkClient::update() are.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena(FrameArena::current()) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        if (arena) {
+            return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        // Arena memory is reclaimed by reset(), never one allocation at a time
+        if (!arena) {
+            ::operator delete(ptr);
+        }
+    }
+
+    FrameArena* getArena() const noexcept { return arena; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.getArena(); }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.getArena(); }
+
+private:
+    FrameArena* arena;
+};
+
+// Frame-lifetime string and JSON document types used by message decoding
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+using FrameJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool, std::int64_t,
+                                       std::uint64_t, double, ArenaAllocator>;
@@ -8,6 +8,8 @@
 #include "network.h"
 #include "ui_manager.h"
 #include "player_manager.h"
+#include "chunk_cache.h"
+#include "asset_manager.h"
 #include "color_utils.h"
 
 // Constants
@@ -39,9 +41,66 @@ public:
         udpPort = udp;
     }
     
+    // Largest UDP datagram to send and uplink budget in bytes per second (0 for
+    // unlimited), applied in init()
+    void setNetworkConfig(int datagramSize, int uplinkBytesPerSecond) {
+        maxDatagramSize = datagramSize;
+        uplinkRate = uplinkBytesPerSecond;
+    }
+    
+    // Bounds for the adaptive state send rate, applied in init()
+    void setSendRateBounds(double minHz, double maxHz) {
+        congestionConfig.minRateHz = minHz;
+        congestionConfig.maxRateHz = maxHz;
+    }
+    
+    // Simulated network impairments, applied in init()
+    void setNetworkConditions(const NetworkConditions& conditions) {
+        networkConditions = conditions;
+    }
+    
+    // Socket I/O backend, applied in init()
+    void setIoBackendKind(IoBackendKind kind) {
+        ioBackendKind = kind;
+    }
+    
+    // Per-frame bound on handling server messages, applied in init()
+    void setProcessingBudget(const ProcessingBudget& budget) {
+        processingBudget = budget;
+    }
+    
+    // Simulation and render rates, applied in init(). targetFps 0 renders uncapped.
+    void setSimulationConfig(int ticksPerSecond, int fps, bool useVsync) {
+        tickRate = ticksPerSecond > 0 ? ticksPerSecond : 60;
+        targetFps = fps;
+        vsync = useVsync;
+    }
+    
+    // Capture configuration, applied in init()
+    void setCaptureConfig(const std::string& recordFile, const std::string& replayFile, ReplaySpeed speed) {
+        recordPath = recordFile;
+        replayPath = replayFile;
+        replaySpeed = speed;
+    }
+    
+    // CSV file for input-to-echo latency percentiles, opened in init(). Empty disables it.
+    void setLatencyLogPath(const std::string& path) {
+        latencyLogPath = path;
+    }
+    
+    // Packed asset archive, mapped in init(). A missing archive is not an error.
+    void setAssetPath(const std::string& path) {
+        assetPath = path;
+    }
+    
+    // Assets decoded on first use from the mapped archive
+    AssetManager& getAssets() { return assets; }
+    
 private:
     // Game loop functions
     void update();
+    void updateNetwork();
+    void tick();
     void render();
     void handleInput();
     
@@ -59,6 +118,11 @@ private:
     // Chat handling
     void processChatInput();
     
+    // World view
+    void updateCamera(float targetX, float targetY);
+    Rectangle getCameraView() const;
+    void changeMap(const std::string& mapId);
+    
     // Variables
     GameState state = GameState::INPUT_NAME;
     bool isRunning = false;
@@ -72,12 +136,31 @@ private:
     std::string serverAddress = "127.0.0.1";
     int tcpPort = 9999;
     int udpPort = 9998;
+    int maxDatagramSize = 1200;
+    int uplinkRate = 0;
+    std::string recordPath;
+    std::string latencyLogPath;
+    std::string replayPath;
+    ReplaySpeed replaySpeed = ReplaySpeed::REALTIME;
+    std::string assetPath;
     char nameInput[32] = { 0 };
     int nameLength = 0;
     
+    // Fixed-timestep simulation
+    int tickRate = 60;                  // simulation ticks per second
+    int targetFps = 60;                 // render cap, 0 for uncapped
+    bool vsync = false;
+    double tickInterval = 1.0 / 60.0;
+    double accumulator = 0.0;
+    double lastFrameTime = 0.0;
+    const double maxFrameTime = 0.25;   // longest frame fed to the simulation at once
+    
     // Synchronization
-    float syncTimer = 0.0f;
-    float syncInterval = 0.05f; // 50ms = 20 times per second
+    int ticksSinceSync = 0;
+    CongestionConfig congestionConfig;
+    NetworkConditions networkConditions;
+    IoBackendKind ioBackendKind = IoBackendKind::AUTO;
+    ProcessingBudget processingBudget;
     float correctionTimer = 0.0f;
     float correctionInterval = 0.01f; // 10ms = 100 times per second
     
@@ -97,4 +180,9 @@ private:
     
     // Player management
     std::unique_ptr<PlayerManager> playerManager;
+    
+    // World rendering
+    Camera2D camera = {};
+    std::unique_ptr<ChunkCache> chunkCache;
+    AssetManager assets;
 }; 
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Server messages read from the transport but not handled yet. NetworkClient reads
+// everything available each update(), queues it here, and handles messages in arrival
+// order until its processing budget runs out; the rest carries over to the next update.
+//
+// State that a newer message replaces outright is dropped on arrival, before anything
+// decodes it: a player snapshot (PLAYERS, GAME_STATE) supersedes every snapshot still
+// queued ahead of it. Deltas between them are kept, since a snapshot may not list the
+// players they are about. Everything else is handled, in order.
+//
+// Messages are stored back to back in one buffer that is reused once drained, so
+// queueing doesn't allocate per message.
+class InboundBacklog {
+public:
+    // Queue one message, without its newline
+    void push(std::string_view message);
+
+    // Copy out the oldest message, reusing message's capacity
+    bool pop(std::string& message);
+
+    // Drop everything queued, e.g. on disconnect
+    void clear();
+
+    bool empty() const { return head == entries.size(); }
+
+    // Metrics
+    size_t getQueuedMessages() const { return entries.size() - head; }
+    size_t getQueuedBytes() const { return queuedBytes; }
+    size_t getPeakMessages() const { return peakMessages; }
+    uint64_t getSupersededCount() const { return supersededCount; }
+
+private:
+    struct Entry {
+        size_t offset;      // into buffer
+        size_t length;
+        bool snapshot;      // Full player list
+    };
+
+    static bool isSnapshot(std::string_view message);
+
+    // Drop the bytes and entries already popped when they are most of the backlog
+    void compact();
+
+    std::string buffer;
+    std::vector<Entry> entries;
+    size_t head = 0;        // oldest entry not popped yet
+    size_t queuedBytes = 0;
+    size_t snapshotCount = 0;
+    size_t peakMessages = 0;
+
+    uint64_t supersededCount = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include "transport.h"
+#include "address_resolver.h"
+#include "io_backend.h"
+
+// TCP stream and UDP datagrams to a host name or IP. The name is resolved off-thread
+// and every resolved address is raced for the TCP connection (RFC 8305 happy
+// eyeballs); the UDP socket then uses the family and address that won. Once
+// connected, receives and datagram sends go through the I/O backend.
+class InetTransport : public Transport {
+public:
+    InetTransport(std::string host, int tcpPort, int udpPort, std::shared_ptr<IoBackend> io);
+    ~InetTransport() override;
+
+    bool open() override;
+    State poll() override;
+    void disconnect() override;
+
+    TcpOutboundQueue::FlushResult flushStream(TcpOutboundQueue& queue) override;
+    int receiveStream(char* buffer, size_t size) override;
+
+    bool sendDatagram(std::string_view datagram) override;
+    int receiveDatagram(char* buffer, size_t size) override;
+
+    std::string describePeer() const override { return serverTcpAddr.toString(); }
+
+private:
+    struct ConnectAttempt {
+        socket_t socket = INVALID_SOCKET;
+        ResolvedAddress address;
+    };
+
+    bool startNextConnectAttempt();
+    State completeConnectAttempt(size_t index);
+    State fail(const std::string& message);
+    void closeConnectAttempts();
+
+    std::string host;
+    int tcpPort;
+    int udpPort;
+    std::shared_ptr<IoBackend> io;
+    State state = State::CONNECTING;
+
+    socket_t tcpSocket = INVALID_SOCKET;
+    socket_t udpSocket = INVALID_SOCKET;
+    ResolvedAddress serverTcpAddr;
+    ResolvedAddress serverUdpAddr;
+
+    // Off-thread name resolution and connection racing
+    AddressResolver resolver;
+    std::vector<ResolvedAddress> connectCandidates;
+    size_t nextConnectCandidate = 0;
+    std::vector<ConnectAttempt> connectAttempts;
+    std::chrono::steady_clock::time_point connectStartTime;
+    std::chrono::steady_clock::time_point lastConnectAttemptTime;
+    const int connectAttemptDelayMs = 250; // head start each address gets before the next one races it
+    const int connectTimeoutSeconds = 10;
+};
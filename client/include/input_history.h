@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include "sequence.h"
+
+// Movement buttons held during one simulation tick
+enum InputButton : uint8_t {
+    INPUT_UP = 1,
+    INPUT_DOWN = 2,
+    INPUT_LEFT = 4,
+    INPUT_RIGHT = 8
+};
+
+// Input sampled at one simulation tick
+struct InputCommand {
+    SequenceNumber tick = 0;
+    uint8_t buttons = 0;
+    std::chrono::steady_clock::time_point sampledAt;
+};
+
+// Inputs the server has not acknowledged yet. Every INPUT datagram carries all of
+// them, so a lost datagram is covered by the next one without a retransmit round
+// trip. Once capacity inputs are waiting no more are recorded until the server
+// acknowledges some: dropping the oldest instead would leave ticks the server never
+// simulates, and the client's position would drift from it for good.
+class InputHistory {
+public:
+    explicit InputHistory(size_t capacity = 128) : capacity(capacity) {}
+
+    // Record this tick's input under the next sequence number; false if full
+    bool record(uint8_t buttons, std::chrono::steady_clock::time_point sampledAt) {
+        if (full()) {
+            return false;
+        }
+        commands.push_back({ ++latestTick, buttons, sampledAt });
+        return true;
+    }
+
+    bool full() const { return commands.size() >= capacity; }
+
+    // Drop every input up to and including tick; false for an ack no newer than the last
+    bool acknowledge(SequenceNumber tick) {
+        if (acked && !sequenceGreaterThan(tick, lastAcked)) {
+            return false;
+        }
+        acked = true;
+        lastAcked = tick;
+        
+        while (!commands.empty() && !sequenceGreaterThan(commands.front().tick, tick)) {
+            commands.pop_front();
+        }
+        return true;
+    }
+
+    // Unacknowledged inputs, oldest first, with consecutive ticks
+    const std::deque<InputCommand>& pending() const { return commands; }
+
+    void reset() {
+        commands.clear();
+        acked = false;
+    }
+
+private:
+    size_t capacity;
+    std::deque<InputCommand> commands;
+    SequenceNumber latestTick = 0;
+    SequenceNumber lastAcked = 0;
+    bool acked = false;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "transport.h"
+
+// System interface that moves socket data
+enum class IoBackendKind {
+    AUTO,       // the best one this build and kernel allow
+    IO_URING,   // Linux io_uring, in builds with GM_HAVE_IO_URING
+    EPOLL,      // Linux readiness notification
+    SELECT      // portable fallback
+};
+
+// Name for logs and the command line, and the reverse
+const char* ioBackendName(IoBackendKind kind);
+bool parseIoBackendKind(std::string_view name, IoBackendKind& kind);
+
+// Receives and datagram sends for connected non-blocking sockets, batched so a frame
+// with nothing to read costs no receive syscalls and a frame's datagrams go out
+// together. Transports register their sockets once connected; the network client
+// calls poll() before reading and submit() after its last send of the frame.
+//
+// One backend can be shared by every client a process runs on one thread, e.g. a bot
+// host, so they share one ring and buffer pool. The host then calls poll() and
+// submit() once per frame around all of its clients instead of each client doing it
+// (NetworkClient::setIoBackend(backend, true)). Not thread-safe.
+class IoBackend {
+public:
+    // receive() results besides a byte count, matching Transport's stream results
+    static constexpr int RECEIVE_EMPTY = 0;     // nothing waiting
+    static constexpr int RECEIVE_CLOSED = -1;   // the peer closed the stream
+    static constexpr int RECEIVE_FAILED = -2;   // the socket failed
+
+    virtual ~IoBackend() = default;
+
+    // The preferred backend, or the next one down when this build or kernel lacks it
+    static std::shared_ptr<IoBackend> create(IoBackendKind preferred = IoBackendKind::AUTO);
+
+    virtual IoBackendKind getKind() const = 0;
+
+    // Start or stop watching a socket. remove() must come before the socket is closed;
+    // it also drops datagrams still queued for it.
+    virtual bool add(socket_t socket, bool datagram) = 0;
+    virtual void remove(socket_t socket) = 0;
+
+    // Collect what arrived since the last call, without blocking
+    virtual void poll() = 0;
+
+    // Next bytes from a stream socket, or the next datagram and its sender
+    virtual int receive(socket_t socket, char* buffer, size_t size) = 0;
+    virtual int receiveFrom(socket_t socket, char* buffer, size_t size, sockaddr_storage& sender) = 0;
+
+    // Queue a datagram; submit() sends everything queued in as few syscalls as the
+    // backend allows
+    void sendTo(socket_t socket, std::string_view datagram, const sockaddr* address, socklen_t length);
+    virtual void submit() = 0;
+
+    // Receive and send syscalls made so far, for comparing backends
+    uint64_t getSyscallCount() const { return syscallCount; }
+
+protected:
+    struct PendingDatagram {
+        socket_t socket = INVALID_SOCKET;
+        std::string data;
+        sockaddr_storage address{};
+        socklen_t length = 0;
+    };
+
+    // Forget queued datagrams for a socket that is going away
+    void dropPending(socket_t socket);
+
+    std::vector<PendingDatagram> pendingDatagrams;
+    uint64_t syscallCount = 0;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#ifdef GM_HAVE_IO_URING
+
+#include <deque>
+#include <unordered_map>
+#include <linux/io_uring.h>
+#include "io_backend.h"
+
+// io_uring without liburing. Each watched socket has one multishot receive armed
+// (RECV for streams, RECVMSG for datagrams, to keep the sender) that fills buffers the
+// kernel picks from a registered buffer ring, so data arrives without any receive
+// syscall and poll() only reads the completion queue. submit() turns the frame's
+// datagrams into SENDMSG entries and hands them over in one io_uring_enter().
+//
+// Receive buffers are 8 KB; a larger datagram is dropped. A socket whose multishot
+// receive the kernel rejects is read with plain non-blocking calls instead.
+class IoUringBackend : public IoBackend {
+public:
+    // Null when the kernel refuses io_uring or provided buffer rings (5.19 and later)
+    static std::shared_ptr<IoUringBackend> create();
+    ~IoUringBackend() override;
+
+    IoBackendKind getKind() const override { return IoBackendKind::IO_URING; }
+
+    bool add(socket_t socket, bool datagram) override;
+    void remove(socket_t socket) override;
+
+    void poll() override;
+
+    int receive(socket_t socket, char* buffer, size_t size) override;
+    int receiveFrom(socket_t socket, char* buffer, size_t size, sockaddr_storage& sender) override;
+
+    void submit() override;
+
+private:
+    struct ReceivedDatagram {
+        std::string data;
+        sockaddr_storage sender{};
+    };
+
+    struct Watched {
+        uint64_t registration = 0;  // user_data of its multishot receive
+        bool datagram = false;
+        bool armed = false;         // a multishot receive is outstanding
+        bool direct = false;        // multishot was rejected; read with plain calls
+        bool closed = false;
+        bool failed = false;
+        msghdr message{};           // RECVMSG layout; must outlive the request
+        std::string stream;         // stream bytes received and not yet read
+        size_t streamOffset = 0;
+        std::deque<ReceivedDatagram> datagrams;
+    };
+
+    // A SENDMSG in flight; the kernel reads it until its completion arrives
+    struct SendSlot {
+        std::string data;
+        sockaddr_storage address{};
+        iovec vector{};
+        msghdr message{};
+    };
+
+    IoUringBackend() = default;
+    bool setup();
+
+    io_uring_sqe* nextSqe();
+    int enter(unsigned minComplete, unsigned flags);
+    void arm(socket_t socket, Watched& watched);
+    void reap();
+    void handleReceive(const io_uring_cqe& cqe);
+    void recycleBuffer(uint16_t bufferId);
+    void publishBuffers();
+
+    int ringFd = -1;
+
+    // Submission and completion rings, shared with the kernel
+    void* ringMemory = nullptr;
+    size_t ringSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqFlags = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned sqLocalTail = 0;       // entries prepared, published on enter()
+    unsigned sqSubmitted = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    // Provided buffer ring and the memory behind it
+    io_uring_buf* bufferRing = nullptr;
+    size_t bufferRingSize = 0;
+    uint16_t bufferTail = 0;
+    char* bufferPool = nullptr;
+    size_t bufferPoolSize = 0;
+
+    std::unordered_map<socket_t, Watched> sockets;
+    std::unordered_map<uint64_t, socket_t> registrations;
+    uint64_t nextRegistration = 1;
+
+    std::vector<std::unique_ptr<SendSlot>> sendSlots;
+    std::vector<uint32_t> freeSendSlots;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "sequence.h"
+
+// Latency distribution in microseconds with bounded relative error, in the style of
+// HdrHistogram. Values below 128 us are counted exactly; above that each power of
+// two is split into 64 buckets, so any recorded value is reported within 1/64
+// (about 1.6%) of its true value while the whole range up to a minute takes about ten
+// kilobytes. Recording never allocates.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t micros);
+
+    // Smallest value that percentile (0-100) of the samples are at or below
+    uint64_t valueAtPercentile(double percentile) const;
+
+    uint64_t getCount() const { return count; }
+    uint64_t getMax() const { return maxValue; }
+    double getMean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+
+    void reset();
+
+private:
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t highestEquivalentValue(size_t index);
+
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+};
+
+// Parts of the path from a sampled input to the server's echo of it
+enum class LatencySegment {
+    SEND_QUEUE,     // input sampled until its datagram is handed to the socket
+    NETWORK,        // round trip on the wire, server time excluded
+    SERVER,         // server receipt until its acknowledgement is queued
+    END_TO_END,     // input sampled until the acknowledgement arrives
+    COUNT
+};
+
+// Times every INPUT from the tick it was sampled on to the server's INPUT_ACK.
+//
+// INPUT carries the sample time of its newest tick and the acknowledgement echoes
+// it, together with how long the server held the message, so the end-to-end time
+// needs no client state. When the datagram left is tracked here per sequence to
+// split the rest into send queue and network time. Optionally writes each interval's
+// percentiles to a CSV file and starts the next interval from empty histograms.
+class LatencyStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ~LatencyStats();
+
+    // Microseconds on the client clock, as sent in INPUT's "t"
+    static uint64_t toMicros(Clock::time_point time);
+
+    // An INPUT for sequence, sampled at sampledAt, was queued. A newer one queued
+    // before the flush replaces it, as it does in the outbound scheduler.
+    void onInputQueued(SequenceNumber sequence, Clock::time_point sampledAt);
+
+    // The queued INPUT was written to the transport
+    void onInputSent(Clock::time_point now);
+
+    // INPUT_ACK for sequence arrived with the echoed sample time and server hold time
+    void onInputAcked(SequenceNumber sequence, uint64_t echoedMicros, uint64_t serverMicros, Clock::time_point now);
+
+    // Log interval percentiles to a CSV file
+    bool startLog(const std::string& path, std::chrono::seconds interval = std::chrono::seconds(10));
+    void stopLog();
+
+    // Write the interval's row once it has elapsed
+    void update(Clock::time_point now);
+
+    const LatencyHistogram& getHistogram(LatencySegment segment) const {
+        return histograms[static_cast<size_t>(segment)];
+    }
+
+    // Forget inputs in flight, e.g. on disconnect; recorded samples are kept
+    void resetInFlight();
+
+private:
+    struct SentInput {
+        SequenceNumber sequence;
+        Clock::time_point sampledAt;
+        Clock::time_point sentAt;
+    };
+
+    void writeInterval(Clock::time_point now);
+
+    std::array<LatencyHistogram, static_cast<size_t>(LatencySegment::COUNT)> histograms;
+
+    bool hasQueued = false;
+    SequenceNumber queuedSequence = 0;
+    Clock::time_point queuedSampledAt;
+    std::deque<SentInput> inFlight;
+
+    std::ofstream log;
+    std::chrono::seconds logInterval{ 10 };
+    Clock::time_point intervalStart;
+    Clock::time_point logStart;
+};
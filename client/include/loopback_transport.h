@@ -0,0 +1,77 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include "transport.h"
+
+// Address scheme that selects the in-process transport, e.g. "loopback:stub"
+constexpr std::string_view LOOPBACK_ADDRESS_PREFIX = "loopback:";
+
+// Both directions of one in-process connection: stream bytes and datagrams each way
+struct LoopbackLink {
+    std::string stream[2];
+    size_t streamOffset[2] = { 0, 0 };      // bytes of stream[i] already read
+    std::deque<std::string> datagrams[2];
+    bool closed[2] = { false, false };      // that side disconnected
+};
+
+// Both channels through memory to a LoopbackListener in the same process, with no
+// sockets or syscalls, so client and server can run in one thread for tests and
+// benchmarks. Selected with a "loopback:<name>" address; ports are ignored.
+//
+// Nothing is lost or reordered. As with a full socket buffer, the stream stops taking
+// bytes and new datagrams are dropped while the peer is too far behind.
+class LoopbackTransport : public Transport {
+public:
+    // Client end, connected on open()
+    explicit LoopbackTransport(std::string name);
+
+    // Server end of an accepted link, connected already
+    LoopbackTransport(std::string name, std::shared_ptr<LoopbackLink> link, int side);
+
+    ~LoopbackTransport() override;
+
+    bool open() override;
+    State poll() override { return state; }
+    void disconnect() override;
+
+    TcpOutboundQueue::FlushResult flushStream(TcpOutboundQueue& queue) override;
+    int receiveStream(char* buffer, size_t size) override;
+
+    bool sendDatagram(std::string_view datagram) override;
+    int receiveDatagram(char* buffer, size_t size) override;
+
+    std::string describePeer() const override { return std::string(LOOPBACK_ADDRESS_PREFIX) + name; }
+
+private:
+    std::string name;
+    State state = State::CONNECTING;
+    std::shared_ptr<LoopbackLink> link;
+    int side = 0;   // 0 writes stream[0] and reads stream[1]; the server end is 1
+};
+
+// Server end of "loopback:<name>": registers the name while it lives and hands out one
+// transport per client that opens it. Single-threaded, like the rest of the client.
+class LoopbackListener {
+public:
+    explicit LoopbackListener(std::string name);
+    ~LoopbackListener();
+
+    LoopbackListener(const LoopbackListener&) = delete;
+    LoopbackListener& operator=(const LoopbackListener&) = delete;
+
+    // The next client connection, or null when none is waiting
+    std::unique_ptr<Transport> accept();
+
+    const std::string& getName() const { return name; }
+
+    // The listener registered under a name, or null
+    static LoopbackListener* find(const std::string& name);
+
+private:
+    friend class LoopbackTransport;
+
+    std::string name;
+    std::deque<std::shared_ptr<LoopbackLink>> pending;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+
+// Kind of record stored in a capture file
+enum class CaptureChannel : uint8_t {
+    TCP = 0,    // One complete newline-delimited TCP message
+    UDP = 1,    // One UDP datagram
+    FRAME = 2   // End of a NetworkClient::update() that received data
+};
+
+// Single inbound record read back from a capture file
+struct CaptureRecord {
+    CaptureChannel channel = CaptureChannel::TCP;
+    uint64_t timestampUs = 0; // Microseconds since the start of the recording
+    std::string data;
+};
+
+// Writes inbound network traffic to a compact binary capture file.
+//
+// File layout: "GMCAP" magic, one version byte, then a sequence of records.
+// Each record is a channel byte, the timestamp delta from the previous record
+// in microseconds and the payload length (both LEB128 varints), then the payload.
+class CaptureWriter {
+public:
+    ~CaptureWriter();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    // Append a record stamped with the monotonic clock
+    void write(CaptureChannel channel, const char* data, size_t length);
+
+    // Mark the end of a frame, only if something was recorded during it
+    void endFrame();
+
+private:
+    void writeVarint(uint64_t value);
+
+    std::ofstream file;
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t lastTimestampUs = 0;
+    bool frameHasData = false;
+};
+
+// Reads a capture file produced by CaptureWriter
+class CaptureReader {
+public:
+    bool open(const std::string& path);
+
+    // Read the next record, returns false at end of file or on a truncated record
+    bool next(CaptureRecord& record);
+
+private:
+    bool readVarint(uint64_t& value);
+
+    std::ifstream file;
+    uint64_t lastTimestampUs = 0;
+};
+
+// Version of the capture file format
+constexpr uint8_t CAPTURE_FORMAT_VERSION = 1;
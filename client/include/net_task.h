@@ -0,0 +1,268 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+template <typename T = void>
+class Task;
+
+// One coroutine parked on a message, a deadline, or both. Whichever comes first
+// finishes it; the other is then ignored.
+struct NetWait {
+    std::coroutine_handle<> handle;     // set once the coroutine has suspended
+    std::optional<std::string> value;   // payload, or nullopt for a timeout or a closed link
+    bool finished = false;
+};
+
+// co_await on a wait: resumes with its value once the executor runs it
+struct NetWaitAwaiter {
+    std::shared_ptr<NetWait> wait;
+
+    bool await_ready() const noexcept { return wait->finished; }
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept { wait->handle = awaiting; }
+    std::optional<std::string> await_resume() { return std::move(wait->value); }
+};
+
+// Runs coroutine flows on the thread that drives it, with no thread per flow. Nothing
+// resumes inside a message handler: finished waits are queued and resumed by run(),
+// which the network client calls at the start of every update(), so what a flow sends
+// goes out in that same update.
+class NetExecutor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    NetExecutor() = default;
+    NetExecutor(const NetExecutor&) = delete;
+    NetExecutor& operator=(const NetExecutor&) = delete;
+
+    // Destroys flows that are still suspended
+    ~NetExecutor();
+
+    // Start a flow on the next run(); the executor owns it until it returns
+    void spawn(Task<void> task);
+
+    // Finish a wait and queue its coroutine; false if it had already finished
+    bool complete(const std::shared_ptr<NetWait>& wait, std::optional<std::string> value);
+
+    // Finish the wait with nullopt at the deadline, unless something finishes it first
+    void expireAt(const std::shared_ptr<NetWait>& wait, Clock::time_point deadline);
+
+    // Fire due deadlines, then resume every coroutine queued before this call
+    void run(Clock::time_point now);
+
+    // co_await executor.sleepFor(500ms) suspends the calling flow that long
+    NetWaitAwaiter sleepFor(Clock::duration duration);
+
+    // Flows spawned and not yet returned
+    size_t getFlowCount() const { return flows.size(); }
+
+    // Called by a spawned flow's final suspend
+    void release(std::coroutine_handle<> flow, const std::exception_ptr& exception);
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t sequence;
+        std::shared_ptr<NetWait> wait;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    std::deque<std::coroutine_handle<>> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    uint64_t nextTimerSequence = 0;
+    std::unordered_set<void*> flows;    // frame addresses of spawned flows
+};
+
+namespace detail {
+    // Where a finished task goes: back to whoever awaited it, or, for a spawned flow,
+    // to the executor to be freed
+    struct TaskFinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept {
+            auto& promise = finished.promise();
+            if (promise.continuation) {
+                return promise.continuation;
+            }
+            if (promise.owner) {
+                promise.owner->release(finished, promise.exception);
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct TaskPromiseBase {
+        std::coroutine_handle<> continuation;
+        NetExecutor* owner = nullptr;       // set for flows started with spawn()
+        std::exception_ptr exception;
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        TaskFinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+}
+
+// Lazily started coroutine returning T. Awaiting it runs it to completion, switching
+// straight into it and back without going through the executor; exceptions it throws
+// are rethrown to the awaiter.
+template <typename T>
+class Task {
+public:
+    struct promise_type : detail::TaskPromiseBase {
+        std::optional<T> value;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_value(T result) { value = std::move(result); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~Task() { reset(); }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() {
+        auto& promise = handle.promise();
+        if (promise.exception) {
+            std::rethrow_exception(promise.exception);
+        }
+        return std::move(*promise.value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    void reset() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <>
+class Task<void> {
+public:
+    struct promise_type : detail::TaskPromiseBase {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() noexcept {}
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~Task() { reset(); }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    void await_resume() {
+        if (handle.promise().exception) {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
+
+private:
+    friend class NetExecutor;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    void reset() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Every message of one command, queued until a flow takes it. Ends with nullopt once
+// closed, which the network client does on disconnect().
+class MessageStream {
+public:
+    struct State {
+        std::deque<std::string> queued;
+        std::shared_ptr<NetWait> waiting;
+        bool closed = false;
+    };
+
+    MessageStream() = default;
+    explicit MessageStream(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+    // Next payload, or nullopt once the stream has closed and drained
+    NetWaitAwaiter next();
+
+    bool isOpen() const { return state && !state->closed; }
+
+private:
+    std::shared_ptr<State> state;
+};
+
+// Hands incoming messages to the flows waiting for them, by command
+class MessageRouter {
+public:
+    explicit MessageRouter(NetExecutor& executor) : executor(executor) {}
+
+    // Wait for the next message with this command; nullopt after the timeout
+    NetWaitAwaiter receive(std::string command, std::chrono::milliseconds timeout);
+
+    // Every message with this command from now on. The router forgets the stream once
+    // the caller drops it.
+    MessageStream subscribe(std::string command);
+
+    // Offer a message; cheap when nobody waits for anything
+    void deliver(std::string_view command, std::string_view payload);
+
+    // End every single-message wait with nullopt, e.g. when the connection drops
+    void failWaits();
+
+    // End every stream, after whatever is already queued
+    void closeStreams();
+
+    bool empty() const { return waits.empty() && streams.empty(); }
+
+private:
+    NetExecutor& executor;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<NetWait>>> waits;
+    std::unordered_map<std::string, std::vector<std::weak_ptr<MessageStream::State>>> streams;
+};
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <unordered_set>
 #include <thread>
 #include <mutex>
 #include <atomic>
@@ -11,30 +13,22 @@
 #include <memory>
 #include <chrono>
 #include <nlohmann/json_fwd.hpp>
-
-// Platform-specific socket definitions
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "Ws2_32.lib")
-    typedef SOCKET socket_t;
-    #define INVALID_SOCKET INVALID_SOCKET
-    #define SOCKET_ERROR SOCKET_ERROR
-    #define closesocket closesocket
-#else
-    #include <sys/types.h>
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <netdb.h>
-    #include <unistd.h>
-    #include <errno.h>
-    #include <fcntl.h>
-    typedef int socket_t;
-    #define INVALID_SOCKET -1
-    #define SOCKET_ERROR -1
-    #define closesocket close
-#endif
+#include "net_capture.h"
+#include "sequence.h"
+#include "input_history.h"
+#include "reliable_channel.h"
+#include "udp_framing.h"
+#include "outbound_scheduler.h"
+#include "congestion_controller.h"
+#include "latency_stats.h"
+#include "tcp_outbound_queue.h"
+#include "inbound_backlog.h"
+#include "transport.h"
+#include "io_backend.h"
+#include "net_task.h"
+#include "simulated_transport.h"
+#include "frame_arena.h"
+#include "string_pool.h"
 
 // Forward declarations
 struct Player;
@@ -44,22 +38,83 @@ enum class ConnectionStatus {
     DISCONNECTED,
     CONNECTING,
     CONNECTED,
+    RECONNECTING,   // The connection dropped; resuming the session in the background
     CONNECTION_FAILED
 };
 
-// Player info structure
+// Capture replay pacing
+enum class ReplaySpeed {
+    REALTIME,       // Honour the recorded timestamps
+    AS_FAST_AS_POSSIBLE // One recorded frame per update()
+};
+
+// Player info structure. Strings are interned in the client's StringPool and stay
+// valid until the next update() or disconnect().
 struct PlayerInfo {
-    std::string id;
-    std::string name;
-    std::string color;
+    std::string_view id;
+    std::string_view name;
+    std::string_view color;
     float x = 0.0f;
     float y = 0.0f;
-    std::string mapId = "default";
+    std::string_view mapId = "default";
+};
+
+// One map chunk as sent by the server. tiles points at size * size tile ids, row-major,
+// and is only valid during the callback; tileCount is 0 for chunks outside the map.
+struct ChunkData {
+    std::string_view mapId;
+    int cx = 0;
+    int cy = 0;
+    int size = 0;           // tiles per chunk side
+    int tileSize = 0;       // pixels per tile
+    int mapWidth = 0;       // map size in chunks
+    int mapHeight = 0;
+    const uint8_t* tiles = nullptr;
+    size_t tileCount = 0;
+};
+
+// Everything one update() learned about players, applied by the game in a single pass
+// instead of through per-player callbacks. Ids are interned and stay valid until
+// the next update() or disconnect().
+struct NetworkEventBatch {
+    struct PositionEvent {
+        std::string_view playerId;
+        float x = 0.0f;
+        float y = 0.0f;
+    };
+    
+    // The player list (NetworkClient::getPlayers()) changed. It already holds the
+    // latest positions of the players in it.
+    bool playersChanged = false;
+    
+    // Position updates not already reflected in the player list, in arrival order
+    std::vector<PositionEvent> positions;
+    
+    // The server's position for the local player after its newest acknowledged input;
+    // the inputs still pending in the InputHistory come after it
+    bool inputAcked = false;
+    float ackX = 0.0f;
+    float ackY = 0.0f;
+    
+    bool empty() const { return !playersChanged && positions.empty() && !inputAcked; }
+    
+    void clear() {
+        playersChanged = false;
+        positions.clear();
+        inputAcked = false;
+    }
+};
+
+// How much of the inbound backlog one update() handles; zero means no limit. Whatever
+// is left carries over to the next update, so catching up after a stall is spread over
+// several frames instead of stalling one.
+struct ProcessingBudget {
+    std::chrono::microseconds time{4000};   // spent decoding and handling messages
+    size_t messages = 0;
 };
 
 // Callback function types
-using PlayerListCallback = std::function<void(const std::vector<PlayerInfo>&)>;
-using PositionCallback = std::function<void(const std::string&, float, float)>;
+using ChunkCallback = std::function<void(const ChunkData&)>;
 
 // Network client class for handling client-server communication
 class NetworkClient {
@@ -73,12 +128,52 @@ public:
     // Connect to server
     bool connect(const std::string& serverAddress, int tcpPort, int udpPort);
     
+    // Resolve and connect ahead of connect(), e.g. while the name screen is up, and keep
+    // the connection open. Status stays DISCONNECTED meanwhile. connect() to the same
+    // address then adopts the open connection and sends CONNECT on the same frame, so
+    // logging in is a single round trip.
+    bool prepare(const std::string& serverAddress, int tcpPort, int udpPort);
+    
     // Disconnect from server
     void disconnect();
     
+    // When the connection drops after CONFIG, the client keeps its players and world and
+    // reconnects in the background with exponential backoff, then presents the session's
+    // resume token. The server sends only what changed meanwhile. Status stays
+    // RECONNECTING until then, or drops to DISCONNECTED once the window runs out.
+    bool isReconnecting() const { return status == ConnectionStatus::RECONNECTING; }
+    
     // Update network state (should be called every frame)
     void update();
     
+    // Send what was queued since update(), e.g. the inputs of this frame's simulation
+    // ticks, without waiting for the next frame's update(). Reads nothing.
+    void flush();
+    
+    // Coroutine flows, resumed by update() on this thread. Replies are matched by
+    // command: each message goes to the oldest wait for its command, and to every
+    // stream subscribed to it. A wait sees only messages that arrive while it is
+    // registered, so a flow that needs every message of a kind should subscribe.
+    void spawn(Task<void> flow) { executor.spawn(std::move(flow)); }
+    NetExecutor& getExecutor() { return executor; }
+    
+    // Connect and log in; true once CONFIG and UDP_REGISTERED have both arrived within
+    // the timeout. A timeout leaves the connection as it is.
+    Task<bool> connectAsync(std::string serverAddress, int tcpPort, int udpPort,
+                            std::string name, std::string color,
+                            std::chrono::milliseconds timeout = std::chrono::seconds(10));
+    
+    // Send a TCP message and wait for the next reply with the given command. nullopt
+    // after the timeout, or if the connection drops first.
+    Task<std::optional<std::string>> request(std::string message, std::string replyCommand,
+                                             std::chrono::milliseconds timeout);
+    
+    // Next message with this command from either channel, and every message from now on
+    NetWaitAwaiter receive(std::string command, std::chrono::milliseconds timeout) {
+        return messageRouter.receive(std::move(command), timeout);
+    }
+    MessageStream subscribe(std::string command) { return messageRouter.subscribe(std::move(command)); }
+    
     // Send messages to server
     bool sendConnectRequest(const std::string& playerName, const std::string& colorHex);
     bool sendPositionUpdate(float x, float y);
@@ -86,13 +181,73 @@ public:
     bool sendMapChange(const std::string& mapId);
     bool sendUdpRegistration();
     
-    // Register callbacks
-    void setPlayerListCallback(PlayerListCallback callback) {
-        playerListCallback = callback;
+    // Record this tick's movement input, then send every input the server hasn't
+    // acknowledged. Inputs ride unreliable UDP: instead of retransmitting, each INPUT
+    // repeats the unacknowledged ones, so a lost datagram is covered by the next.
+    // Input can only be recorded while it can reach the server and the history has
+    // room (canRecordInput()); the local player must not move on ticks that aren't.
+    bool canRecordInput() const;
+    bool recordInput(uint8_t buttons);
+    bool sendInputs(float tickSeconds);
+    
+    // Declare the world area this client shows. The server then sends ENTER, LEAVE and
+    // UPDATE only for players near it instead of whole-map rosters. The area is snapped
+    // outward to a coarse grid, sent when that changes, and re-sent after every UDP
+    // registration.
+    void setViewRect(float x, float y, float width, float height);
+    
+    // Ask for one map chunk; the reply arrives through the chunk callback. Needs the
+    // reliable UDP channel, so it fails until UDP registration completes.
+    bool requestChunk(const std::string& mapId, int cx, int cy);
+    
+    // Largest datagram to send; smaller messages are packed together up to it and
+    // larger ones are fragmented. Both ends accept datagrams of any size.
+    void setMaxDatagramSize(size_t size) { udpFramer.setMaxDatagramSize(size); }
+    
+    // Uplink budget in bytes per second, 0 for unlimited. Within it, movement goes
+    // first and chat, chunk requests and retransmits wait their turn.
+    void setUplinkRate(double bytesPerSecond) { outboundScheduler.setUplinkRate(bytesPerSecond); }
+    
+    // Bounds for the state send rate, which adapts to measured RTT and loss
+    void setCongestionConfig(const CongestionConfig& config) { congestion.configure(config); }
+    
+    // Impair the connection with simulated delay, jitter, loss, duplication, reordering
+    // and a bandwidth cap. Takes effect on the next connect().
+    void setNetworkConditions(const NetworkConditions& conditions) { simulatedConditions = conditions; }
+    
+    // System interface for socket I/O; several clients on one thread can share one.
+    // Without it, the best available backend is created on the first connect. A client
+    // polls and submits its backend itself each update() unless it is shared, in which
+    // case the host calls poll() once before updating its clients and submit() once after.
+    void setIoBackend(std::shared_ptr<IoBackend> backend, bool shared = false) {
+        ioBackend = std::move(backend);
+        drivesIoBackend = !shared;
     }
+    const std::shared_ptr<IoBackend>& getIoBackend() const { return ioBackend; }
+    
+    // Bound on the time and messages each update() spends on what the server sent
+    void setProcessingBudget(const ProcessingBudget& budget) { processingBudget = budget; }
+    const ProcessingBudget& getProcessingBudget() const { return processingBudget; }
+    
+    // Seconds between state sends at the current rate
+    double getSendInterval() const { return congestion.getSendInterval(); }
+    
+    // Write send queue, network, server and end-to-end latency percentiles of every
+    // acknowledged INPUT to a CSV file, one row per segment every ten seconds
+    bool startLatencyLog(const std::string& path);
     
-    void setPositionCallback(PositionCallback callback) {
-        positionCallback = callback;
+    // Capture recording and replay
+    bool startRecording(const std::string& path);
+    void stopRecording();
+    bool startReplay(const std::string& path, ReplaySpeed speed);
+    bool isReplaying() const { return replaying; }
+    
+    // Player events gathered by the last update(), replaced by the next one
+    const NetworkEventBatch& getEvents() const { return events; }
+    
+    // Register callbacks
+    void setChunkCallback(ChunkCallback callback) {
+        chunkCallback = callback;
     }
     
     // Getters
@@ -102,17 +257,49 @@ public:
     const std::vector<PlayerInfo>& getPlayers() const { return players; }
     const std::vector<std::string>& getChatMessages() const { return chatMessages; }
     bool isConnected() const { return status == ConnectionStatus::CONNECTED; }
+    uint64_t getStaleDatagramCount() const { return positionSequences.getStaleCount(); }
+    bool isUdpRegistered() const { return udpRegistered; }
+    const ReliableChannel& getReliableChannel() const { return reliableChannel; }
+    const UdpFramer& getUdpFramer() const { return udpFramer; }
+    const OutboundScheduler& getOutboundScheduler() const { return outboundScheduler; }
+    const CongestionController& getCongestionController() const { return congestion; }
+    const LatencyStats& getLatencyStats() const { return latencyStats; }
+    const UdpReassembler& getUdpReassembler() const { return udpReassembler; }
+    const TcpOutboundQueue& getTcpOutboundQueue() const { return tcpOutbound; }
+    const InboundBacklog& getInboundBacklog() const { return inboundBacklog; }
+    uint64_t getDeferredUpdateCount() const { return deferredUpdates; }
+    const FrameArena& getFrameArena() const { return frameArena; }
+    const InputHistory& getInputHistory() const { return inputHistory; }
     
     // Public members for connection state
     std::string pendingConnectName;
     std::string playerColor;
     
 private:
-    // Socket management
-    socket_t tcpSocket = -1;
-    socket_t udpSocket = -1;
-    struct sockaddr_in serverTcpAddr;
-    struct sockaddr_in serverUdpAddr;
+    // Flows and what they wait on; declared first so flows are destroyed last
+    NetExecutor executor;
+    MessageRouter messageRouter{executor};
+    
+    // Stream and datagram channels to the server, chosen by address scheme
+    std::unique_ptr<Transport> transport;
+    std::shared_ptr<IoBackend> ioBackend;
+    bool drivesIoBackend = true;        // false when the host polls and submits it
+    NetworkConditions simulatedConditions;
+    std::string connectAddress;
+    int connectTcpPort = 0;
+    int connectUdpPort = 0;
+    
+    // Connection opened by prepare() that connect() has not adopted yet
+    bool speculative = false;
+    std::chrono::steady_clock::time_point nextSpeculativeAttempt;
+    
+    // Session resumption after a dropped connection
+    std::string resumeToken;        // from CONFIG, empty until a session exists
+    std::string sessionName;        // name the session was created with, for a fresh CONNECT
+    int reconnectAttempt = 0;
+    bool resumePending = false;     // RESUME sent on this connection, no answer yet
+    std::chrono::steady_clock::time_point nextReconnectTime;
+    std::chrono::steady_clock::time_point reconnectDeadline;
     
     // Connection status
     ConnectionStatus status = ConnectionStatus::DISCONNECTED;
@@ -121,27 +308,109 @@ private:
     // Player data
     std::string playerId;
     std::vector<PlayerInfo> players;
+    std::unordered_set<std::string_view> listedIds;     // scratch for publishPlayers()
     std::vector<std::string> chatMessages;
     
     // Processing
     std::string tcpBuffer;
+    TcpOutboundQueue tcpOutbound;
+    
+    // Messages read but not handled yet, worked off under the processing budget
+    InboundBacklog inboundBacklog;
+    ProcessingBudget processingBudget;
+    std::string backlogMessage;
+    uint64_t deferredUpdates = 0;   // updates that ended with messages still queued
+    
+    // Decoding allocates from the frame arena, which update() resets every frame;
+    // anything kept longer is interned in the string pool, which update() compacts to
+    // the players still known once departed ones dominate it
+    FrameArena frameArena;
+    StringPool stringPool;
+    void compactStringPool();
+    
+    // Sequencing for unreliable messages
+    SequenceNumber udpSequence = 0;
+    SequenceTracker positionSequences;
+    
+    // Movement inputs not yet acknowledged by the server
+    InputHistory inputHistory;
+    
+    // State send rate, driven by INPUT acknowledgements. Only an INPUT the scheduler
+    // actually sends counts; one replaced while waiting was never on the wire.
+    CongestionController congestion;
+    SequenceNumber queuedInputTick = 0;
+    
+    // Input-to-echo latency, split by where the time goes
+    LatencyStats latencyStats;
+    
+    // Must-arrive control messages over UDP
+    ReliableChannel reliableChannel;
+    std::vector<std::string_view> reliableMessages;     // scratch for handleUdpDatagram()
+    std::vector<std::string> reliableOutgoing;          // scratch for flushReliableChannel()
+    std::string reliableKey;
+    
+    // Orders outbound UDP messages by importance under the uplink budget
+    OutboundScheduler outboundScheduler;
+    
+    // Datagram aggregation and fragmentation under everything sent over UDP
+    UdpFramer udpFramer;
+    UdpReassembler udpReassembler;
+    std::vector<std::string_view> datagramMessages;     // scratch for handleUdpDatagram()
+    std::vector<char> receiveBuffer;     // scratch for reads from either channel
+    
+    // Area of interest declared to the server
+    float viewX = 0.0f;
+    float viewY = 0.0f;
+    float viewWidth = 0.0f;
+    float viewHeight = 0.0f;
+    bool viewDirty = false;
+    const float viewGranularity = 64.0f;    // pixels the declared view snaps to
+    
+    // Player events for the current update()
+    NetworkEventBatch events;
     
     // Callbacks
-    PlayerListCallback playerListCallback;
-    PositionCallback positionCallback;
+    ChunkCallback chunkCallback;
+    
+    // Reused buffer for decoded chunk tiles
+    std::vector<uint8_t> chunkTiles;
     
     // Helper methods
     bool sendTcpMessage(const std::string& message);
-    bool sendUdpMessage(const std::string& message);
-    void processServerMessage(const std::string& message);
+    void flushTcpMessages();
+    bool sendUdpMessage(const std::string& message, TrafficClass trafficClass, std::string key = {});
+    void flushUdpMessages();
+    void processServerMessage(std::string_view message);
+    bool decodePlayerInfo(const FrameJson& player, bool requireColor, PlayerInfo& info);
+    void decodePlayerList(const FrameJson& list, bool requireColor);
+    void publishPlayers();
+    void queuePosition(std::string_view playerId, float x, float y);
+    void handlePositionUpdate(const FrameJson& data);
+    void handleChatMessage(const FrameJson& data);
+    void handlePlayerEnter(const FrameJson& data);
+    void handlePlayerLeave(const FrameJson& data);
+    void handleChunk(const FrameJson& data);
+    void handleInputAck(const FrameJson& data);
+    void sendViewRect();
+    bool acceptPositionSequence(std::string_view playerId, const FrameJson& data);
     void checkTcpMessages();
     void checkUdpMessages();
-    bool setSocketNonBlocking(socket_t socket);
+    void handleUdpDatagram(std::string_view datagram);
+    void processBacklog(bool budgeted);
+    void flushReliableChannel();
     bool checkTcpConnectionStatus();
+    bool openTransport();
+    void updateSpeculative();
+    void sendPendingConnect();
+    void connectionLost(const std::string& reason);
+    void updateReconnect();
+    void scheduleReconnect();
+    void sendResume();
+    void resetLink();
+    void updateReplay();
     
     // Connection state
     bool tcpConnectPending = false;
-    std::chrono::steady_clock::time_point connectStartTime;
     bool udpRegistered;
     
     // Connection timeout handling
@@ -149,4 +418,13 @@ private:
     std::chrono::steady_clock::time_point lastPingTime = std::chrono::steady_clock::now();
     const int connectionTimeout = 15; // seconds before considering disconnected (increased from 10)
     const int pingInterval = 3; // seconds between pings (reduced from 5)
+    
+    // Capture recording and replay
+    CaptureWriter captureWriter;
+    CaptureReader replayReader;
+    CaptureRecord replayRecord;
+    bool replaying = false;
+    bool replayHasRecord = false;
+    ReplaySpeed replaySpeed = ReplaySpeed::REALTIME;
+    std::chrono::steady_clock::time_point replayStartTime;
 }; 
\ No newline at end of file
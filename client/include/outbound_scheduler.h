@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Kinds of outbound UDP traffic, most important first
+enum class TrafficClass : uint8_t {
+    STATE = 0,      // Movement input and position
+    CONTROL = 1,    // Registration, view, pings and acks
+    CHAT = 2,
+    BULK = 3,       // Map changes and chunk requests
+    COUNT
+};
+
+// Byte budget refilled at a fixed rate up to a burst size. A rate of 0 is unlimited.
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void configure(double bytesPerSecond, double burstBytes);
+    void refill(Clock::time_point now);
+
+    // A message may be sent while any tokens remain, so one larger than the burst
+    // still goes out; the overdraft is repaid before the next one
+    bool available() const { return rate <= 0.0 || tokens > 0.0; }
+    void consume(size_t bytes);
+
+private:
+    double rate = 0.0;
+    double burst = 0.0;
+    double tokens = 0.0;
+    Clock::time_point lastRefill;
+    bool hasRefilled = false;
+};
+
+// Orders outbound UDP messages by importance under an uplink budget.
+//
+// Every queued message gains its class priority each schedule() it waits, so state
+// goes first but deferred chat and bulk traffic eventually win and never starve.
+// Messages with a key describe one entity's latest state: queueing another with the
+// same key replaces the waiting one and keeps its accumulated priority, so under a
+// tight budget stale updates are merged instead of sent one after another.
+//
+// Each class has an optional token bucket on top of the shared uplink bucket, which
+// keeps a chat burst or retransmit storm from eating the budget movement needs.
+class OutboundScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    OutboundScheduler();
+
+    // Queue a message; an empty key never merges
+    void enqueue(TrafficClass trafficClass, std::string message, std::string key = {});
+
+    // Append the messages that fit the budget now, most important first
+    void schedule(Clock::time_point now, std::vector<std::string>& outgoing);
+
+    // Total uplink budget in bytes per second; 0 is unlimited
+    void setUplinkRate(double bytesPerSecond);
+
+    // Per-class limit in bytes per second; 0 is unlimited
+    void setClassLimit(TrafficClass trafficClass, double bytesPerSecond, double burstBytes);
+
+    bool empty() const { return queue.empty(); }
+
+    // Metrics
+    size_t getQueuedCount() const { return queue.size(); }
+    uint64_t getDeferredCount() const { return deferredCount; }
+    uint64_t getMergedCount() const { return mergedCount; }
+
+    void reset();
+
+private:
+    struct Entry {
+        TrafficClass trafficClass = TrafficClass::CONTROL;
+        std::string message;
+        std::string key;
+        double priority = 0.0;
+        uint64_t order = 0;     // keeps equal priorities first-in, first-out
+    };
+
+    std::vector<Entry> queue;
+    std::array<double, static_cast<size_t>(TrafficClass::COUNT)> classPriority;
+    std::array<TokenBucket, static_cast<size_t>(TrafficClass::COUNT)> classBuckets;
+    TokenBucket uplink;
+    uint64_t nextOrder = 0;
+
+    uint64_t deferredCount = 0;
+    uint64_t mergedCount = 0;
+};
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <raylib.h>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include "network.h"
@@ -29,6 +31,18 @@ struct Player {
     // Server position for correction
     float serverX = 400.0f;
     float serverY = 300.0f;
+    
+    // Position at the previous simulation tick, and the interpolated position to draw
+    float prevX = 400.0f;
+    float prevY = 300.0f;
+    float renderX = 400.0f;
+    float renderY = 300.0f;
+    
+    // Jump to a position without interpolating from the old one
+    void snapTo(float newX, float newY) {
+        x = prevX = renderX = newX;
+        y = prevY = renderY = newY;
+    }
 };
 
 class PlayerManager {
@@ -36,24 +50,39 @@ public:
     PlayerManager(int screenWidth, int screenHeight);
     
     // Player management
-    void updateLocalPlayer(float deltaTime, bool chatInputActive);
+    // Sample and apply this tick's movement input; returns the InputButton bits applied
+    uint8_t updateLocalPlayer(float deltaTime, bool chatInputActive);
+    void applyInput(uint8_t buttons, float deltaTime);
     void updatePlayers(const std::vector<PlayerInfo>& playerInfos, const std::string& localPlayerId);
-    void processPositionUpdate(const std::string& playerId, float x, float y, const std::string& localPlayerId);
+    void processPositionUpdate(std::string_view playerId, float x, float y, const std::string& localPlayerId);
     void correctPlayerPosition();
     
+    // Restart prediction from the server's position after the last acknowledged input,
+    // replaying the inputs it hasn't applied yet
+    void reconcile(float x, float y, const std::deque<InputCommand>& pending, float tickSeconds);
+    
+    // Apply one update's worth of network events: the player list once, then the
+    // position updates it doesn't already include
+    void applyNetworkEvents(const NetworkEventBatch& events, const std::vector<PlayerInfo>& playerInfos,
+                            const std::string& localPlayerId);
+    
+    // Fixed-timestep interpolation
+    void beginTick();
+    void interpolate(float alpha);
+    
     // Getters
     Player& getLocalPlayer() { return localPlayer; }
     std::unordered_map<std::string, Player>& getPlayers() { return players; }
     
-    // Boundary checking
-    void setScreenBounds(int width, int height) {
-        screenWidth = width;
-        screenHeight = height;
+    // Boundary checking, in world pixels; the server clamps movement to the same size
+    void setWorldBounds(float width, float height) {
+        worldWidth = width;
+        worldHeight = height;
     }
     
 private:
     Player localPlayer;
     std::unordered_map<std::string, Player> players;
-    int screenWidth;
-    int screenHeight;
+    float worldWidth;
+    float worldHeight;
 }; 
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include "sequence.h"
+
+// Independent ordered streams multiplexed over the reliable channel
+enum class ReliableStream : uint8_t {
+    CONTROL = 0,    // Registration and other session control
+    CHAT = 1,
+    MAP = 2,
+    PING = 3,
+    COUNT
+};
+
+// Must-arrive, per-stream ordered message layer over the unreliable UDP socket.
+//
+// Wire format (text, like the rest of the protocol):
+//   REL <seq> <ack> <ackBits> <stream> <streamSeq> <message>
+//   ACK <ack> <ackBits>
+//   REL <seq> <ack> <ackBits> <stream> <streamSeq> ~SKIP
+// <seq> numbers packets for acknowledgement: <ack> is the newest sequence received
+// from the peer and bit i of <ackBits> acknowledges sequence (ack - 1 - i), so one
+// packet acknowledges 33 messages. <streamSeq> orders messages within a stream;
+// a loss only holds back later messages of the same stream.
+//
+// Messages are retransmitted when their RTT-based timer expires. After a maximum
+// number of transmissions the message is given up on and reported by takeFailed(),
+// but its stream slot is not: the same packet goes on being retransmitted as a ~SKIP
+// marker until acknowledged, which moves the receiver past it without delivering
+// anything. A peer that did get the original sees the marker as a duplicate. Either
+// way later messages on the stream are never held back for good. Nothing here blocks;
+// the owner drives it by calling update() once per frame.
+class ReliableChannel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ReliableChannel(size_t windowSize = 32, int maxTransmissions = 10);
+
+    // Queue a message for reliable, in-order delivery on a stream
+    void send(const std::string& message, ReliableStream stream = ReliableStream::CONTROL);
+
+    // Handle an inbound datagram. Returns false if it is not a channel packet.
+    // Newly received messages are appended to delivered. They point into the datagram,
+    // or into messages held here until the next receive().
+    bool receive(std::string_view datagram, std::vector<std::string_view>& delivered, Clock::time_point now);
+
+    // Append the packets due now (new sends, retransmits, acks) to outgoing
+    void update(Clock::time_point now, std::vector<std::string>& outgoing);
+
+    // Messages that exhausted their retransmissions since the last call
+    std::vector<std::string> takeFailed();
+
+    // Drop all state, e.g. on disconnect
+    void reset();
+
+    // Metrics
+    size_t getInFlightCount() const { return inFlight.size(); }
+    size_t getQueuedCount() const { return queued.size(); }
+    size_t getReorderBufferedCount() const;
+    double getSmoothedRttMs() const { return smoothedRttMs; }
+    double getRetransmitTimeoutMs() const { return retransmitTimeoutMs; }
+    uint64_t getRetransmitCount() const { return retransmitCount; }
+
+    static bool isChannelPacket(std::string_view datagram);
+
+    // Stream a REL packet carries, and its packet sequence as text; false for ACK
+    // packets and anything malformed
+    static bool parsePacketHeader(std::string_view packet, ReliableStream& stream, std::string_view& sequence);
+
+private:
+    struct StreamMessage {
+        ReliableStream stream = ReliableStream::CONTROL;
+        SequenceNumber streamSequence = 0;
+        std::string message;
+    };
+
+    struct PendingMessage {
+        SequenceNumber sequence;
+        StreamMessage payload;
+        Clock::time_point lastSent;
+        int transmissions = 0;
+        bool abandoned = false;     // message replaced by a skip marker
+    };
+
+    // Per-stream receive state
+    struct InboundStream {
+        SequenceNumber expected = 0;
+        std::map<SequenceNumber, std::string> buffered;
+    };
+
+    std::string buildPacket(SequenceNumber sequence, const StreamMessage& payload) const;
+    void deliverInOrder(ReliableStream stream, SequenceNumber streamSequence, std::string_view message,
+                        std::vector<std::string_view>& delivered);
+    void processAcks(SequenceNumber ack, uint32_t ackBits, Clock::time_point now);
+    bool recordReceived(SequenceNumber sequence);
+    void addRttSample(double sampleMs);
+
+    size_t windowSize;
+    int maxTransmissions;
+
+    std::deque<StreamMessage> queued;
+    std::deque<PendingMessage> inFlight;
+    std::vector<std::string> failed;
+
+    // Outbound sequencing
+    SequenceNumber nextSequence = 0;
+    std::array<SequenceNumber, static_cast<size_t>(ReliableStream::COUNT)> nextStreamSequence {};
+
+    // Inbound ordering
+    std::array<InboundStream, static_cast<size_t>(ReliableStream::COUNT)> inboundStreams;
+    std::deque<std::string> released;   // buffered messages delivered by the last receive()
+
+    // Inbound acknowledgement state
+    bool hasRemoteSequence = false;
+    SequenceNumber remoteSequence = 0;
+    uint32_t remoteAckBits = 0;
+    bool ackPending = false;
+
+    // Round trip estimation (RFC 6298)
+    bool hasRttSample = false;
+    double smoothedRttMs = 0.0;
+    double rttVarianceMs = 0.0;
+    double retransmitTimeoutMs = 250.0;
+    uint64_t retransmitCount = 0;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+// 16-bit sequence numbers carried by unreliable messages
+using SequenceNumber = uint16_t;
+
+// Wraparound-safe comparison: true if a is newer than b
+inline bool sequenceGreaterThan(SequenceNumber a, SequenceNumber b) {
+    return ((a > b) && (a - b <= 32768)) ||
+           ((a < b) && (b - a > 32768));
+}
+
+// Tracks the newest sequence number seen from each sender and rejects stale ones.
+// Sender ids are held by view, so they must outlive the tracker's entries
+// (the network client interns them).
+class SequenceTracker {
+public:
+    // Returns false if the sequence is not newer than the last one accepted from this sender
+    bool accept(std::string_view sender, SequenceNumber sequence) {
+        auto it = latest.find(sender);
+        if (it == latest.end()) {
+            latest.emplace(sender, sequence);
+            return true;
+        }
+
+        if (!sequenceGreaterThan(sequence, it->second)) {
+            staleCount++;
+            return false;
+        }
+
+        it->second = sequence;
+        return true;
+    }
+
+    // Forget a sender, e.g. when it leaves
+    void forget(std::string_view sender) { latest.erase(sender); }
+
+    void reset() { latest.clear(); }
+
+    // Re-point every sender at new storage: rekey maps an id to its new view, or to
+    // an empty view to forget the sender
+    template<typename Rekey>
+    void rekey(Rekey&& rekey) {
+        std::unordered_map<std::string_view, SequenceNumber> moved;
+        moved.reserve(latest.size());
+        for (const auto& [sender, sequence] : latest) {
+            std::string_view view = rekey(sender);
+            if (!view.empty()) {
+                moved.emplace(view, sequence);
+            }
+        }
+        latest = std::move(moved);
+    }
+
+    // Number of stale or duplicate messages rejected so far
+    uint64_t getStaleCount() const { return staleCount; }
+
+private:
+    std::unordered_map<std::string_view, SequenceNumber> latest;
+    uint64_t staleCount = 0;
+};
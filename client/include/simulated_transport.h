@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "transport.h"
+
+// Impairments applied by SimulatedTransport, in each direction
+struct NetworkConditions {
+    double latencyMs = 0.0;             // one-way delay added to everything
+    double jitterMs = 0.0;              // uniform +/- variation on top of the delay
+    double lossPercent = 0.0;           // datagrams dropped
+    double duplicatePercent = 0.0;      // datagrams delivered twice
+    double reorderPercent = 0.0;        // datagrams held back behind the next one
+    double bandwidthBytesPerSecond = 0; // link rate, 0 for unlimited
+    uint32_t seed = 1;                  // the same seed and traffic give the same run
+
+    bool enabled() const {
+        return latencyMs > 0.0 || jitterMs > 0.0 || lossPercent > 0.0 || duplicatePercent > 0.0 ||
+               reorderPercent > 0.0 || bandwidthBytesPerSecond > 0.0;
+    }
+};
+
+// Wraps a real transport and impairs the traffic through it, so loss, jitter and
+// congestion handling can be exercised against a local server.
+//
+// Both directions get the configured delay and jitter and share a rate-limited link
+// per direction, whose queue adds delay as it fills, as a router's would. Datagrams
+// can also be dropped, duplicated or swapped with the next one; a datagram that would
+// wait over a second for the link is dropped. The stream is delayed and throttled but
+// stays complete and in order, as TCP would be. Every random choice comes from one
+// seeded generator.
+class SimulatedTransport : public Transport {
+public:
+    SimulatedTransport(std::unique_ptr<Transport> inner, const NetworkConditions& conditions);
+
+    bool open() override;
+    State poll() override;
+    void disconnect() override;
+
+    TcpOutboundQueue::FlushResult flushStream(TcpOutboundQueue& queue) override;
+    int receiveStream(char* buffer, size_t size) override;
+
+    bool sendDatagram(std::string_view datagram) override;
+    int receiveDatagram(char* buffer, size_t size) override;
+
+    std::string describePeer() const override { return inner->describePeer() + " (simulated)"; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Packet {
+        Clock::time_point due;
+        uint64_t order = 0;
+        std::string data;
+        bool reorder = false;
+    };
+
+    struct LaterFirst {
+        bool operator()(const Packet& a, const Packet& b) const {
+            return a.due != b.due ? a.due > b.due : a.order > b.order;
+        }
+    };
+
+    // One direction of the simulated path
+    struct Link {
+        Clock::time_point freeAt;           // when the link finishes sending what it has
+        Clock::time_point lastStreamDue;    // stream bytes never overtake each other
+        std::priority_queue<Packet, std::vector<Packet>, LaterFirst> datagrams;
+        std::deque<Packet> stream;
+        std::optional<Packet> held;         // datagram waiting for the next one to pass it
+        Clock::time_point heldUntil;
+    };
+
+    // Arrival time of bytes entering the link now, or nullopt if its queue is full
+    std::optional<Clock::time_point> transmit(Link& link, size_t bytes, Clock::time_point now, bool mayDrop);
+    bool chance(double percent);
+
+    void scheduleDatagram(Link& link, std::string_view datagram, Clock::time_point now);
+    void scheduleStream(Link& link, std::string data, Clock::time_point now);
+
+    // Move everything due out of the links and pull new inbound traffic in
+    void pump(Clock::time_point now);
+    template <typename Deliver>
+    void releaseDatagrams(Link& link, Clock::time_point now, Deliver deliver);
+
+    std::unique_ptr<Transport> inner;
+    NetworkConditions conditions;
+    std::mt19937 random;
+    uint64_t nextOrder = 0;
+
+    Link outbound;
+    Link inbound;
+
+    // Outbound stream bytes that reached the far end of the link, written to the inner transport
+    TcpOutboundQueue streamOutbound;
+    bool streamFailed = false;
+
+    // Inbound traffic that has arrived
+    std::string streamReady;
+    std::deque<std::string> datagramsReady;
+    int streamEnd = STREAM_EMPTY;           // closed or failed, reported once the link drains
+    std::vector<char> receiveBuffer;
+};
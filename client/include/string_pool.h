@@ -0,0 +1,43 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// Interns long-lived strings such as player ids, names and colors. Each distinct
+// value is stored once and handed out as a stable string_view, so repeated
+// snapshots of the same players cost a hash lookup instead of an allocation.
+// Views stay valid until clear(); moving the pool keeps them valid.
+class StringPool {
+public:
+    std::string_view intern(std::string_view value) {
+        auto it = index.find(value);
+        if (it != index.end()) {
+            return *it;
+        }
+
+        // Deque elements never move, so views into them stay valid as the pool grows
+        const std::string& stored = storage.emplace_back(value);
+        std::string_view view(stored);
+        index.insert(view);
+        return view;
+    }
+
+    // The stored view of value, or an empty view if it was never interned
+    std::string_view find(std::string_view value) const {
+        auto it = index.find(value);
+        return it != index.end() ? *it : std::string_view();
+    }
+
+    void clear() {
+        index.clear();
+        storage.clear();
+    }
+
+    size_t size() const { return storage.size(); }
+
+private:
+    std::deque<std::string> storage;
+    std::unordered_set<std::string_view> index;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "loopback_transport.h"
+#include "reliable_channel.h"
+#include "tcp_outbound_queue.h"
+#include "udp_framing.h"
+
+// Minimal game server in the client's process, for tests and benchmarks that need a
+// NetworkClient talking to something without the JVM server. Listens on
+// "loopback:<name>" and speaks the same wire protocol as the real server, datagram
+// framing and reliable channel included, for the core message set:
+//
+//   CONNECT       -> CONFIG to the sender, PLAYERS to everyone at the end of update()
+//   UDP_REGISTER  -> UDP_REGISTERED, on the reliable channel when it came that way
+//   POSITION      -> POSITION to everyone
+//   CHAT          -> CHAT from the sender's name to everyone
+//   PING          -> PONG on the channel it came on
+//   LOGOUT        -> the session ends as if the client had closed the connection
+//
+// Anything else is counted and ignored. There are no maps, movement rules or session
+// resumption. Driven by calling update(), typically once per client frame, on the
+// thread that updates the clients.
+class StubServer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StubServer(std::string name = "stub");
+
+    // Accept new clients, handle what they sent and send the replies
+    void update();
+
+    // Address for NetworkClient::connect()
+    std::string getAddress() const { return std::string(LOOPBACK_ADDRESS_PREFIX) + listener.getName(); }
+
+    // Metrics
+    size_t getSessionCount() const { return sessions.size(); }
+    uint64_t getHandledCount() const { return handledCount; }
+    uint64_t getIgnoredCount() const { return ignoredCount; }
+
+private:
+    struct Session {
+        std::unique_ptr<Transport> transport;
+        TcpOutboundQueue tcpOutbound;
+        std::string tcpBuffer;
+        ReliableChannel reliableChannel;
+        UdpFramer udpFramer;
+        UdpReassembler udpReassembler;
+
+        // Empty until CONNECT
+        std::string id;
+        std::string name;
+        std::string color;
+        float x = 0.0f;
+        float y = 0.0f;
+        bool udpRegistered = false;
+        bool closed = false;
+    };
+
+    void receive(Session& session, Clock::time_point now);
+    void handleMessage(Session& session, std::string_view message, bool reliable);
+    void handleConnect(Session& session, std::string_view payload);
+    void handleUdpRegister(Session& session, std::string_view payload, bool reliable);
+    void handlePosition(Session& session, std::string_view payload);
+    void handleChat(Session& session, std::string_view payload);
+    void handlePing(Session& session, bool reliable);
+
+    // Fan out to every logged-in session: over UDP once registered, TCP before that
+    void broadcastPlayers();
+    void broadcastUnreliable(const std::string& message);
+    void broadcastReliable(const std::string& message, ReliableStream stream);
+
+    void send(Session& session, Clock::time_point now);
+
+    LoopbackListener listener;
+    std::vector<std::unique_ptr<Session>> sessions;
+    int nextPlayerNumber = 1;
+    bool rosterChanged = false;
+    std::vector<char> receiveBuffer;
+
+    uint64_t handledCount = 0;
+    uint64_t ignoredCount = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    typedef SOCKET socket_t;
+#else
+    typedef int socket_t;
+#endif
+
+// Outbound byte queue for the TCP stream. Messages are framed with a trailing newline
+// and collected until flush(), which hands as many as fit to the kernel in one
+// gathered write. A short write or EAGAIN leaves the unsent tail queued, and the next
+// flush resumes from the exact byte where the kernel stopped, so frames are never
+// torn or dropped under backpressure.
+class TcpOutboundQueue {
+public:
+    enum class FlushResult {
+        DRAINED,    // Everything queued was written
+        PENDING,    // The socket buffer is full; the rest waits for the next flush
+        FAILED      // The connection is broken
+    };
+
+    explicit TcpOutboundQueue(size_t maxQueuedBytes = 1024 * 1024);
+
+    // Queue one message. Returns false if the queue is over capacity, which means
+    // the peer has stopped reading.
+    bool push(const std::string& message);
+
+    // Write as much as the socket accepts without blocking
+    FlushResult flush(socket_t socket);
+
+    // Take the next message, without its newline, instead of writing it. Fails once
+    // part of it has been written.
+    bool popFront(std::string& message);
+
+    // Drop everything queued, e.g. on disconnect
+    void clear();
+
+    // Metrics
+    size_t getQueuedMessages() const { return frames.size(); }
+    size_t getQueuedBytes() const { return queuedBytes; }
+    uint64_t getWriteCalls() const { return writeCalls; }
+    uint64_t getPartialWrites() const { return partialWrites; }
+
+private:
+    // Advance past bytes the kernel accepted
+    void consume(size_t bytes);
+
+    size_t maxQueuedBytes;
+    std::deque<std::string> frames;
+    size_t headOffset = 0;      // Bytes of frames.front() already written
+    size_t queuedBytes = 0;     // Unwritten bytes across all frames
+
+    uint64_t writeCalls = 0;
+    uint64_t partialWrites = 0;
+};
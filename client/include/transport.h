@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include "tcp_outbound_queue.h"
+
+// Platform-specific socket definitions
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "Ws2_32.lib")
+    typedef SOCKET socket_t;
+    #define INVALID_SOCKET INVALID_SOCKET
+    #define SOCKET_ERROR SOCKET_ERROR
+    #define closesocket closesocket
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <netdb.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    typedef int socket_t;
+    #define INVALID_SOCKET -1
+    #define SOCKET_ERROR -1
+    #define closesocket close
+#endif
+
+// Address scheme that selects the AF_UNIX transport, e.g. "unix:/tmp/guildmaster.sock"
+constexpr std::string_view UNIX_ADDRESS_PREFIX = "unix:";
+
+// Put a socket in non-blocking mode
+bool setSocketNonBlocking(socket_t socket);
+
+class IoBackend;
+
+// The two channels the protocol runs over: an ordered byte stream carrying
+// newline-framed messages, and unreliable datagrams. Everything above this (framing,
+// reliability, scheduling) is the same whichever transport carries it. Nothing here
+// blocks; the network client polls once per frame.
+class Transport {
+public:
+    enum class State {
+        CONNECTING,
+        CONNECTED,
+        FAILED
+    };
+
+    // receiveStream() results besides a byte count
+    static constexpr int STREAM_EMPTY = 0;      // nothing to read right now
+    static constexpr int STREAM_CLOSED = -1;    // the server closed the stream
+    static constexpr int STREAM_FAILED = -2;    // the connection broke
+
+    virtual ~Transport() = default;
+
+    // Pick the transport for an address: "unix:<path>" uses AF_UNIX sockets,
+    // "loopback:<name>" a server in this process, anything else is a host name or IP
+    // for TCP and UDP, moved through the I/O backend
+    static std::unique_ptr<Transport> create(const std::string& address, int tcpPort, int udpPort,
+                                             std::shared_ptr<IoBackend> io);
+
+    // Start connecting; poll() reports progress
+    virtual bool open() = 0;
+    virtual State poll() = 0;
+    virtual void disconnect() = 0;
+
+    // Ordered bytes. The queue keeps whatever the transport could not take yet.
+    virtual TcpOutboundQueue::FlushResult flushStream(TcpOutboundQueue& queue) = 0;
+    virtual int receiveStream(char* buffer, size_t size) = 0;
+
+    // Message boundaries are kept; delivery is not guaranteed. receiveDatagram()
+    // returns the datagram's size, or 0 when none is waiting.
+    virtual bool sendDatagram(std::string_view datagram) = 0;
+    virtual int receiveDatagram(char* buffer, size_t size) = 0;
+
+    // Progress or failure for the status line, and the peer for logs
+    const std::string& getStatusMessage() const { return statusMessage; }
+    virtual std::string describePeer() const = 0;
+
+protected:
+    std::string statusMessage;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+// Default datagram budget: fits the IPv6 minimum MTU (1280) after IP and UDP headers
+constexpr size_t UDP_DEFAULT_MAX_DATAGRAM = 1200;
+
+// Largest payload a UDP datagram can carry; receive buffers are this big
+constexpr size_t UDP_MAX_DATAGRAM = 65507;
+
+// Datagram framing under the message protocol. Small messages queued in the same
+// frame share one datagram and large ones are split across several, so no datagram
+// exceeds the configured budget.
+//
+// Wire format (text, like the rest of the protocol):
+//   <message>                                   one message, sent as-is
+//   AGG <length>:<message><length>:<message>... several messages, lengths in bytes
+//   FRAG <id> <index> <count> <bytes>           part of a datagram too large to send
+// A reassembled FRAG payload is decoded again, so it may itself be an AGG.
+class UdpFramer {
+public:
+    explicit UdpFramer(size_t maxDatagramSize = UDP_DEFAULT_MAX_DATAGRAM);
+
+    // Queue a message for the next flush()
+    void enqueue(std::string message);
+
+    // Pack everything queued into datagrams of at most the budget and append them
+    void flush(std::vector<std::string>& datagrams);
+
+    void setMaxDatagramSize(size_t size);
+    size_t getMaxDatagramSize() const { return maxDatagramSize; }
+    bool empty() const { return queued.empty(); }
+
+    // Metrics
+    uint64_t getMessageCount() const { return messageCount; }
+    uint64_t getDatagramCount() const { return datagramCount; }
+    uint64_t getFragmentedCount() const { return fragmentedCount; }
+
+    void reset();
+
+private:
+    void fragment(const std::string& payload, std::vector<std::string>& datagrams);
+
+    size_t maxDatagramSize;
+    std::deque<std::string> queued;
+    uint16_t nextFragmentId = 0;
+
+    uint64_t messageCount = 0;
+    uint64_t datagramCount = 0;
+    uint64_t fragmentedCount = 0;
+};
+
+// Inbound half of the framing: unpacks AGG datagrams and reassembles FRAG parts.
+// Partial payloads are dropped if the rest doesn't arrive within the timeout;
+// fragments are never retransmitted, reliability stays with the layers above.
+class UdpReassembler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit UdpReassembler(size_t maxFragments = 64, size_t maxPending = 16,
+                            std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    // Decode a datagram and append the complete messages it yields. They point into the
+    // datagram, or into a reassembled payload held here until the next receive().
+    void receive(std::string_view datagram, std::vector<std::string_view>& messages, Clock::time_point now);
+
+    // Drop partial payloads that timed out
+    void expire(Clock::time_point now);
+
+    size_t getPendingCount() const { return pending.size(); }
+    uint64_t getMalformedCount() const { return malformedCount; }
+    uint64_t getExpiredCount() const { return expiredCount; }
+
+    void reset();
+
+private:
+    struct PartialPayload {
+        std::vector<std::string> parts;
+        size_t received = 0;
+        Clock::time_point firstSeen;
+    };
+
+    void decode(std::string_view datagram, std::vector<std::string_view>& messages, Clock::time_point now,
+                int depth);
+    bool unpackAggregate(std::string_view body, std::vector<std::string_view>& messages);
+    void addFragment(std::string_view body, std::vector<std::string_view>& messages, Clock::time_point now,
+                     int depth);
+
+    size_t maxFragments;
+    size_t maxPending;
+    std::chrono::milliseconds timeout;
+    std::map<uint16_t, PartialPayload> pending;
+    std::string reassembled;    // payload completed by the last receive()
+
+    uint64_t malformedCount = 0;
+    uint64_t expiredCount = 0;
+};
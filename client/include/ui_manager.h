@@ -22,10 +22,11 @@ public:
     void drawNameInputScreen(const char* nameInput, int nameLength, bool nameInputActive, int selectedColorIndex, const Color availableColors[], const Rectangle colorButtons[], const Player& localPlayer);
     void drawConnectingScreen(const std::string& statusMsg);
     void drawGameScreen(const Player& localPlayer, const std::unordered_map<std::string, Player>& players, 
-                       const char* nameInput, const std::vector<std::string>& chatMessages, 
+                       const Camera2D& camera, const char* nameInput, const std::vector<std::string>& chatMessages, 
                        const std::vector<std::string>& networkChatMsgs,
                        bool chatInputActive, const char* chatInput, const Rectangle& chatInputBox);
     void drawDisconnectedScreen(const std::string& reason);
+    void drawReconnectingBanner(const std::string& statusMsg);
     
     // UI elements
     void drawColorSelector(const Rectangle colorButtons[], const Color availableColors[], int selectedColorIndex);
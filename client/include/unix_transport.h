@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "transport.h"
+
+// Both channels over AF_UNIX stream sockets to a server on the same host, which skips
+// the loopback IP stack: no checksums, routing or port lookups, and the kernel copies
+// straight between the two processes. Selected with a "unix:<path>" address.
+//
+// Two connections are opened to the socket path. The first line on each tells the
+// server what it carries: "STREAM" for the ordered message stream, "DGRAM" for
+// datagrams. Datagrams keep their boundaries with a 4-byte big-endian length prefix.
+// The datagram connection is a stream, so nothing on it is lost or reordered; when
+// the server stops reading, new datagrams are dropped instead of queued without
+// bound, as a full UDP socket buffer would.
+class UnixTransport : public Transport {
+public:
+    explicit UnixTransport(std::string path);
+    ~UnixTransport() override;
+
+    bool open() override;
+    State poll() override;
+    void disconnect() override;
+
+    TcpOutboundQueue::FlushResult flushStream(TcpOutboundQueue& queue) override;
+    int receiveStream(char* buffer, size_t size) override;
+
+    bool sendDatagram(std::string_view datagram) override;
+    int receiveDatagram(char* buffer, size_t size) override;
+
+    std::string describePeer() const override { return "unix:" + path; }
+
+private:
+    State fail(const std::string& message);
+
+    // Write as much of the pending datagram bytes as the socket takes
+    bool flushDatagrams();
+
+    std::string path;
+    State state = State::CONNECTING;
+
+    socket_t streamSocket = INVALID_SOCKET;
+    socket_t datagramSocket = INVALID_SOCKET;
+
+    // Length-prefixed datagrams not yet written, and bytes read but not yet a whole datagram
+    std::string datagramOutbound;
+    std::vector<char> datagramInbound;
+};
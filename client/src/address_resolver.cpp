@@ -0,0 +1,172 @@
+#include "address_resolver.h"
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <netdb.h>
+    #include <arpa/inet.h>
+#endif
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[AddressResolver] " << msg << std::endl
+
+// Same address with a different port
+ResolvedAddress ResolvedAddress::withPort(int port) const {
+    ResolvedAddress result = *this;
+    if (family == AF_INET6) {
+        reinterpret_cast<struct sockaddr_in6*>(&result.addr)->sin6_port = htons(static_cast<uint16_t>(port));
+    } else {
+        reinterpret_cast<struct sockaddr_in*>(&result.addr)->sin_port = htons(static_cast<uint16_t>(port));
+    }
+    return result;
+}
+
+// Numeric form for logs
+std::string ResolvedAddress::toString() const {
+    char host[INET6_ADDRSTRLEN] = {0};
+    std::ostringstream oss;
+
+    if (family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(&addr);
+        inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+        oss << "[" << host << "]:" << ntohs(in6->sin6_port);
+    } else {
+        const auto* in4 = reinterpret_cast<const struct sockaddr_in*>(&addr);
+        inet_ntop(AF_INET, &in4->sin_addr, host, sizeof(host));
+        oss << host << ":" << ntohs(in4->sin_port);
+    }
+    return oss.str();
+}
+
+// True if a received sockaddr is this address
+bool ResolvedAddress::matches(const struct sockaddr_storage& other) const {
+    if (other.ss_family != family) {
+        return false;
+    }
+
+    if (family == AF_INET6) {
+        const auto* a = reinterpret_cast<const struct sockaddr_in6*>(&addr);
+        const auto* b = reinterpret_cast<const struct sockaddr_in6*>(&other);
+        return a->sin6_port == b->sin6_port &&
+               memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(a->sin6_addr)) == 0;
+    }
+
+    const auto* a = reinterpret_cast<const struct sockaddr_in*>(&addr);
+    const auto* b = reinterpret_cast<const struct sockaddr_in*>(&other);
+    return a->sin_port == b->sin_port && a->sin_addr.s_addr == b->sin_addr.s_addr;
+}
+
+// Destructor
+AddressResolver::~AddressResolver() {
+    cancel();
+}
+
+// Start resolving host on a worker thread
+void AddressResolver::start(const std::string& host, int port) {
+    cancel();
+
+    request = std::make_shared<Request>();
+    state = State::RESOLVING;
+    addresses.clear();
+    error.clear();
+
+    // Detached: the worker only touches the shared request, so it may outlive us
+    std::thread(&AddressResolver::resolve, request, host, port).detach();
+}
+
+// Abandon the current request
+void AddressResolver::cancel() {
+    request.reset();
+    state = State::IDLE;
+}
+
+// Check on the current request
+AddressResolver::State AddressResolver::poll() {
+    if (state != State::RESOLVING || !request) {
+        return state;
+    }
+
+    std::lock_guard<std::mutex> lock(request->mutex);
+    if (!request->done) {
+        return state;
+    }
+
+    addresses = std::move(request->addresses);
+    error = std::move(request->error);
+    state = addresses.empty() ? State::FAILED : State::RESOLVED;
+    return state;
+}
+
+// Worker thread body
+void AddressResolver::resolve(std::shared_ptr<Request> request, std::string host, int port) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    struct addrinfo* results = nullptr;
+    std::string service = std::to_string(port);
+    int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &results);
+
+    std::vector<ResolvedAddress> resolved;
+    std::string failure;
+
+    if (rc != 0) {
+        failure = gai_strerror(rc);
+    } else {
+        for (struct addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+            if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) ||
+                ai->ai_addrlen > sizeof(struct sockaddr_storage)) {
+                continue;
+            }
+
+            ResolvedAddress address;
+            memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+            address.length = static_cast<socklen_t>(ai->ai_addrlen);
+            address.family = ai->ai_family;
+            resolved.push_back(address);
+        }
+        freeaddrinfo(results);
+
+        if (resolved.empty()) {
+            failure = "No IPv4 or IPv6 addresses";
+        }
+    }
+
+    DEBUG_LOG("Resolved " << host << ": " << resolved.size() << " address(es)"
+              << (failure.empty() ? "" : " (" + failure + ")"));
+
+    std::lock_guard<std::mutex> lock(request->mutex);
+    request->addresses = interleaveFamilies(resolved);
+    request->error = failure;
+    request->done = true;
+}
+
+// Alternate address families, starting with the family getaddrinfo preferred
+std::vector<ResolvedAddress> AddressResolver::interleaveFamilies(const std::vector<ResolvedAddress>& input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    int firstFamily = input.front().family;
+    std::vector<const ResolvedAddress*> preferred;
+    std::vector<const ResolvedAddress*> other;
+    for (const auto& address : input) {
+        (address.family == firstFamily ? preferred : other).push_back(&address);
+    }
+
+    std::vector<ResolvedAddress> result;
+    result.reserve(input.size());
+    for (size_t i = 0; i < preferred.size() || i < other.size(); i++) {
+        if (i < preferred.size()) {
+            result.push_back(*preferred[i]);
+        }
+        if (i < other.size()) {
+            result.push_back(*other[i]);
+        }
+    }
+    return result;
+}
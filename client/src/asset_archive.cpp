@@ -0,0 +1,192 @@
+#include "asset_archive.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[AssetArchive] " << msg << std::endl
+
+// Destructor
+AssetArchive::~AssetArchive() {
+    close();
+}
+
+// Record why open() failed and release anything mapped so far
+bool AssetArchive::fail(const std::string& message) {
+    close();
+    error = message;
+    DEBUG_LOG(message);
+    return false;
+}
+
+// Map an archive file and validate its header and the index's extent
+bool AssetArchive::open(const std::string& path) {
+    close();
+    error.clear();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return fail("Cannot open " + path);
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        return fail("Cannot size " + path);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        return fail("Cannot map " + path);
+    }
+    mappingHandle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        return fail("Cannot map " + path);
+    }
+    base = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return fail("Cannot open " + path + ": " + strerror(errno));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return fail("Cannot size " + path);
+    }
+
+    // Shared and read-only, so concurrent clients share the page cache
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return fail("Cannot map " + path + ": " + strerror(errno));
+    }
+    base = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(info.st_size);
+#endif
+
+    if (size < sizeof(AssetArchiveHeader)) {
+        return fail(path + " is too small to be an asset archive");
+    }
+
+    AssetArchiveHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, ASSET_ARCHIVE_MAGIC, sizeof(header.magic)) != 0) {
+        return fail(path + " is not an asset archive");
+    }
+    if (header.version != ASSET_ARCHIVE_VERSION) {
+        return fail(path + " has unsupported version " + std::to_string(header.version));
+    }
+    if (header.fileSize != size) {
+        return fail(path + " is truncated");
+    }
+
+    uint64_t indexBytes = static_cast<uint64_t>(header.entryCount) * sizeof(AssetIndexEntry);
+    if (header.indexOffset % alignof(AssetIndexEntry) != 0 ||
+        header.indexOffset > size || indexBytes > size - header.indexOffset) {
+        return fail(path + " has a corrupt index");
+    }
+
+    index = reinterpret_cast<const AssetIndexEntry*>(base + header.indexOffset);
+    entryCount = header.entryCount;
+
+#if !defined(_WIN32) && defined(MADV_RANDOM)
+    // Assets are read on demand in no particular order; don't read ahead
+    madvise(const_cast<unsigned char*>(base), size, MADV_RANDOM);
+#endif
+
+    DEBUG_LOG("Mapped " << path << ": " << entryCount << " assets, " << size << " bytes");
+    return true;
+}
+
+// Unmap the archive
+void AssetArchive::close() {
+#ifdef _WIN32
+    if (base) {
+        UnmapViewOfFile(base);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+#else
+    if (base) {
+        munmap(const_cast<unsigned char*>(base), size);
+    }
+#endif
+
+    base = nullptr;
+    size = 0;
+    index = nullptr;
+    entryCount = 0;
+}
+
+// Binary search the index by name hash
+const AssetIndexEntry* AssetArchive::find(std::string_view assetName) const {
+    if (!index) {
+        return nullptr;
+    }
+
+    uint64_t hash = hashAssetName(assetName);
+    const AssetIndexEntry* end = index + entryCount;
+    const AssetIndexEntry* it = std::lower_bound(index, end, hash,
+        [](const AssetIndexEntry& entry, uint64_t value) { return entry.nameHash < value; });
+
+    // Names that collide on the hash sit next to each other
+    for (; it != end && it->nameHash == hash; ++it) {
+        if (name(*it) != assetName) {
+            continue;
+        }
+        if (!inBounds(*it)) {
+            DEBUG_LOG("Asset " << assetName << " points outside the archive");
+            return nullptr;
+        }
+        return it;
+    }
+    return nullptr;
+}
+
+// Whether an entry's name and data lie inside the mapping. Checked per lookup rather
+// than for the whole index on open().
+bool AssetArchive::inBounds(const AssetIndexEntry& entry) const {
+    return entry.nameOffset <= size && entry.nameLength <= size - entry.nameOffset &&
+           entry.dataOffset <= size && entry.dataSize <= size - entry.dataOffset;
+}
+
+// Bytes of an entry, empty if it points outside the file
+std::string_view AssetArchive::data(const AssetIndexEntry& entry) const {
+    if (entry.dataOffset > size || entry.dataSize > size - entry.dataOffset) {
+        return std::string_view();
+    }
+    return std::string_view(reinterpret_cast<const char*>(base + entry.dataOffset), entry.dataSize);
+}
+
+// Name of an entry, empty if it points outside the file
+std::string_view AssetArchive::name(const AssetIndexEntry& entry) const {
+    if (entry.nameOffset > size || entry.nameLength > size - entry.nameOffset) {
+        return std::string_view();
+    }
+    return std::string_view(reinterpret_cast<const char*>(base + entry.nameOffset), entry.nameLength);
+}
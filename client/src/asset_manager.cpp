@@ -0,0 +1,110 @@
+#include "asset_manager.h"
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[AssetManager] " << msg << std::endl
+
+// Destructor
+AssetManager::~AssetManager() {
+    unloadAll();
+}
+
+// Map an archive
+bool AssetManager::open(const std::string& path) {
+    unloadAll();
+    return archive.open(path);
+}
+
+// Lower-case extension including the dot, as raylib's decoders expect
+std::string AssetManager::fileExtension(std::string_view name) {
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string_view::npos) {
+        return "";
+    }
+
+    std::string extension(name.substr(dot));
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+// Decode a texture on first use
+const Texture2D* AssetManager::getTexture(std::string_view name) {
+    std::string key(name);
+    auto cached = textures.find(key);
+    if (cached != textures.end()) {
+        return &cached->second;
+    }
+
+    const AssetIndexEntry* entry = archive.find(name);
+    if (!entry || entry->type != AssetType::IMAGE) {
+        DEBUG_LOG("No image asset named " << name);
+        return nullptr;
+    }
+
+    std::string_view bytes = archive.data(*entry);
+    Image image = LoadImageFromMemory(fileExtension(name).c_str(),
+                                      reinterpret_cast<const unsigned char*>(bytes.data()),
+                                      static_cast<int>(bytes.size()));
+    if (image.data == nullptr) {
+        DEBUG_LOG("Failed to decode image " << name);
+        return nullptr;
+    }
+
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    auto inserted = textures.emplace(std::move(key), texture);
+    return &inserted.first->second;
+}
+
+// Decode a font at a pixel size on first use
+const Font* AssetManager::getFont(std::string_view name, int size) {
+    std::string key(name);
+    key += '@';
+    key += std::to_string(size);
+
+    auto cached = fonts.find(key);
+    if (cached != fonts.end()) {
+        return &cached->second;
+    }
+
+    const AssetIndexEntry* entry = archive.find(name);
+    if (!entry || entry->type != AssetType::FONT) {
+        DEBUG_LOG("No font asset named " << name);
+        return nullptr;
+    }
+
+    std::string_view bytes = archive.data(*entry);
+    Font font = LoadFontFromMemory(fileExtension(name).c_str(),
+                                   reinterpret_cast<const unsigned char*>(bytes.data()),
+                                   static_cast<int>(bytes.size()), size, nullptr, 0);
+    if (font.glyphs == nullptr) {
+        DEBUG_LOG("Failed to decode font " << name);
+        return nullptr;
+    }
+
+    auto inserted = fonts.emplace(std::move(key), font);
+    return &inserted.first->second;
+}
+
+// Undecoded bytes of any asset
+std::string_view AssetManager::getRaw(std::string_view name) const {
+    const AssetIndexEntry* entry = archive.find(name);
+    return entry ? archive.data(*entry) : std::string_view();
+}
+
+// Release every decoded asset
+void AssetManager::unloadAll() {
+    for (auto& [name, texture] : textures) {
+        UnloadTexture(texture);
+    }
+    textures.clear();
+
+    for (auto& [name, font] : fonts) {
+        UnloadFont(font);
+    }
+    fonts.clear();
+}
@@ -0,0 +1,259 @@
+#include "chunk_cache.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[ChunkCache] " << msg << std::endl
+
+namespace {
+    // Tile colors, indexed by the server's tile ids
+    const Color TILE_COLORS[] = {
+        { 106, 190, 48, 255 },     // Grass
+        { 143, 101, 60, 255 },     // Dirt
+        { 58, 110, 200, 255 },     // Water
+        { 128, 128, 128, 255 },    // Stone
+        { 222, 203, 145, 255 }     // Sand
+    };
+    const size_t TILE_COLOR_COUNT = sizeof(TILE_COLORS) / sizeof(TILE_COLORS[0]);
+    const Color UNKNOWN_TILE_COLOR = { 255, 0, 255, 255 };
+
+    // Bookkeeping cost charged for chunks that have no texture
+    const size_t EMPTY_CHUNK_BYTES = 64;
+
+    int floorDiv(float value, int divisor) {
+        return static_cast<int>(std::floor(value / static_cast<float>(divisor)));
+    }
+}
+
+// Hash the map id and chunk coordinates together
+size_t ChunkCache::ChunkKeyHash::operator()(const ChunkKey& key) const {
+    size_t hash = std::hash<std::string>()(key.mapId);
+    hash ^= std::hash<int>()(key.cx) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>()(key.cy) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// Constructor
+ChunkCache::ChunkCache(size_t memoryBudgetBytes) :
+    memoryBudgetBytes(memoryBudgetBytes)
+{
+}
+
+// Destructor
+ChunkCache::~ChunkCache() {
+    clear();
+}
+
+// Geometry for a map, or the defaults until the server describes it
+const ChunkCache::MapInfo& ChunkCache::mapInfo(const std::string& mapId) const {
+    static const MapInfo defaults;
+    auto it = maps.find(mapId);
+    return it != maps.end() ? it->second : defaults;
+}
+
+// World size in pixels, zero while unknown
+Vector2 ChunkCache::getWorldSize(const std::string& mapId) const {
+    const MapInfo& info = mapInfo(mapId);
+    float chunkPixels = static_cast<float>(info.chunkSize * info.tileSize);
+    return { info.width * chunkPixels, info.height * chunkPixels };
+}
+
+// Decode a chunk from the server into a texture
+void ChunkCache::store(const ChunkData& chunk) {
+    if (chunk.size <= 0 || chunk.tileSize <= 0) {
+        return;
+    }
+
+    ChunkKey key{ std::string(chunk.mapId), chunk.cx, chunk.cy };
+    pending.erase(key);
+
+    MapInfo& info = maps[key.mapId];
+    info.chunkSize = chunk.size;
+    info.tileSize = chunk.tileSize;
+    info.width = chunk.mapWidth;
+    info.height = chunk.mapHeight;
+
+    // A re-sent chunk replaces the cached one
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        unload(*existing->second);
+        entries.erase(existing->second);
+        index.erase(existing);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.lastUsedFrame = frame;
+    entry.bytes = EMPTY_CHUNK_BYTES;
+
+    size_t tileCount = static_cast<size_t>(chunk.size) * chunk.size;
+    if (chunk.tileCount == tileCount) {
+        // One texel per tile; draw() scales by the tile size with point filtering
+        Image image = GenImageColor(chunk.size, chunk.size, Color{ 0, 0, 0, 0 });
+        Color* pixels = static_cast<Color*>(image.data);
+        for (size_t i = 0; i < tileCount; i++) {
+            uint8_t tile = chunk.tiles[i];
+            pixels[i] = tile < TILE_COLOR_COUNT ? TILE_COLORS[tile] : UNKNOWN_TILE_COLOR;
+        }
+
+        entry.texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        entry.hasTexture = true;
+        entry.bytes = tileCount * sizeof(Color);
+    }
+
+    bytesUsed += entry.bytes;
+    entries.push_front(std::move(entry));
+    index[key] = entries.begin();
+
+    evict();
+}
+
+// Keep the chunks under the view resident and request missing ones
+void ChunkCache::update(NetworkClient& network, const std::string& mapId, Rectangle view, Vector2 velocity) {
+    frame++;
+    double now = GetTime();
+
+    // Forget requests the server never answered so they are asked again
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second > requestTimeout) {
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // The view plus a ring of one chunk, then where the view is heading
+    const MapInfo& info = mapInfo(mapId);
+    float chunkPixels = static_cast<float>(info.chunkSize * info.tileSize);
+    Rectangle area = { view.x - chunkPixels, view.y - chunkPixels,
+                       view.width + 2 * chunkPixels, view.height + 2 * chunkPixels };
+    requestArea(network, mapId, area, now);
+
+    if (velocity.x != 0.0f || velocity.y != 0.0f) {
+        area.x += velocity.x * lookAheadSeconds;
+        area.y += velocity.y * lookAheadSeconds;
+        requestArea(network, mapId, area, now);
+    }
+
+    evict();
+}
+
+// Request the chunks around a position on a map we are about to enter
+void ChunkCache::prefetch(NetworkClient& network, const std::string& mapId, Vector2 position, Vector2 viewSize) {
+    Rectangle area = { position.x - viewSize.x / 2, position.y - viewSize.y / 2, viewSize.x, viewSize.y };
+    requestArea(network, mapId, area, GetTime());
+}
+
+// Touch cached chunks in the area and request the missing ones, nearest first
+void ChunkCache::requestArea(NetworkClient& network, const std::string& mapId, Rectangle area, double now) {
+    const MapInfo& info = mapInfo(mapId);
+    int chunkPixels = info.chunkSize * info.tileSize;
+
+    int minX = std::max(0, floorDiv(area.x, chunkPixels));
+    int minY = std::max(0, floorDiv(area.y, chunkPixels));
+    int maxX = floorDiv(area.x + area.width, chunkPixels);
+    int maxY = floorDiv(area.y + area.height, chunkPixels);
+    if (info.width > 0) {
+        maxX = std::min(maxX, info.width - 1);
+        maxY = std::min(maxY, info.height - 1);
+    }
+
+    float centerX = (area.x + area.width / 2) / chunkPixels;
+    float centerY = (area.y + area.height / 2) / chunkPixels;
+
+    std::vector<std::pair<float, ChunkKey>> missing;
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            ChunkKey key{ mapId, cx, cy };
+
+            auto it = index.find(key);
+            if (it != index.end()) {
+                it->second->lastUsedFrame = frame;
+                entries.splice(entries.begin(), entries, it->second);
+                continue;
+            }
+
+            if (pending.count(key) == 0) {
+                float dx = cx + 0.5f - centerX;
+                float dy = cy + 0.5f - centerY;
+                missing.emplace_back(dx * dx + dy * dy, std::move(key));
+            }
+        }
+    }
+
+    std::sort(missing.begin(), missing.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (auto& [distance, key] : missing) {
+        if (pending.size() >= maxPendingRequests) {
+            break;
+        }
+        if (!network.requestChunk(key.mapId, key.cx, key.cy)) {
+            break;
+        }
+        pending.emplace(std::move(key), now);
+    }
+}
+
+// Draw the cached chunks overlapping the view
+void ChunkCache::draw(const std::string& mapId, Rectangle view) const {
+    const MapInfo& info = mapInfo(mapId);
+    int chunkPixels = info.chunkSize * info.tileSize;
+
+    int minX = floorDiv(view.x, chunkPixels);
+    int minY = floorDiv(view.y, chunkPixels);
+    int maxX = floorDiv(view.x + view.width, chunkPixels);
+    int maxY = floorDiv(view.y + view.height, chunkPixels);
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            auto it = index.find(ChunkKey{ mapId, cx, cy });
+            if (it == index.end() || !it->second->hasTexture) {
+                continue;
+            }
+
+            Vector2 position = { static_cast<float>(cx * chunkPixels), static_cast<float>(cy * chunkPixels) };
+            DrawTextureEx(it->second->texture, position, 0.0f, static_cast<float>(info.tileSize), WHITE);
+        }
+    }
+}
+
+// Drop least recently used chunks until under budget, keeping those needed this frame
+void ChunkCache::evict() {
+    while (bytesUsed > memoryBudgetBytes && !entries.empty()) {
+        Entry& oldest = entries.back();
+        if (oldest.lastUsedFrame >= frame) {
+            break;
+        }
+
+        unload(oldest);
+        index.erase(oldest.key);
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+// Release an entry's texture and budget
+void ChunkCache::unload(Entry& entry) {
+    if (entry.hasTexture) {
+        UnloadTexture(entry.texture);
+        entry.hasTexture = false;
+    }
+    bytesUsed -= entry.bytes;
+    entry.bytes = 0;
+}
+
+// Unload every texture and forget pending requests
+void ChunkCache::clear() {
+    for (auto& entry : entries) {
+        unload(entry);
+    }
+    entries.clear();
+    index.clear();
+    pending.clear();
+    DEBUG_LOG("Cleared chunk cache");
+}
@@ -0,0 +1,131 @@
+#include "congestion_controller.h"
+#include <algorithm>
+#include <iostream>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[CongestionController] " << msg << std::endl
+
+namespace {
+    // How often the rate is re-evaluated
+    const auto EVALUATION_PERIOD = std::chrono::milliseconds(1000);
+
+    // Fewer outcomes than this in a period say too little about loss
+    const uint32_t MIN_PERIOD_SAMPLES = 4;
+
+    // Packets unacknowledged this long are lost even if nothing newer was acknowledged
+    const auto LOSS_TIMEOUT = std::chrono::milliseconds(2000);
+
+    // The path minimum is forgotten after this long, so a route change is picked up
+    const auto MIN_RTT_WINDOW = std::chrono::seconds(10);
+
+    // AIMD steps
+    const double DECREASE_FACTOR = 0.7;
+    const double INCREASE_HZ = 1.0;
+
+    // RTT smoothing gain (RFC 6298)
+    const double RTT_ALPHA = 0.125;
+}
+
+// Constructor
+CongestionController::CongestionController(const CongestionConfig& config) {
+    configure(config);
+}
+
+// Apply new bounds; the rate restarts from the initial rate
+void CongestionController::configure(const CongestionConfig& newConfig) {
+    config = newConfig;
+    config.minRateHz = std::max(0.1, config.minRateHz);
+    config.maxRateHz = std::max(config.minRateHz, config.maxRateHz);
+    rateHz = std::clamp(config.initialRateHz, config.minRateHz, config.maxRateHz);
+}
+
+// Track a sent packet
+void CongestionController::onSent(SequenceNumber sequence, Clock::time_point now) {
+    inFlight.push_back({ sequence, now });
+
+    // Bound the tracking if acknowledgements stop entirely
+    while (inFlight.size() > 256) {
+        inFlight.pop_front();
+        periodLost++;
+    }
+}
+
+// Match an acknowledgement to its packet
+void CongestionController::onAcked(SequenceNumber sequence, Clock::time_point now) {
+    while (!inFlight.empty() && !sequenceGreaterThan(inFlight.front().sequence, sequence)) {
+        const SentPacket& packet = inFlight.front();
+        if (packet.sequence == sequence) {
+            addRttSample(std::chrono::duration<double, std::milli>(now - packet.sentAt).count(), now);
+            periodAcked++;
+        } else {
+            // Every packet gets its own ack, so one overtaken by a newer ack was lost
+            periodLost++;
+        }
+        inFlight.pop_front();
+    }
+}
+
+// Fold in one RTT sample and track the path minimum
+void CongestionController::addRttSample(double sampleMs, Clock::time_point now) {
+    if (!hasRttSample) {
+        smoothedRttMs = sampleMs;
+        hasRttSample = true;
+    } else {
+        smoothedRttMs += RTT_ALPHA * (sampleMs - smoothedRttMs);
+    }
+
+    if (minRttMs == 0.0 || sampleMs <= minRttMs || now - minRttTime > MIN_RTT_WINDOW) {
+        minRttMs = sampleMs;
+        minRttTime = now;
+    }
+}
+
+// Additive increase, multiplicative decrease once per period
+void CongestionController::update(Clock::time_point now) {
+    if (!periodStarted) {
+        periodStart = now;
+        periodStarted = true;
+        return;
+    }
+
+    while (!inFlight.empty() && now - inFlight.front().sentAt > LOSS_TIMEOUT) {
+        inFlight.pop_front();
+        periodLost++;
+    }
+
+    if (now - periodStart < EVALUATION_PERIOD) {
+        return;
+    }
+
+    uint32_t outcomes = periodAcked + periodLost;
+    if (outcomes >= MIN_PERIOD_SAMPLES) {
+        lastLossRatio = static_cast<double>(periodLost) / outcomes;
+        bool queueing = hasRttSample && smoothedRttMs - minRttMs > config.queueingDelayMs;
+
+        if (lastLossRatio > config.lossThreshold || queueing) {
+            rateHz = std::max(config.minRateHz, rateHz * DECREASE_FACTOR);
+            backoffCount++;
+            DEBUG_LOG("Backing off to " << rateHz << " Hz (loss " << lastLossRatio * 100.0
+                      << "%, rtt " << smoothedRttMs << " ms, min " << minRttMs << " ms)");
+        } else {
+            rateHz = std::min(config.maxRateHz, rateHz + INCREASE_HZ);
+        }
+    }
+
+    periodStart = now;
+    periodAcked = 0;
+    periodLost = 0;
+}
+
+// Forget the link, e.g. on disconnect
+void CongestionController::reset() {
+    rateHz = std::clamp(config.initialRateHz, config.minRateHz, config.maxRateHz);
+    inFlight.clear();
+    periodStarted = false;
+    periodAcked = 0;
+    periodLost = 0;
+    hasRttSample = false;
+    smoothedRttMs = 0.0;
+    minRttMs = 0.0;
+    lastLossRatio = 0.0;
+}
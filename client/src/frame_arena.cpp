@@ -0,0 +1,96 @@
+#include "frame_arena.h"
+#include <algorithm>
+
+namespace {
+    thread_local FrameArena* currentArena = nullptr;
+
+    size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+// Constructor
+FrameArena::FrameArena(size_t blockSize) :
+    blockSize(blockSize)
+{
+}
+
+// Destructor
+FrameArena::~FrameArena() {
+    if (currentArena == this) {
+        currentArena = nullptr;
+    }
+}
+
+// Arena that ArenaAllocator draws from on this thread
+FrameArena* FrameArena::current() {
+    return currentArena;
+}
+
+// Add a block large enough for minimumSize bytes
+void FrameArena::addBlock(size_t minimumSize) {
+    Block block;
+    block.size = std::max(blockSize, minimumSize);
+    block.data.reset(new unsigned char[block.size]);
+    blocks.push_back(std::move(block));
+    heapAllocations++;
+}
+
+// Carve out size bytes from the active block, moving on when it is full
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    while (activeBlock < blocks.size()) {
+        Block& block = blocks[activeBlock];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t offset = alignUp(base + block.used, alignment) - base;
+
+        if (offset + size <= block.size) {
+            block.used = offset + size;
+            bytesUsed += size;
+            highWaterBytes = std::max(highWaterBytes, bytesUsed);
+            return block.data.get() + offset;
+        }
+        activeBlock++;
+    }
+
+    // Over-allocate by the alignment so the first object always fits
+    addBlock(size + alignment);
+    activeBlock = blocks.size() - 1;
+    return allocate(size, alignment);
+}
+
+// Reclaim every allocation
+void FrameArena::reset() {
+    // A frame that spilled into several blocks gets one block that fits it next time
+    if (blocks.size() > 1) {
+        size_t total = 0;
+        for (const auto& block : blocks) {
+            total += block.size;
+        }
+        blocks.clear();
+        addBlock(total);
+    }
+
+    for (auto& block : blocks) {
+        block.used = 0;
+    }
+    activeBlock = 0;
+    bytesUsed = 0;
+}
+
+// Make an arena current for the scope's lifetime
+FrameArena::FrameScope::FrameScope(FrameArena& arena) :
+    arena(arena),
+    previous(currentArena)
+{
+    currentArena = &arena;
+}
+
+// Restore the previous arena and release the frame's allocations
+FrameArena::FrameScope::~FrameScope() {
+    currentArena = previous;
+    arena.reset();
+}
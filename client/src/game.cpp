@@ -22,8 +22,7 @@ Game::Game() :
     selectedColorIndex(0),
     chatInputActive(false),
     chatInputLength(0),
-    syncTimer(0.0f),
-    syncInterval(0.05f), // 50ms
+    ticksSinceSync(0),
     correctionTimer(0.0f),
     correctionInterval(0.01f) // 10ms
 {
@@ -41,8 +40,12 @@ void Game::init(int width, int height, const std::string& title) {
     screenHeight = height;
     
     // Initialize Raylib
+    if (vsync) {
+        SetConfigFlags(FLAG_VSYNC_HINT);
+    }
     InitWindow(screenWidth, screenHeight, title.c_str());
-    SetTargetFPS(60);
+    SetTargetFPS(targetFps);
+    tickInterval = 1.0 / tickRate;
     
     // Initialize UI manager
     uiManager = std::make_unique<UIManager>(screenWidth, screenHeight);
@@ -53,6 +56,15 @@ void Game::init(int width, int height, const std::string& title) {
     // Initialize player manager
     playerManager = std::make_unique<PlayerManager>(screenWidth, screenHeight);
     
+    // Map the asset archive; its contents are only decoded when first drawn
+    if (!assetPath.empty() && !assets.open(assetPath)) {
+        DEBUG_LOG("Running without asset archive: " << assets.getArchive().getError());
+    }
+    
+    // Map chunks are streamed in around the camera
+    chunkCache = std::make_unique<ChunkCache>();
+    updateCamera(screenWidth / 2.0f, screenHeight / 2.0f);
+    
     // Set default color
     playerManager->getLocalPlayer().color = ColorUtils::getColorFromIndex(selectedColorIndex);
     
@@ -62,23 +74,75 @@ void Game::init(int width, int height, const std::string& title) {
         std::cerr << "Failed to initialize network" << std::endl;
         return;
     }
+    network->setMaxDatagramSize(static_cast<size_t>(std::max(0, maxDatagramSize)));
+    network->setUplinkRate(uplinkRate);
+    network->setCongestionConfig(congestionConfig);
+    network->setNetworkConditions(networkConditions);
+    network->setIoBackend(IoBackend::create(ioBackendKind));
+    network->setProcessingBudget(processingBudget);
     
-    // Set callback for player list updates
-    network->setPlayerListCallback([this](const std::vector<PlayerInfo>& playerList) {
-        playerManager->updatePlayers(playerList, network->getPlayerId());
+    // Player lists and positions arrive as one event batch per update, applied in tick()
+    network->setChunkCallback([this](const ChunkData& chunk) {
+        chunkCache->store(chunk);
+        
+        // Movement is bounded by the map, as on the server, once we know its size
+        if (chunk.mapId == playerManager->getLocalPlayer().mapId && chunk.mapWidth > 0 && chunk.mapHeight > 0) {
+            Vector2 world = chunkCache->getWorldSize(std::string(chunk.mapId));
+            playerManager->setWorldBounds(world.x, world.y);
+        }
     });
     
-    network->setPositionCallback([this](const std::string& playerId, float x, float y) {
-        playerManager->processPositionUpdate(playerId, x, y, network->getPlayerId());
-    });
+    if (!latencyLogPath.empty()) {
+        network->startLatencyLog(latencyLogPath);
+    }
+    
+    // Record inbound traffic if requested
+    if (!recordPath.empty()) {
+        network->startRecording(recordPath);
+    }
+    
+    // Replay a capture instead of connecting to a live server
+    if (!replayPath.empty()) {
+        if (network->startReplay(replayPath, replaySpeed)) {
+            state = GameState::CONNECTING;
+        } else {
+            state = GameState::DISCONNECTED;
+        }
+    }
+    
+    // Connect while the player types a name, so logging in is a single round trip
+    if (state == GameState::INPUT_NAME) {
+        network->prepare(serverAddress, tcpPort, udpPort);
+    }
     
     isRunning = true;
 }
 
-// Main game loop
+// Main game loop: frame-rate input and rendering around a fixed-rate simulation
 void Game::run() {
+    lastFrameTime = GetTime();
+    
     while (isRunning && !WindowShouldClose()) {
+        double now = GetTime();
+        
+        // Clamp long stalls (window drags, breakpoints) so the simulation doesn't spiral
+        accumulator += std::min(now - lastFrameTime, maxFrameTime);
+        lastFrameTime = now;
+        
         update();
+        
+        while (accumulator >= tickInterval) {
+            tick();
+            accumulator -= tickInterval;
+        }
+        
+        // Inputs are sampled and queued on ticks; send them now rather than next frame
+        if (network) {
+            network->flush();
+        }
+        
+        // Draw between the last two simulation states
+        playerManager->interpolate(static_cast<float>(accumulator / tickInterval));
         render();
     }
 }
@@ -89,36 +153,68 @@ void Game::close() {
         network->disconnect();
     }
     
+    // Textures must go before the GL context
+    chunkCache.reset();
+    assets.unloadAll();
+    
     CloseWindow();
     isRunning = false;
 }
 
-// Update game state
+// Per-frame update: UI and text input, which must not miss key events between ticks,
+// and the network
 void Game::update() {
     // Handle user input
     handleInput();
     
-    // Update network state
+    updateNetwork();
+}
+
+// Read and handle what the server sent, once per frame whatever the tick count, so a
+// single processing budget bounds the frame even when the simulation catches up
+void Game::updateNetwork() {
     if (network) {
         network->update();
         
+        // Apply what the update received in one pass
+        const NetworkEventBatch& events = network->getEvents();
+        if (!events.empty()) {
+            playerManager->applyNetworkEvents(events, network->getPlayers(), network->getPlayerId());
+        }
+        if (events.inputAcked) {
+            playerManager->reconcile(events.ackX, events.ackY, network->getInputHistory().pending(),
+                                     static_cast<float>(tickInterval));
+        }
+        
         // Check connection status
         if (state == GameState::CONNECTING) {
             if (network->getStatus() == ConnectionStatus::CONNECTED) {
                 DEBUG_LOG("Connection established, transitioning to PLAYING state");
                 state = GameState::PLAYING;
+                if (!playerManager->getLocalPlayer().initialPositionReceived) {
+                    DEBUG_LOG("Waiting for initial position from server...");
+                }
             } else if (network->getStatus() == ConnectionStatus::CONNECTION_FAILED ||
                        network->getStatus() == ConnectionStatus::DISCONNECTED) {
                 DEBUG_LOG("Connection failed or disconnected");
                 state = GameState::DISCONNECTED;
             }
         } else if (state == GameState::PLAYING) {
-            if (network->getStatus() != ConnectionStatus::CONNECTED) {
+            // A dropped connection being resumed keeps the game on screen
+            if (network->getStatus() != ConnectionStatus::CONNECTED && !network->isReconnecting()) {
                 DEBUG_LOG("Connection lost, transitioning to DISCONNECTED state");
                 state = GameState::DISCONNECTED;
             }
         }
     }
+}
+
+// Advance the simulation by one fixed tick
+void Game::tick() {
+    float deltaTime = static_cast<float>(tickInterval);
+    
+    // Remember where everything was so rendering can interpolate toward this tick
+    playerManager->beginTick();
     
     // State-specific updates
     if (state == GameState::PLAYING) {
@@ -126,17 +222,21 @@ void Game::update() {
         
         // Only allow actual gameplay if we've received our initial position
         if (localPlayer.initialPositionReceived) {
-            // Get delta time
-            float deltaTime = GetFrameTime();
-            
-            // Update local player movement
-            playerManager->updateLocalPlayer(deltaTime, chatInputActive);
+            // Update local player movement, sampling input once per tick. The server
+            // replays the same inputs, so they are recorded for the next sync; while
+            // they can't be (reconnecting, or acks far behind) the player holds still
+            // rather than move where the server never will.
+            if (network->canRecordInput()) {
+                uint8_t buttons = playerManager->updateLocalPlayer(deltaTime, chatInputActive);
+                network->recordInput(buttons);
+            }
             
-            // Sync with server at regular intervals
-            syncTimer += deltaTime;
-            if (syncTimer >= syncInterval) {
+            // Sync with server every few ticks, independent of the render rate. The
+            // interval follows the congestion controller's rate.
+            int syncTicks = std::max(1, static_cast<int>(std::lround(network->getSendInterval() * tickRate)));
+            if (++ticksSinceSync >= syncTicks) {
                 sendPlayerUpdate();
-                syncTimer = 0;
+                ticksSinceSync = 0;
             }
             
             // Position correction is temporarily disabled
@@ -148,10 +248,52 @@ void Game::update() {
                 correctionTimer = 0;
             }
             */
-        } else {
-            DEBUG_LOG("Waiting for initial position from server...");
         }
+        
+        // The server only replicates players, and we only stream chunks, near the camera
+        if (network) {
+            updateCamera(localPlayer.x, localPlayer.y);
+            Rectangle view = getCameraView();
+            network->setViewRect(view.x, view.y, view.width, view.height);
+            
+            Vector2 velocity = { (localPlayer.x - localPlayer.prevX) * tickRate,
+                                 (localPlayer.y - localPlayer.prevY) * tickRate };
+            chunkCache->update(*network, localPlayer.mapId, view, velocity);
+        }
+    }
+}
+
+// Follow a position, keeping the view inside the world once its size is known
+void Game::updateCamera(float targetX, float targetY) {
+    float halfWidth = screenWidth / 2.0f;
+    float halfHeight = screenHeight / 2.0f;
+    Vector2 world = chunkCache->getWorldSize(playerManager->getLocalPlayer().mapId);
+    
+    // A world no bigger than the screen (or not yet known) is shown from the origin
+    camera.target.x = world.x > screenWidth ? std::clamp(targetX, halfWidth, world.x - halfWidth) : halfWidth;
+    camera.target.y = world.y > screenHeight ? std::clamp(targetY, halfHeight, world.y - halfHeight) : halfHeight;
+    camera.offset = { halfWidth, halfHeight };
+    camera.rotation = 0.0f;
+    camera.zoom = 1.0f;
+}
+
+// World-space rectangle the camera shows
+Rectangle Game::getCameraView() const {
+    return { camera.target.x - camera.offset.x, camera.target.y - camera.offset.y,
+             static_cast<float>(screenWidth), static_cast<float>(screenHeight) };
+}
+
+// Travel to another map, requesting its chunks around us before we arrive
+void Game::changeMap(const std::string& mapId) {
+    Player& localPlayer = playerManager->getLocalPlayer();
+    if (!network || mapId.empty() || mapId == localPlayer.mapId) {
+        return;
     }
+    
+    Vector2 viewSize = { static_cast<float>(screenWidth), static_cast<float>(screenHeight) };
+    chunkCache->prefetch(*network, mapId, { localPlayer.x, localPlayer.y }, viewSize);
+    network->sendMapChange(mapId);
+    localPlayer.mapId = mapId;
 }
 
 // Render the game
@@ -171,11 +313,22 @@ void Game::render() {
             uiManager->drawConnectingScreen(network ? network->getStatusMessage() : "Connecting...");
             break;
             
-        case GameState::PLAYING:
-            uiManager->drawGameScreen(playerManager->getLocalPlayer(), playerManager->getPlayers(),
+        case GameState::PLAYING: {
+            const Player& localPlayer = playerManager->getLocalPlayer();
+            updateCamera(localPlayer.renderX, localPlayer.renderY);
+            
+            BeginMode2D(camera);
+            chunkCache->draw(localPlayer.mapId, getCameraView());
+            EndMode2D();
+            
+            uiManager->drawGameScreen(localPlayer, playerManager->getPlayers(), camera,
                                      nameInput, chatMessages, network->getChatMessages(),
                                      chatInputActive, chatInput, uiManager->getChatInputBox());
+            if (network->isReconnecting()) {
+                uiManager->drawReconnectingBanner(network->getStatusMessage());
+            }
             break;
+        }
             
         case GameState::DISCONNECTED:
             uiManager->drawDisconnectedScreen(network ? network->getStatusMessage() : "Unknown error");
@@ -274,7 +427,10 @@ void Game::handleInput() {
                 
                 // Send chat message
                 if (IsKeyPressed(KEY_ENTER)) {
-                    if (chatInputLength > 0) {
+                    if (strncmp(chatInput, "/map ", 5) == 0) {
+                        // Travel command rather than chat
+                        changeMap(chatInput + 5);
+                    } else if (chatInputLength > 0) {
                         // Send to server
                         network->sendChatMessage(chatInput);
                         
@@ -304,6 +460,9 @@ void Game::handleInput() {
             // Allow retry on disconnected screen
             if (IsKeyPressed(KEY_ENTER)) {
                 state = GameState::INPUT_NAME;
+                if (network) {
+                    network->prepare(serverAddress, tcpPort, udpPort);
+                }
             }
             break;
             
@@ -315,6 +474,6 @@ void Game::handleInput() {
 // Send player update to server
 void Game::sendPlayerUpdate() {
     if (network && network->isConnected() && playerManager->getLocalPlayer().initialPositionReceived) {
-        network->sendPositionUpdate(playerManager->getLocalPlayer().x, playerManager->getLocalPlayer().y);
+        network->sendInputs(static_cast<float>(tickInterval));
     }
 } 
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "inbound_backlog.h"
+#include <iostream>
+#include <algorithm>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[InboundBacklog] " << msg << std::endl
+
+// Whether a message replaces the whole player list, from its command alone
+bool InboundBacklog::isSnapshot(std::string_view message) {
+    std::string_view command = message.substr(0, message.find(' '));
+    return command == "PLAYERS" || command == "GAME_STATE";
+}
+
+// Queue a message, dropping the snapshots it replaces
+void InboundBacklog::push(std::string_view message) {
+    bool snapshot = isSnapshot(message);
+
+    if (snapshot && snapshotCount > 0) {
+        // Their bytes stay in the buffer until it drains or is compacted
+        auto superseded = std::remove_if(entries.begin() + head, entries.end(), [this](const Entry& entry) {
+            if (!entry.snapshot) {
+                return false;
+            }
+            queuedBytes -= entry.length;
+            return true;
+        });
+        entries.erase(superseded, entries.end());
+
+        DEBUG_LOG("Dropped " << snapshotCount << " queued snapshots superseded by a newer one");
+        supersededCount += snapshotCount;
+        snapshotCount = 0;
+    }
+
+    compact();
+    entries.push_back(Entry{ buffer.size(), message.size(), snapshot });
+    buffer.append(message);
+    queuedBytes += message.size();
+    if (snapshot) {
+        snapshotCount++;
+    }
+    peakMessages = std::max(peakMessages, getQueuedMessages());
+}
+
+// Copy the oldest message to the caller
+bool InboundBacklog::pop(std::string& message) {
+    if (empty()) {
+        return false;
+    }
+
+    const Entry& entry = entries[head++];
+    if (entry.snapshot) {
+        snapshotCount--;
+    }
+    queuedBytes -= entry.length;
+    message.assign(buffer, entry.offset, entry.length);
+
+    // Start over at the front once drained, keeping the capacity
+    if (empty()) {
+        clear();
+    }
+    return true;
+}
+
+// Drop what was popped once it outweighs what is still queued. A backlog that never
+// drains, because every update leaves some of it for the next, still stays bounded.
+void InboundBacklog::compact() {
+    if (empty()) {
+        clear();
+        return;
+    }
+    if (head == 0 || head < entries.size() - head) {
+        return;
+    }
+
+    size_t dropped = entries[head].offset;
+    buffer.erase(0, dropped);
+    entries.erase(entries.begin(), entries.begin() + head);
+    head = 0;
+    for (auto& entry : entries) {
+        entry.offset -= dropped;
+    }
+}
+
+// Drop everything
+void InboundBacklog::clear() {
+    buffer.clear();
+    entries.clear();
+    head = 0;
+    queuedBytes = 0;
+    snapshotCount = 0;
+}
@@ -0,0 +1,294 @@
+#include "inet_transport.h"
+#include <iostream>
+#include <algorithm>
+
+#ifndef _WIN32
+    #include <netinet/tcp.h>
+#endif
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[InetTransport] " << msg << std::endl
+
+// Constructor
+InetTransport::InetTransport(std::string host, int tcpPort, int udpPort, std::shared_ptr<IoBackend> io) :
+    host(std::move(host)),
+    tcpPort(tcpPort),
+    udpPort(udpPort),
+    io(std::move(io))
+{
+}
+
+// Destructor
+InetTransport::~InetTransport() {
+    disconnect();
+}
+
+// Resolve off the render thread; poll() starts connecting once addresses arrive
+bool InetTransport::open() {
+    disconnect();
+    state = State::CONNECTING;
+    statusMessage = "Resolving " + host + "...";
+    connectStartTime = std::chrono::steady_clock::now();
+    resolver.start(host, tcpPort);
+    return true;
+}
+
+// Start a non-blocking connect to the next resolved address, returns false when none are left
+bool InetTransport::startNextConnectAttempt() {
+    while (nextConnectCandidate < connectCandidates.size()) {
+        const ResolvedAddress& address = connectCandidates[nextConnectCandidate++];
+
+        socket_t sock = socket(address.family, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == INVALID_SOCKET) {
+            DEBUG_LOG("Failed to create TCP socket for " << address.toString());
+            continue;
+        }
+
+        if (!setSocketNonBlocking(sock)) {
+            DEBUG_LOG("Failed to set TCP socket to non-blocking mode for " << address.toString());
+            closesocket(sock);
+            continue;
+        }
+
+        lastConnectAttemptTime = std::chrono::steady_clock::now();
+        DEBUG_LOG("Connecting to " << address.toString());
+
+        if (::connect(sock, address.sockaddrPtr(), address.length) == SOCKET_ERROR) {
+#ifdef _WIN32
+            bool inProgress = (WSAGetLastError() == WSAEWOULDBLOCK);
+#else
+            bool inProgress = (errno == EINPROGRESS);
+#endif
+            if (!inProgress) {
+                DEBUG_LOG("Connect to " << address.toString() << " failed immediately");
+                closesocket(sock);
+                continue;
+            }
+        }
+
+        ConnectAttempt attempt;
+        attempt.socket = sock;
+        attempt.address = address;
+        connectAttempts.push_back(attempt);
+        return true;
+    }
+
+    return false;
+}
+
+// Adopt the attempt that connected first and open the UDP socket in the same family
+Transport::State InetTransport::completeConnectAttempt(size_t index) {
+    ConnectAttempt winner = connectAttempts[index];
+    connectAttempts.erase(connectAttempts.begin() + index);
+    closeConnectAttempts();
+
+    udpSocket = socket(winner.address.family, SOCK_DGRAM, IPPROTO_UDP);
+    if (udpSocket == INVALID_SOCKET || !setSocketNonBlocking(udpSocket)) {
+        closesocket(winner.socket);
+        return fail("Failed to create UDP socket");
+    }
+
+    tcpSocket = winner.socket;
+    serverTcpAddr = winner.address;
+
+    // Messages are already coalesced per frame, so Nagle would only add latency
+    int noDelay = 1;
+    setsockopt(tcpSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+    int noSigPipe = 1;
+    setsockopt(tcpSocket, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&noSigPipe, sizeof(noSigPipe));
+#endif
+    serverUdpAddr = winner.address.withPort(udpPort);
+
+    if (!io->add(tcpSocket, false) || !io->add(udpSocket, true)) {
+        return fail("Failed to watch the server connection");
+    }
+
+    state = State::CONNECTED;
+    statusMessage = "Connected to server";
+    return state;
+}
+
+// Give up on connecting
+Transport::State InetTransport::fail(const std::string& message) {
+    disconnect();
+    state = State::FAILED;
+    statusMessage = message;
+    return state;
+}
+
+// Close every connect attempt still racing
+void InetTransport::closeConnectAttempts() {
+    for (const auto& attempt : connectAttempts) {
+        closesocket(attempt.socket);
+    }
+    connectAttempts.clear();
+}
+
+// Drive resolution and the connection race
+Transport::State InetTransport::poll() {
+    if (state != State::CONNECTING) {
+        return state;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    // Waiting on the resolver thread
+    if (connectCandidates.empty()) {
+        switch (resolver.poll()) {
+            case AddressResolver::State::RESOLVING:
+                break;
+            case AddressResolver::State::RESOLVED:
+                connectCandidates = resolver.getAddresses();
+                nextConnectCandidate = 0;
+                statusMessage = "Waiting for connection...";
+                startNextConnectAttempt();
+                break;
+            default:
+                std::cout << "Resolution failed: " << resolver.getError() << std::endl;
+                return fail("Failed to resolve server address");
+        }
+    }
+
+    // Check if any racing connection completed
+    if (!connectAttempts.empty()) {
+        fd_set writefds;
+        fd_set errorfds;
+        struct timeval tv;
+        socket_t maxSocket = 0;
+
+        FD_ZERO(&writefds);
+        FD_ZERO(&errorfds);
+        for (const auto& attempt : connectAttempts) {
+            FD_SET(attempt.socket, &writefds);
+            FD_SET(attempt.socket, &errorfds);
+            maxSocket = std::max(maxSocket, attempt.socket);
+        }
+
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+
+        int ret = select(static_cast<int>(maxSocket + 1), NULL, &writefds, &errorfds, &tv);
+
+        size_t i = 0;
+        while (ret > 0 && i < connectAttempts.size()) {
+            socket_t sock = connectAttempts[i].socket;
+            if (!FD_ISSET(sock, &writefds) && !FD_ISSET(sock, &errorfds)) {
+                i++;
+                continue;
+            }
+
+            // Writable also means failed on some platforms, SO_ERROR tells them apart
+            int error = 0;
+            socklen_t errorLen = sizeof(error);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&error, &errorLen);
+
+            if (error == 0 && FD_ISSET(sock, &writefds)) {
+                return completeConnectAttempt(i);
+            }
+
+            std::cout << "Connection to " << connectAttempts[i].address.toString()
+                      << " failed: socket error " << error << std::endl;
+            closesocket(sock);
+            connectAttempts.erase(connectAttempts.begin() + i);
+        }
+    }
+
+    // Race the next address when the current attempts are slow or have all failed
+    if (!connectCandidates.empty() && nextConnectCandidate < connectCandidates.size()) {
+        auto sinceLastAttempt = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - lastConnectAttemptTime).count();
+        if (connectAttempts.empty() || sinceLastAttempt >= connectAttemptDelayMs) {
+            startNextConnectAttempt();
+        }
+    }
+
+    if (!connectCandidates.empty() && connectAttempts.empty() &&
+        nextConnectCandidate >= connectCandidates.size()) {
+        std::cout << "Connection failed: no address accepted the connection" << std::endl;
+        return fail("Connection to server failed");
+    }
+
+    // Check for connection timeout
+    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - connectStartTime).count();
+
+    if (elapsed > connectTimeoutSeconds) {
+        std::cout << "Connection timed out after " << elapsed << " seconds" << std::endl;
+        return fail("Connection to server timed out");
+    }
+
+    return state;
+}
+
+// Close both sockets and abandon any connection in progress
+void InetTransport::disconnect() {
+    if (tcpSocket != INVALID_SOCKET) {
+        io->remove(tcpSocket);
+        closesocket(tcpSocket);
+        tcpSocket = INVALID_SOCKET;
+    }
+
+    if (udpSocket != INVALID_SOCKET) {
+        io->remove(udpSocket);
+        closesocket(udpSocket);
+        udpSocket = INVALID_SOCKET;
+    }
+
+    closeConnectAttempts();
+    resolver.cancel();
+    connectCandidates.clear();
+    nextConnectCandidate = 0;
+}
+
+// Write as much of the queue as the socket takes
+TcpOutboundQueue::FlushResult InetTransport::flushStream(TcpOutboundQueue& queue) {
+    if (tcpSocket == INVALID_SOCKET) {
+        return TcpOutboundQueue::FlushResult::FAILED;
+    }
+    return queue.flush(tcpSocket);
+}
+
+// Read whatever the TCP stream has
+int InetTransport::receiveStream(char* buffer, size_t size) {
+    if (tcpSocket == INVALID_SOCKET) {
+        return STREAM_FAILED;
+    }
+
+    int bytesReceived = io->receive(tcpSocket, buffer, size);
+    if (bytesReceived == IoBackend::RECEIVE_FAILED) {
+        DEBUG_LOG("TCP receive error");
+        return STREAM_FAILED;
+    }
+    if (bytesReceived == IoBackend::RECEIVE_CLOSED) {
+        return STREAM_CLOSED;
+    }
+    return bytesReceived;
+}
+
+// Queue one UDP datagram to the server; the network client submits the frame's batch
+bool InetTransport::sendDatagram(std::string_view datagram) {
+    if (udpSocket == INVALID_SOCKET) {
+        return false;
+    }
+
+    io->sendTo(udpSocket, datagram, serverUdpAddr.sockaddrPtr(), serverUdpAddr.length);
+    return true;
+}
+
+// Receive the next datagram from the server, skipping any from other senders
+int InetTransport::receiveDatagram(char* buffer, size_t size) {
+    while (udpSocket != INVALID_SOCKET) {
+        struct sockaddr_storage senderAddr;
+
+        int bytesReceived = io->receiveFrom(udpSocket, buffer, size, senderAddr);
+
+        if (bytesReceived <= 0) {
+            return 0;
+        }
+
+        if (serverUdpAddr.matches(senderAddr)) {
+            return bytesReceived;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,302 @@
+#include "io_backend.h"
+#include "io_uring_backend.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#ifdef __linux__
+    #include <sys/epoll.h>
+#endif
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[IoBackend] " << msg << std::endl
+
+namespace {
+    // Datagrams handed to one sendmmsg() call
+    const size_t SEND_BATCH = 64;
+
+    // True when a failed call only means the socket has nothing to give or take right now
+    bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    // Readiness-based backends: the kernel says which sockets have data, and only those
+    // are read. A stream that returned less than asked for is drained, so it is not read
+    // again until the next poll reports it; datagram sockets are read until they would
+    // block.
+    class ReadinessBackend : public IoBackend {
+    public:
+        bool add(socket_t socket, bool datagram) override {
+            sockets[socket] = Watched{ datagram, false };
+            return true;
+        }
+
+        void remove(socket_t socket) override {
+            sockets.erase(socket);
+            dropPending(socket);
+        }
+
+        int receive(socket_t socket, char* buffer, size_t size) override {
+            auto it = sockets.find(socket);
+            if (it != sockets.end() && !it->second.readable) {
+                return RECEIVE_EMPTY;
+            }
+
+            syscallCount++;
+            int bytesReceived = recv(socket, buffer, static_cast<int>(size), 0);
+            if (bytesReceived > 0) {
+                if (it != sockets.end() && static_cast<size_t>(bytesReceived) < size) {
+                    it->second.readable = false;
+                }
+                return bytesReceived;
+            }
+            if (bytesReceived == 0) {
+                return RECEIVE_CLOSED;
+            }
+            if (wouldBlock()) {
+                if (it != sockets.end()) {
+                    it->second.readable = false;
+                }
+                return RECEIVE_EMPTY;
+            }
+            return RECEIVE_FAILED;
+        }
+
+        int receiveFrom(socket_t socket, char* buffer, size_t size, sockaddr_storage& sender) override {
+            auto it = sockets.find(socket);
+            if (it != sockets.end() && !it->second.readable) {
+                return RECEIVE_EMPTY;
+            }
+
+            socklen_t senderLength = sizeof(sender);
+            syscallCount++;
+            int bytesReceived = recvfrom(socket, buffer, static_cast<int>(size), 0,
+                                         reinterpret_cast<sockaddr*>(&sender), &senderLength);
+            if (bytesReceived > 0) {
+                return bytesReceived;
+            }
+            if (it != sockets.end()) {
+                it->second.readable = false;
+            }
+            return (bytesReceived == 0 || wouldBlock()) ? RECEIVE_EMPTY : RECEIVE_FAILED;
+        }
+
+        void submit() override {
+#if defined(__linux__)
+            // One sendmmsg() per batch instead of one sendto() per datagram
+            size_t i = 0;
+            while (i < pendingDatagrams.size()) {
+                socket_t socket = pendingDatagrams[i].socket;
+                mmsghdr messages[SEND_BATCH];
+                iovec vectors[SEND_BATCH];
+                unsigned count = 0;
+                while (i + count < pendingDatagrams.size() && count < SEND_BATCH &&
+                       pendingDatagrams[i + count].socket == socket) {
+                    PendingDatagram& datagram = pendingDatagrams[i + count];
+                    vectors[count].iov_base = datagram.data.data();
+                    vectors[count].iov_len = datagram.data.size();
+                    std::memset(&messages[count], 0, sizeof(mmsghdr));
+                    messages[count].msg_hdr.msg_name = &datagram.address;
+                    messages[count].msg_hdr.msg_namelen = datagram.length;
+                    messages[count].msg_hdr.msg_iov = &vectors[count];
+                    messages[count].msg_hdr.msg_iovlen = 1;
+                    count++;
+                }
+
+                syscallCount++;
+                if (sendmmsg(socket, messages, count, 0) < 0 && !wouldBlock()) {
+                    DEBUG_LOG("Failed to send " << count << " datagrams: errno " << errno);
+                }
+                i += count;
+            }
+#else
+            for (const auto& datagram : pendingDatagrams) {
+                syscallCount++;
+                sendto(datagram.socket, datagram.data.data(), static_cast<int>(datagram.data.size()), 0,
+                       reinterpret_cast<const sockaddr*>(&datagram.address), datagram.length);
+            }
+#endif
+            pendingDatagrams.clear();
+        }
+
+    protected:
+        struct Watched {
+            bool datagram = false;
+            bool readable = false;
+        };
+
+        std::unordered_map<socket_t, Watched> sockets;
+    };
+
+    // select() over every watched socket. Sockets select() cannot hold are read every
+    // frame instead.
+    class SelectBackend : public ReadinessBackend {
+    public:
+        IoBackendKind getKind() const override { return IoBackendKind::SELECT; }
+
+        void poll() override {
+            if (sockets.empty()) {
+                return;
+            }
+
+            fd_set readfds;
+            FD_ZERO(&readfds);
+            socket_t maxSocket = 0;
+            for (auto& [socket, watched] : sockets) {
+#ifndef _WIN32
+                if (socket >= FD_SETSIZE) {
+                    watched.readable = true;
+                    continue;
+                }
+#endif
+                FD_SET(socket, &readfds);
+                maxSocket = std::max(maxSocket, socket);
+            }
+
+            struct timeval tv = { 0, 0 };
+            syscallCount++;
+            if (select(static_cast<int>(maxSocket + 1), &readfds, NULL, NULL, &tv) <= 0) {
+                return;
+            }
+
+            for (auto& [socket, watched] : sockets) {
+                if (FD_ISSET(socket, &readfds)) {
+                    watched.readable = true;
+                }
+            }
+        }
+    };
+
+#ifdef __linux__
+    // Level-triggered epoll: one epoll_wait() reports every readable socket
+    class EpollBackend : public ReadinessBackend {
+    public:
+        EpollBackend() : epollFd(epoll_create1(EPOLL_CLOEXEC)) {}
+
+        ~EpollBackend() override {
+            if (epollFd >= 0) {
+                ::close(epollFd);
+            }
+        }
+
+        bool valid() const { return epollFd >= 0; }
+
+        IoBackendKind getKind() const override { return IoBackendKind::EPOLL; }
+
+        bool add(socket_t socket, bool datagram) override {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = socket;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) != 0) {
+                DEBUG_LOG("Failed to watch socket " << socket << ": errno " << errno);
+                return false;
+            }
+            return ReadinessBackend::add(socket, datagram);
+        }
+
+        void remove(socket_t socket) override {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+            ReadinessBackend::remove(socket);
+        }
+
+        void poll() override {
+            if (sockets.empty()) {
+                return;
+            }
+
+            // Room for every socket, so one call reports them all
+            events.resize(sockets.size());
+            syscallCount++;
+            int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 0);
+            for (int i = 0; i < count; i++) {
+                auto it = sockets.find(events[i].data.fd);
+                if (it != sockets.end()) {
+                    // Errors and hangups are readable too, so the next read reports them
+                    it->second.readable = true;
+                }
+            }
+        }
+
+    private:
+        int epollFd;
+        std::vector<epoll_event> events;
+    };
+#endif
+}
+
+// Name for logs and the command line
+const char* ioBackendName(IoBackendKind kind) {
+    switch (kind) {
+        case IoBackendKind::IO_URING: return "io_uring";
+        case IoBackendKind::EPOLL: return "epoll";
+        case IoBackendKind::SELECT: return "select";
+        default: return "auto";
+    }
+}
+
+// Parse a backend name from the command line
+bool parseIoBackendKind(std::string_view name, IoBackendKind& kind) {
+    for (IoBackendKind candidate : { IoBackendKind::AUTO, IoBackendKind::IO_URING,
+                                     IoBackendKind::EPOLL, IoBackendKind::SELECT }) {
+        if (name == ioBackendName(candidate)) {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Create the preferred backend, falling back io_uring -> epoll -> select
+std::shared_ptr<IoBackend> IoBackend::create(IoBackendKind preferred) {
+    std::shared_ptr<IoBackend> backend;
+
+#ifdef GM_HAVE_IO_URING
+    if (preferred == IoBackendKind::AUTO || preferred == IoBackendKind::IO_URING) {
+        backend = IoUringBackend::create();
+    }
+#endif
+
+#ifdef __linux__
+    if (!backend && preferred != IoBackendKind::SELECT) {
+        auto epoll = std::make_shared<EpollBackend>();
+        if (epoll->valid()) {
+            backend = epoll;
+        }
+    }
+#endif
+
+    if (!backend) {
+        backend = std::make_shared<SelectBackend>();
+    }
+
+    if (preferred != IoBackendKind::AUTO && backend->getKind() != preferred) {
+        DEBUG_LOG(ioBackendName(preferred) << " is not available, using " << ioBackendName(backend->getKind()));
+    } else {
+        DEBUG_LOG("Using " << ioBackendName(backend->getKind()));
+    }
+    return backend;
+}
+
+// Queue a datagram for the next submit()
+void IoBackend::sendTo(socket_t socket, std::string_view datagram, const sockaddr* address, socklen_t length) {
+    PendingDatagram pending;
+    pending.socket = socket;
+    pending.data.assign(datagram.data(), datagram.size());
+    std::memcpy(&pending.address, address, std::min<size_t>(length, sizeof(pending.address)));
+    pending.length = length;
+    pendingDatagrams.push_back(std::move(pending));
+}
+
+// Forget queued datagrams for a socket that is going away
+void IoBackend::dropPending(socket_t socket) {
+    pendingDatagrams.erase(std::remove_if(pendingDatagrams.begin(), pendingDatagrams.end(),
+                                          [socket](const PendingDatagram& datagram) {
+                                              return datagram.socket == socket;
+                                          }),
+                           pendingDatagrams.end());
+}
@@ -0,0 +1,481 @@
+#include "io_uring_backend.h"
+
+#ifdef GM_HAVE_IO_URING
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "udp_framing.h"
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[IoUringBackend] " << msg << std::endl
+
+namespace {
+    const unsigned RING_ENTRIES = 256;
+
+    // Provided receive buffers, shared by every watched socket. Each holds the largest
+    // datagram the framing allows behind the recvmsg header and sender address, so
+    // nothing a peer may send is truncated; the pool is mapped lazily, so only the
+    // pages large datagrams actually reach become resident.
+    const uint16_t BUFFER_GROUP = 0;
+    const unsigned BUFFER_COUNT = 64;       // power of two
+    const size_t PAGE_BYTES = 4096;
+    const size_t BUFFER_SIZE = (UDP_MAX_DATAGRAM + sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_storage) +
+                                PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+
+    // user_data tags: receives carry their registration, sends their slot
+    const uint64_t SEND_TAG = 1ULL << 63;
+    const uint64_t CANCEL_TAG = 1ULL << 62;
+
+    // Sends may wait on a full socket buffer; beyond this many in flight, drop datagrams
+    const size_t MAX_SENDS_IN_FLIGHT = 1024;
+
+    template <typename T>
+    T* ringPointer(void* base, unsigned offset) {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+}
+
+// Set up the rings, or return null so the caller falls back
+std::shared_ptr<IoUringBackend> IoUringBackend::create() {
+    std::shared_ptr<IoUringBackend> backend(new IoUringBackend());
+    if (!backend->setup()) {
+        return nullptr;
+    }
+    return backend;
+}
+
+// Map the submission and completion rings and register the receive buffers
+bool IoUringBackend::setup() {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CLAMP;
+
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+    if (ringFd < 0) {
+        DEBUG_LOG("io_uring_setup failed: errno " << errno);
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        DEBUG_LOG("Kernel too old for this backend");
+        return false;
+    }
+
+    size_t sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ringSize = std::max(sqRingSize, cqRingSize);
+    ringMemory = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ringFd, IORING_OFF_SQ_RING);
+    if (ringMemory == MAP_FAILED) {
+        ringMemory = nullptr;
+        return false;
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ringFd, IORING_OFF_SQES);
+    if (sqeMemory == MAP_FAILED) {
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+    sqHead = ringPointer<unsigned>(ringMemory, params.sq_off.head);
+    sqTail = ringPointer<unsigned>(ringMemory, params.sq_off.tail);
+    sqFlags = ringPointer<unsigned>(ringMemory, params.sq_off.flags);
+    sqArray = ringPointer<unsigned>(ringMemory, params.sq_off.array);
+    sqMask = *ringPointer<unsigned>(ringMemory, params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    sqLocalTail = *sqTail;
+    sqSubmitted = sqLocalTail;
+    cqHead = ringPointer<unsigned>(ringMemory, params.cq_off.head);
+    cqTail = ringPointer<unsigned>(ringMemory, params.cq_off.tail);
+    cqMask = *ringPointer<unsigned>(ringMemory, params.cq_off.ring_mask);
+    cqes = ringPointer<io_uring_cqe>(ringMemory, params.cq_off.cqes);
+
+    // The buffer ring lives in our memory; the kernel takes buffers from it as data arrives
+    bufferRingSize = BUFFER_COUNT * sizeof(io_uring_buf);
+    void* bufferRingMemory = mmap(nullptr, bufferRingSize, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufferRingMemory == MAP_FAILED) {
+        return false;
+    }
+    bufferRing = static_cast<io_uring_buf*>(bufferRingMemory);
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    registration.ring_entries = BUFFER_COUNT;
+    registration.bgid = BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+        DEBUG_LOG("Provided buffer rings are not supported: errno " << errno);
+        munmap(bufferRing, bufferRingSize);
+        bufferRing = nullptr;
+        return false;
+    }
+
+    bufferPoolSize = BUFFER_COUNT * BUFFER_SIZE;
+    void* poolMemory = mmap(nullptr, bufferPoolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (poolMemory == MAP_FAILED) {
+        return false;
+    }
+    bufferPool = static_cast<char*>(poolMemory);
+
+    for (unsigned i = 0; i < BUFFER_COUNT; i++) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+    publishBuffers();
+    return true;
+}
+
+// Closing the ring cancels everything still in flight
+IoUringBackend::~IoUringBackend() {
+    if (ringFd >= 0) {
+        ::close(ringFd);
+    }
+    if (bufferRing) {
+        munmap(bufferRing, bufferRingSize);
+    }
+    if (bufferPool) {
+        munmap(bufferPool, bufferPoolSize);
+    }
+    if (sqes) {
+        munmap(sqes, sqesSize);
+    }
+    if (ringMemory) {
+        munmap(ringMemory, ringSize);
+    }
+}
+
+// Next free submission entry, zeroed; null when the ring is full
+io_uring_sqe* IoUringBackend::nextSqe() {
+    unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    if (sqLocalTail - head >= sqEntries) {
+        return nullptr;
+    }
+
+    unsigned index = sqLocalTail & sqMask;
+    sqArray[index] = index;
+    sqLocalTail++;
+
+    io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// Publish prepared entries and enter the kernel
+int IoUringBackend::enter(unsigned minComplete, unsigned flags) {
+    __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+    unsigned toSubmit = sqLocalTail - sqSubmitted;
+    sqSubmitted = sqLocalTail;
+
+    syscallCount++;
+    int result = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+    if (result < 0 && errno != EINTR && errno != EBUSY) {
+        DEBUG_LOG("io_uring_enter failed: errno " << errno);
+    }
+    return result;
+}
+
+// Put a buffer back in the ring; publishBuffers() hands the batch to the kernel
+void IoUringBackend::recycleBuffer(uint16_t bufferId) {
+    io_uring_buf& buffer = bufferRing[bufferTail & (BUFFER_COUNT - 1)];
+    buffer.addr = reinterpret_cast<uint64_t>(bufferPool + static_cast<size_t>(bufferId) * BUFFER_SIZE);
+    buffer.len = BUFFER_SIZE;
+    buffer.bid = bufferId;
+    bufferTail++;
+}
+
+// The ring's tail overlays the first entry's reserved field
+void IoUringBackend::publishBuffers() {
+    auto* tail = reinterpret_cast<uint16_t*>(reinterpret_cast<char*>(bufferRing) + offsetof(io_uring_buf, resv));
+    __atomic_store_n(tail, bufferTail, __ATOMIC_RELEASE);
+}
+
+// Arm the multishot receive for a socket
+void IoUringBackend::arm(socket_t socket, Watched& watched) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        return;
+    }
+
+    if (watched.datagram) {
+        // The sender address precedes each payload in the buffer
+        std::memset(&watched.message, 0, sizeof(watched.message));
+        watched.message.msg_namelen = sizeof(sockaddr_storage);
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(&watched.message);
+        sqe->len = 1;
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+    }
+    sqe->fd = socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = watched.registration;
+    watched.armed = true;
+}
+
+// Watch a socket and start receiving into the buffer ring at once
+bool IoUringBackend::add(socket_t socket, bool datagram) {
+    Watched& watched = sockets[socket];
+    watched = Watched();
+    watched.datagram = datagram;
+    watched.registration = nextRegistration++;
+    registrations[watched.registration] = socket;
+
+    arm(socket, watched);
+    enter(0, 0);
+    return true;
+}
+
+// Cancel the socket's receive before it is closed; late completions are ignored
+void IoUringBackend::remove(socket_t socket) {
+    auto it = sockets.find(socket);
+    if (it == sockets.end()) {
+        return;
+    }
+
+    if (it->second.armed) {
+        io_uring_sqe* sqe = nextSqe();
+        if (sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = it->second.registration;
+            sqe->user_data = CANCEL_TAG;
+            enter(0, 0);
+        }
+    }
+
+    registrations.erase(it->second.registration);
+    sockets.erase(it);
+    dropPending(socket);
+}
+
+// Drain the completion queue without entering the kernel, unless it overflowed
+void IoUringBackend::poll() {
+    if (__atomic_load_n(sqFlags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+        enter(0, IORING_ENTER_GETEVENTS);
+    }
+
+    reap();
+
+    // Multishot receives end when buffers run out; arm them again now some are back
+    bool armed = false;
+    for (auto& [socket, watched] : sockets) {
+        if (!watched.armed && !watched.direct && !watched.closed && !watched.failed) {
+            arm(socket, watched);
+            armed = true;
+        }
+    }
+    if (armed) {
+        enter(0, 0);
+    }
+}
+
+// Process every completion posted so far
+void IoUringBackend::reap() {
+    unsigned head = *cqHead;
+    unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    bool recycled = false;
+
+    while (head != tail) {
+        const io_uring_cqe& cqe = cqes[head & cqMask];
+
+        if (cqe.user_data & SEND_TAG) {
+            uint32_t slot = static_cast<uint32_t>(cqe.user_data & ~SEND_TAG);
+            freeSendSlots.push_back(slot);
+        } else if (!(cqe.user_data & CANCEL_TAG)) {
+            handleReceive(cqe);
+        }
+
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            recycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+            recycled = true;
+        }
+        head++;
+    }
+
+    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    if (recycled) {
+        publishBuffers();
+    }
+}
+
+// Copy one receive completion out of its buffer
+void IoUringBackend::handleReceive(const io_uring_cqe& cqe) {
+    auto registration = registrations.find(cqe.user_data);
+    if (registration == registrations.end()) {
+        return;     // the socket was removed
+    }
+    Watched& watched = sockets[registration->second];
+
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        watched.armed = false;
+    }
+
+    if (cqe.res < 0) {
+        if (cqe.res == -EINVAL) {
+            // Kernels before multishot receives (6.0) reject the request outright
+            DEBUG_LOG("Multishot receive unsupported, reading socket " << registration->second << " directly");
+            watched.direct = true;
+        } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+            watched.failed = true;
+        }
+        return;
+    }
+
+    // End of stream carries no buffer
+    if (!watched.datagram && cqe.res == 0) {
+        watched.closed = true;
+        return;
+    }
+
+    if (!(cqe.flags & IORING_CQE_F_BUFFER)) {
+        return;
+    }
+    uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    const char* buffer = bufferPool + static_cast<size_t>(bufferId) * BUFFER_SIZE;
+
+    if (!watched.datagram) {
+        watched.stream.append(buffer, cqe.res);
+        return;
+    }
+
+    // Multishot recvmsg layout: header, sender name, control data, payload
+    const auto* header = reinterpret_cast<const io_uring_recvmsg_out*>(buffer);
+    size_t payloadOffset = sizeof(io_uring_recvmsg_out) + watched.message.msg_namelen + watched.message.msg_controllen;
+    if (static_cast<size_t>(cqe.res) < payloadOffset) {
+        return;
+    }
+    if (header->flags & MSG_TRUNC) {
+        DEBUG_LOG("Dropped a " << header->payloadlen << " byte datagram larger than the receive buffers");
+        return;
+    }
+
+    ReceivedDatagram datagram;
+    std::memcpy(&datagram.sender, buffer + sizeof(io_uring_recvmsg_out),
+                std::min<size_t>(header->namelen, sizeof(datagram.sender)));
+    datagram.data.assign(buffer + payloadOffset, header->payloadlen);
+    watched.datagrams.push_back(std::move(datagram));
+}
+
+// Hand out stream bytes already received
+int IoUringBackend::receive(socket_t socket, char* buffer, size_t size) {
+    auto it = sockets.find(socket);
+    if (it == sockets.end()) {
+        return RECEIVE_FAILED;
+    }
+    Watched& watched = it->second;
+
+    if (watched.direct) {
+        syscallCount++;
+        int bytesReceived = recv(socket, buffer, size, 0);
+        if (bytesReceived > 0) {
+            return bytesReceived;
+        }
+        if (bytesReceived == 0) {
+            return RECEIVE_CLOSED;
+        }
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? RECEIVE_EMPTY : RECEIVE_FAILED;
+    }
+
+    size_t available = watched.stream.size() - watched.streamOffset;
+    if (available > 0) {
+        size_t count = std::min(size, available);
+        std::memcpy(buffer, watched.stream.data() + watched.streamOffset, count);
+        watched.streamOffset += count;
+        if (watched.streamOffset == watched.stream.size()) {
+            watched.stream.clear();
+            watched.streamOffset = 0;
+        }
+        return static_cast<int>(count);
+    }
+
+    if (watched.failed) {
+        return RECEIVE_FAILED;
+    }
+    return watched.closed ? RECEIVE_CLOSED : RECEIVE_EMPTY;
+}
+
+// Hand out the next datagram already received
+int IoUringBackend::receiveFrom(socket_t socket, char* buffer, size_t size, sockaddr_storage& sender) {
+    auto it = sockets.find(socket);
+    if (it == sockets.end()) {
+        return RECEIVE_FAILED;
+    }
+    Watched& watched = it->second;
+
+    if (watched.direct) {
+        socklen_t senderLength = sizeof(sender);
+        syscallCount++;
+        int bytesReceived = recvfrom(socket, buffer, size, 0, reinterpret_cast<sockaddr*>(&sender), &senderLength);
+        return bytesReceived > 0 ? bytesReceived : RECEIVE_EMPTY;
+    }
+
+    while (!watched.datagrams.empty()) {
+        ReceivedDatagram datagram = std::move(watched.datagrams.front());
+        watched.datagrams.pop_front();
+        if (datagram.data.size() > size) {
+            continue;
+        }
+        std::memcpy(buffer, datagram.data.data(), datagram.data.size());
+        sender = datagram.sender;
+        return static_cast<int>(datagram.data.size());
+    }
+    return RECEIVE_EMPTY;
+}
+
+// Turn the queued datagrams into SENDMSG entries and submit them together
+void IoUringBackend::submit() {
+    if (pendingDatagrams.empty()) {
+        return;
+    }
+
+    // Completions free the slots of earlier sends
+    reap();
+
+    for (auto& pending : pendingDatagrams) {
+        if (freeSendSlots.empty()) {
+            if (sendSlots.size() >= MAX_SENDS_IN_FLIGHT) {
+                DEBUG_LOG("Too many sends in flight, dropping a datagram");
+                continue;
+            }
+            sendSlots.push_back(std::make_unique<SendSlot>());
+            freeSendSlots.push_back(static_cast<uint32_t>(sendSlots.size() - 1));
+        }
+
+        io_uring_sqe* sqe = nextSqe();
+        if (!sqe) {
+            // Submission ring full: hand over what is there and continue
+            enter(0, 0);
+            sqe = nextSqe();
+            if (!sqe) {
+                break;
+            }
+        }
+
+        uint32_t slotIndex = freeSendSlots.back();
+        freeSendSlots.pop_back();
+        SendSlot& slot = *sendSlots[slotIndex];
+        slot.data = std::move(pending.data);
+        slot.address = pending.address;
+        slot.vector.iov_base = slot.data.data();
+        slot.vector.iov_len = slot.data.size();
+        std::memset(&slot.message, 0, sizeof(slot.message));
+        slot.message.msg_name = &slot.address;
+        slot.message.msg_namelen = pending.length;
+        slot.message.msg_iov = &slot.vector;
+        slot.message.msg_iovlen = 1;
+
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = pending.socket;
+        sqe->addr = reinterpret_cast<uint64_t>(&slot.message);
+        sqe->len = 1;
+        sqe->user_data = SEND_TAG | slotIndex;
+    }
+    pendingDatagrams.clear();
+
+    enter(0, 0);
+}
+
+#endif
@@ -0,0 +1,241 @@
+#include "latency_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[LatencyStats] " << msg << std::endl
+
+namespace {
+    // Values below this are counted exactly
+    const uint64_t LINEAR_LIMIT = 128;
+
+    // Buckets per power of two above the linear range, and its log2
+    const uint64_t SUB_BUCKETS = 64;
+    const int SUB_BUCKET_BITS = 6;
+
+    // Magnitude of LINEAR_LIMIT, the first logarithmic power of two
+    const int FIRST_MAGNITUDE = 7;
+
+    // Largest value told apart (about 67 s); anything longer is counted here
+    const int MAX_MAGNITUDE = 25;
+    const uint64_t MAX_TRACKABLE = (uint64_t(1) << (MAX_MAGNITUDE + 1)) - 1;
+
+    const size_t BUCKET_COUNT = LINEAR_LIMIT + (MAX_MAGNITUDE - FIRST_MAGNITUDE + 1) * SUB_BUCKETS;
+
+    // Inputs awaiting acknowledgement beyond this are given up on
+    const size_t MAX_IN_FLIGHT = 256;
+
+    // Column names in the CSV, indexed by LatencySegment
+    const char* SEGMENT_NAMES[] = { "send_queue", "network", "server", "end_to_end" };
+
+    uint64_t elapsedMicros(LatencyStats::Clock::time_point from, LatencyStats::Clock::time_point to) {
+        if (to <= from) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+    }
+}
+
+// Constructor
+LatencyHistogram::LatencyHistogram() :
+    counts(BUCKET_COUNT, 0)
+{
+}
+
+// Bucket holding value
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    value = std::min(value, MAX_TRACKABLE);
+    if (value < LINEAR_LIMIT) {
+        return static_cast<size_t>(value);
+    }
+
+    int magnitude = FIRST_MAGNITUDE;
+    while ((value >> (magnitude + 1)) != 0) {
+        magnitude++;
+    }
+
+    // The top SUB_BUCKET_BITS + 1 bits pick the bucket within the power of two
+    uint64_t subBucket = value >> (magnitude - SUB_BUCKET_BITS);
+    return static_cast<size_t>(LINEAR_LIMIT + (magnitude - FIRST_MAGNITUDE) * SUB_BUCKETS + (subBucket - SUB_BUCKETS));
+}
+
+// Largest value that lands in the bucket
+uint64_t LatencyHistogram::highestEquivalentValue(size_t index) {
+    if (index < LINEAR_LIMIT) {
+        return index;
+    }
+
+    size_t offset = index - LINEAR_LIMIT;
+    int magnitude = FIRST_MAGNITUDE + static_cast<int>(offset / SUB_BUCKETS);
+    uint64_t subBucket = SUB_BUCKETS + offset % SUB_BUCKETS;
+    int shift = magnitude - SUB_BUCKET_BITS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+// Count one sample
+void LatencyHistogram::record(uint64_t micros) {
+    counts[bucketIndex(micros)]++;
+    count++;
+    sum += micros;
+    maxValue = std::max(maxValue, micros);
+}
+
+// Walk the buckets until the percentile's rank is reached
+uint64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    double clamped = std::clamp(percentile, 0.0, 100.0);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(highestEquivalentValue(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+// Drop every sample
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    count = 0;
+    sum = 0;
+    maxValue = 0;
+}
+
+// Destructor
+LatencyStats::~LatencyStats() {
+    stopLog();
+}
+
+// Microseconds on the client clock
+uint64_t LatencyStats::toMicros(Clock::time_point time) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count());
+}
+
+// Remember the INPUT waiting in the outbound queue
+void LatencyStats::onInputQueued(SequenceNumber sequence, Clock::time_point sampledAt) {
+    hasQueued = true;
+    queuedSequence = sequence;
+    queuedSampledAt = sampledAt;
+}
+
+// Start the network leg of the waiting INPUT
+void LatencyStats::onInputSent(Clock::time_point now) {
+    if (!hasQueued) {
+        return;
+    }
+    hasQueued = false;
+
+    inFlight.push_back({ queuedSequence, queuedSampledAt, now });
+    if (inFlight.size() > MAX_IN_FLIGHT) {
+        inFlight.pop_front();
+    }
+}
+
+// Split the acknowledged INPUT's time into its segments
+void LatencyStats::onInputAcked(SequenceNumber sequence, uint64_t echoedMicros, uint64_t serverMicros,
+                                Clock::time_point now) {
+    // Older inputs were superseded or their acknowledgements lost
+    while (!inFlight.empty() && sequenceGreaterThan(sequence, inFlight.front().sequence)) {
+        inFlight.pop_front();
+    }
+
+    // A repeated acknowledgement was already counted
+    if (inFlight.empty() || inFlight.front().sequence != sequence) {
+        return;
+    }
+    SentInput sent = inFlight.front();
+    inFlight.pop_front();
+
+    uint64_t roundTrip = elapsedMicros(sent.sentAt, now);
+    serverMicros = std::min(serverMicros, roundTrip);
+
+    histograms[static_cast<size_t>(LatencySegment::SEND_QUEUE)].record(elapsedMicros(sent.sampledAt, sent.sentAt));
+    histograms[static_cast<size_t>(LatencySegment::NETWORK)].record(roundTrip - serverMicros);
+    histograms[static_cast<size_t>(LatencySegment::SERVER)].record(serverMicros);
+
+    // The echoed stamp is authoritative; servers that don't echo fall back to ours
+    uint64_t nowMicros = toMicros(now);
+    uint64_t sampledMicros = echoedMicros != 0 ? echoedMicros : toMicros(sent.sampledAt);
+    if (nowMicros >= sampledMicros) {
+        histograms[static_cast<size_t>(LatencySegment::END_TO_END)].record(nowMicros - sampledMicros);
+    }
+}
+
+// Open the CSV and write its header
+bool LatencyStats::startLog(const std::string& path, std::chrono::seconds interval) {
+    stopLog();
+
+    log.open(path, std::ios::out | std::ios::trunc);
+    if (!log.is_open()) {
+        DEBUG_LOG("Failed to open latency log " << path);
+        return false;
+    }
+
+    log << "elapsed_s,segment,count,p50_us,p90_us,p99_us,p999_us,max_us,mean_us\n";
+    logInterval = std::max(interval, std::chrono::seconds(1));
+    logStart = Clock::now();
+    intervalStart = logStart;
+    for (auto& histogram : histograms) {
+        histogram.reset();
+    }
+
+    DEBUG_LOG("Logging latency percentiles to " << path << " every " << logInterval.count() << " s");
+    return true;
+}
+
+// Write the last partial interval and close the CSV
+void LatencyStats::stopLog() {
+    if (!log.is_open()) {
+        return;
+    }
+    writeInterval(Clock::now());
+    log.close();
+}
+
+// Write a row once the interval has elapsed
+void LatencyStats::update(Clock::time_point now) {
+    if (log.is_open() && now - intervalStart >= logInterval) {
+        writeInterval(now);
+        intervalStart = now;
+    }
+}
+
+// One row per segment with samples, then start the next interval empty
+void LatencyStats::writeInterval(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - logStart).count();
+
+    for (size_t i = 0; i < histograms.size(); i++) {
+        LatencyHistogram& histogram = histograms[i];
+        if (histogram.getCount() == 0) {
+            continue;
+        }
+
+        log << std::fixed << std::setprecision(1) << elapsed << ','
+            << SEGMENT_NAMES[i] << ','
+            << histogram.getCount() << ','
+            << histogram.valueAtPercentile(50.0) << ','
+            << histogram.valueAtPercentile(90.0) << ','
+            << histogram.valueAtPercentile(99.0) << ','
+            << histogram.valueAtPercentile(99.9) << ','
+            << histogram.getMax() << ','
+            << histogram.getMean() << '\n';
+        histogram.reset();
+    }
+    log.flush();
+}
+
+// Forget inputs in flight
+void LatencyStats::resetInFlight() {
+    hasQueued = false;
+    inFlight.clear();
+}
@@ -0,0 +1,184 @@
+#include "loopback_transport.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[LoopbackTransport] " << msg << std::endl
+
+namespace {
+    // Unread stream bytes the peer may fall behind by before flushStream() waits
+    const size_t MAX_PENDING_STREAM_BYTES = 1024 * 1024;
+
+    // Unread datagrams per direction before new ones are dropped
+    const size_t MAX_PENDING_DATAGRAMS = 1024;
+
+    // Listeners by name
+    std::unordered_map<std::string, LoopbackListener*>& listeners() {
+        static std::unordered_map<std::string, LoopbackListener*> registry;
+        return registry;
+    }
+}
+
+// Client end
+LoopbackTransport::LoopbackTransport(std::string name) :
+    name(std::move(name))
+{
+}
+
+// Server end
+LoopbackTransport::LoopbackTransport(std::string name, std::shared_ptr<LoopbackLink> link, int side) :
+    name(std::move(name)),
+    state(State::CONNECTED),
+    link(std::move(link)),
+    side(side)
+{
+    statusMessage = "Connected to client";
+}
+
+// Destructor
+LoopbackTransport::~LoopbackTransport() {
+    disconnect();
+}
+
+// Connect to the listener; there is nothing to wait for
+bool LoopbackTransport::open() {
+    disconnect();
+
+    LoopbackListener* listener = LoopbackListener::find(name);
+    if (!listener) {
+        DEBUG_LOG("No loopback server named " << name);
+        state = State::FAILED;
+        statusMessage = "No loopback server named " + name;
+        return false;
+    }
+
+    link = std::make_shared<LoopbackLink>();
+    side = 0;
+    listener->pending.push_back(link);
+
+    state = State::CONNECTED;
+    statusMessage = "Connected to server";
+    return true;
+}
+
+// Let go of the link; the peer reads what is left, then sees the stream close
+void LoopbackTransport::disconnect() {
+    if (link) {
+        link->closed[side] = true;
+        link.reset();
+    }
+}
+
+// Move whole messages into the peer's stream while it is not too far behind
+TcpOutboundQueue::FlushResult LoopbackTransport::flushStream(TcpOutboundQueue& queue) {
+    if (!link || link->closed[1 - side]) {
+        return TcpOutboundQueue::FlushResult::FAILED;
+    }
+
+    std::string& stream = link->stream[side];
+    std::string message;
+    while (stream.size() - link->streamOffset[side] < MAX_PENDING_STREAM_BYTES) {
+        if (!queue.popFront(message)) {
+            return TcpOutboundQueue::FlushResult::DRAINED;
+        }
+        stream.append(message).push_back('\n');
+    }
+    return queue.getQueuedMessages() == 0 ? TcpOutboundQueue::FlushResult::DRAINED
+                                          : TcpOutboundQueue::FlushResult::PENDING;
+}
+
+// Read what the peer wrote
+int LoopbackTransport::receiveStream(char* buffer, size_t size) {
+    if (!link) {
+        return STREAM_FAILED;
+    }
+
+    int from = 1 - side;
+    std::string& stream = link->stream[from];
+    size_t& offset = link->streamOffset[from];
+
+    size_t count = std::min(size, stream.size() - offset);
+    if (count == 0) {
+        return link->closed[from] ? STREAM_CLOSED : STREAM_EMPTY;
+    }
+
+    std::memcpy(buffer, stream.data() + offset, count);
+    offset += count;
+    if (offset == stream.size()) {
+        stream.clear();
+        offset = 0;
+    }
+    return static_cast<int>(count);
+}
+
+// Queue a datagram for the peer, or drop it when the peer is not keeping up
+bool LoopbackTransport::sendDatagram(std::string_view datagram) {
+    if (!link || link->closed[1 - side]) {
+        return false;
+    }
+
+    auto& datagrams = link->datagrams[side];
+    if (datagrams.size() >= MAX_PENDING_DATAGRAMS) {
+        return true;    // lost on the way, as UDP would lose it
+    }
+    datagrams.emplace_back(datagram);
+    return true;
+}
+
+// Take the next datagram from the peer
+int LoopbackTransport::receiveDatagram(char* buffer, size_t size) {
+    if (!link) {
+        return 0;
+    }
+
+    auto& datagrams = link->datagrams[1 - side];
+    while (!datagrams.empty()) {
+        std::string datagram = std::move(datagrams.front());
+        datagrams.pop_front();
+        if (datagram.size() <= size) {
+            std::memcpy(buffer, datagram.data(), datagram.size());
+            return static_cast<int>(datagram.size());
+        }
+    }
+    return 0;
+}
+
+// Register the name
+LoopbackListener::LoopbackListener(std::string name) :
+    name(std::move(name))
+{
+    auto [it, inserted] = listeners().emplace(this->name, this);
+    if (!inserted) {
+        DEBUG_LOG("Loopback server " << this->name << " replaces an existing one");
+        it->second = this;
+    }
+}
+
+// Unregister; connections already accepted stay up
+LoopbackListener::~LoopbackListener() {
+    auto it = listeners().find(name);
+    if (it != listeners().end() && it->second == this) {
+        listeners().erase(it);
+    }
+    for (auto& link : pending) {
+        link->closed[1] = true;
+    }
+}
+
+// Hand over the next waiting client
+std::unique_ptr<Transport> LoopbackListener::accept() {
+    if (pending.empty()) {
+        return nullptr;
+    }
+    std::shared_ptr<LoopbackLink> link = std::move(pending.front());
+    pending.pop_front();
+    return std::make_unique<LoopbackTransport>(name, std::move(link), 1);
+}
+
+// Look up a listener by name
+LoopbackListener* LoopbackListener::find(const std::string& name) {
+    auto it = listeners().find(name);
+    return it != listeners().end() ? it->second : nullptr;
+}
@@ -7,9 +7,29 @@
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options]" << std::endl;
     std::cout << "Options:" << std::endl;
-    std::cout << "  -s, --server <address>   Server address (default: 127.0.0.1)" << std::endl;
+    std::cout << "  -s, --server <address>   Server address, or unix:<path> for a same-host socket (default: 127.0.0.1)" << std::endl;
     std::cout << "  -t, --tcp-port <port>    TCP port (default: 9999)" << std::endl;
     std::cout << "  -u, --udp-port <port>    UDP port (default: 9998)" << std::endl;
+    std::cout << "  -m, --mtu <bytes>        Largest UDP datagram to send (default: 1200)" << std::endl;
+    std::cout << "  -b, --uplink <bytes/s>   UDP send budget, 0 for unlimited (default: 0)" << std::endl;
+    std::cout << "  -R, --send-rate <min:max> Bounds for the adaptive state send rate in Hz (default: 5:30)" << std::endl;
+    std::cout << "  -L, --sim-latency <ms>   Simulated one-way delay in each direction" << std::endl;
+    std::cout << "  -J, --sim-jitter <ms>    Simulated +/- variation on the delay" << std::endl;
+    std::cout << "  -x, --sim-loss <pct>     Simulated datagram loss" << std::endl;
+    std::cout << "  -D, --sim-duplicate <pct> Simulated datagram duplication" << std::endl;
+    std::cout << "  -O, --sim-reorder <pct>  Simulated datagram reordering" << std::endl;
+    std::cout << "  -B, --sim-bandwidth <bytes/s> Simulated link rate in each direction" << std::endl;
+    std::cout << "  -S, --sim-seed <n>       Seed for the simulated impairments (default: 1)" << std::endl;
+    std::cout << "  -i, --io-backend <name>  Socket I/O: auto, io_uring, epoll or select (default: auto)" << std::endl;
+    std::cout << "  -N, --net-budget <ms>[:<messages>] Per-frame limit on handling server messages, 0 for unlimited (default: 4)" << std::endl;
+    std::cout << "  -l, --latency-log <file> Write input-to-echo latency percentiles to a CSV file" << std::endl;
+    std::cout << "  -r, --record <file>      Record inbound network traffic to a capture file" << std::endl;
+    std::cout << "  -p, --replay <file>      Replay a capture file instead of connecting" << std::endl;
+    std::cout << "  -f, --replay-fast        Replay as fast as possible instead of at original speed" << std::endl;
+    std::cout << "  -k, --tick-rate <hz>     Simulation ticks per second (default: 60)" << std::endl;
+    std::cout << "  -F, --fps <n>            Render frame cap, 0 for uncapped (default: 60)" << std::endl;
+    std::cout << "  -v, --vsync              Limit rendering to the display refresh rate" << std::endl;
+    std::cout << "  -a, --assets <file>      Packed asset archive (default: assets.gmpk)" << std::endl;
     std::cout << "  -h, --help               Show this help" << std::endl;
 }
 
@@ -18,12 +38,47 @@ int main(int argc, char* argv[]) {
     std::string serverAddress = "127.0.0.1";
     int tcpPort = 9999;
     int udpPort = 9998;
+    int maxDatagramSize = 1200;
+    int uplinkRate = 0;
+    double minSendRate = 5.0;
+    double maxSendRate = 30.0;
+    std::string recordPath;
+    std::string latencyLogPath;
+    NetworkConditions networkConditions;
+    IoBackendKind ioBackendKind = IoBackendKind::AUTO;
+    ProcessingBudget processingBudget;
+    std::string replayPath;
+    ReplaySpeed replaySpeed = ReplaySpeed::REALTIME;
+    int tickRate = 60;
+    int targetFps = 60;
+    bool vsync = false;
+    std::string assetPath = "assets.gmpk";
     
     // Parse command-line arguments
     static struct option long_options[] = {
         {"server", required_argument, 0, 's'},
         {"tcp-port", required_argument, 0, 't'},
         {"udp-port", required_argument, 0, 'u'},
+        {"mtu", required_argument, 0, 'm'},
+        {"uplink", required_argument, 0, 'b'},
+        {"send-rate", required_argument, 0, 'R'},
+        {"sim-latency", required_argument, 0, 'L'},
+        {"sim-jitter", required_argument, 0, 'J'},
+        {"sim-loss", required_argument, 0, 'x'},
+        {"sim-duplicate", required_argument, 0, 'D'},
+        {"sim-reorder", required_argument, 0, 'O'},
+        {"sim-bandwidth", required_argument, 0, 'B'},
+        {"sim-seed", required_argument, 0, 'S'},
+        {"io-backend", required_argument, 0, 'i'},
+        {"net-budget", required_argument, 0, 'N'},
+        {"latency-log", required_argument, 0, 'l'},
+        {"record", required_argument, 0, 'r'},
+        {"replay", required_argument, 0, 'p'},
+        {"replay-fast", no_argument, 0, 'f'},
+        {"tick-rate", required_argument, 0, 'k'},
+        {"fps", required_argument, 0, 'F'},
+        {"vsync", no_argument, 0, 'v'},
+        {"assets", required_argument, 0, 'a'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
@@ -31,7 +86,7 @@ int main(int argc, char* argv[]) {
     int opt;
     int option_index = 0;
     
-    while ((opt = getopt_long(argc, argv, "s:t:u:h", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "s:t:u:m:b:R:L:J:x:D:O:B:S:i:N:l:r:p:fk:F:va:h", long_options, &option_index)) != -1) {
         switch (opt) {
             case 's':
                 serverAddress = optarg;
@@ -42,6 +97,82 @@ int main(int argc, char* argv[]) {
             case 'u':
                 udpPort = std::stoi(optarg);
                 break;
+            case 'm':
+                maxDatagramSize = std::stoi(optarg);
+                break;
+            case 'b':
+                uplinkRate = std::stoi(optarg);
+                break;
+            case 'R': {
+                std::string bounds = optarg;
+                size_t colon = bounds.find(':');
+                if (colon == std::string::npos) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                minSendRate = std::stod(bounds.substr(0, colon));
+                maxSendRate = std::stod(bounds.substr(colon + 1));
+                break;
+            }
+            case 'L':
+                networkConditions.latencyMs = std::stod(optarg);
+                break;
+            case 'J':
+                networkConditions.jitterMs = std::stod(optarg);
+                break;
+            case 'x':
+                networkConditions.lossPercent = std::stod(optarg);
+                break;
+            case 'D':
+                networkConditions.duplicatePercent = std::stod(optarg);
+                break;
+            case 'O':
+                networkConditions.reorderPercent = std::stod(optarg);
+                break;
+            case 'B':
+                networkConditions.bandwidthBytesPerSecond = std::stod(optarg);
+                break;
+            case 'S':
+                networkConditions.seed = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'i':
+                if (!parseIoBackendKind(optarg, ioBackendKind)) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'N': {
+                std::string budget = optarg;
+                size_t colon = budget.find(':');
+                processingBudget.time = std::chrono::microseconds(
+                    static_cast<int64_t>(std::stod(budget.substr(0, colon)) * 1000.0));
+                processingBudget.messages = colon == std::string::npos ? 0 : std::stoul(budget.substr(colon + 1));
+                break;
+            }
+            case 'l':
+                latencyLogPath = optarg;
+                break;
+            case 'r':
+                recordPath = optarg;
+                break;
+            case 'p':
+                replayPath = optarg;
+                break;
+            case 'f':
+                replaySpeed = ReplaySpeed::AS_FAST_AS_POSSIBLE;
+                break;
+            case 'k':
+                tickRate = std::stoi(optarg);
+                break;
+            case 'F':
+                targetFps = std::stoi(optarg);
+                break;
+            case 'v':
+                vsync = true;
+                break;
+            case 'a':
+                assetPath = optarg;
+                break;
             case 'h':
                 printUsage(argv[0]);
                 return 0;
@@ -54,6 +185,15 @@ int main(int argc, char* argv[]) {
     // Create and initialize game
     Game game;
     game.setServerConfig(serverAddress, tcpPort, udpPort);
+    game.setNetworkConfig(maxDatagramSize, uplinkRate);
+    game.setSendRateBounds(minSendRate, maxSendRate);
+    game.setNetworkConditions(networkConditions);
+    game.setIoBackendKind(ioBackendKind);
+    game.setProcessingBudget(processingBudget);
+    game.setCaptureConfig(recordPath, replayPath, replaySpeed);
+    game.setLatencyLogPath(latencyLogPath);
+    game.setSimulationConfig(tickRate, targetFps, vsync);
+    game.setAssetPath(assetPath);
     game.init(800, 600, "Guild Master");
     
     // Run game loop
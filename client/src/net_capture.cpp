@@ -0,0 +1,154 @@
+#include "net_capture.h"
+#include <iostream>
+#include <cstring>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[NetCapture] " << msg << std::endl
+
+namespace {
+    const char CAPTURE_MAGIC[5] = { 'G', 'M', 'C', 'A', 'P' };
+}
+
+// Destructor
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+// Open a capture file for writing
+bool CaptureWriter::open(const std::string& path) {
+    close();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        DEBUG_LOG("Failed to open capture file for writing: " << path);
+        return false;
+    }
+
+    file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    file.put(static_cast<char>(CAPTURE_FORMAT_VERSION));
+
+    startTime = std::chrono::steady_clock::now();
+    lastTimestampUs = 0;
+    frameHasData = false;
+
+    DEBUG_LOG("Recording network traffic to " << path);
+    return true;
+}
+
+// Flush and close the capture file
+void CaptureWriter::close() {
+    if (file.is_open()) {
+        endFrame();
+        file.close();
+    }
+}
+
+// Append a record
+void CaptureWriter::write(CaptureChannel channel, const char* data, size_t length) {
+    if (!file.is_open()) {
+        return;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    uint64_t timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+    file.put(static_cast<char>(channel));
+    writeVarint(timestampUs - lastTimestampUs);
+    writeVarint(length);
+    if (length > 0) {
+        file.write(data, static_cast<std::streamsize>(length));
+    }
+
+    lastTimestampUs = timestampUs;
+    frameHasData = (channel != CaptureChannel::FRAME);
+}
+
+// Mark the end of a frame
+void CaptureWriter::endFrame() {
+    if (frameHasData) {
+        write(CaptureChannel::FRAME, nullptr, 0);
+    }
+}
+
+// Write an unsigned LEB128 varint
+void CaptureWriter::writeVarint(uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0) {
+            byte |= 0x80;
+        }
+        file.put(static_cast<char>(byte));
+    } while (value != 0);
+}
+
+// Open a capture file for reading
+bool CaptureReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        DEBUG_LOG("Failed to open capture file: " << path);
+        return false;
+    }
+
+    char magic[sizeof(CAPTURE_MAGIC)];
+    file.read(magic, sizeof(magic));
+    int version = file.get();
+
+    if (!file || memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0) {
+        DEBUG_LOG("Not a capture file: " << path);
+        file.close();
+        return false;
+    }
+
+    if (version != CAPTURE_FORMAT_VERSION) {
+        DEBUG_LOG("Unsupported capture version " << version << " in " << path);
+        file.close();
+        return false;
+    }
+
+    lastTimestampUs = 0;
+    return true;
+}
+
+// Read the next record
+bool CaptureReader::next(CaptureRecord& record) {
+    int channel = file.get();
+    if (channel == std::char_traits<char>::eof() || channel > static_cast<int>(CaptureChannel::FRAME)) {
+        return false;
+    }
+
+    uint64_t deltaUs = 0;
+    uint64_t length = 0;
+    if (!readVarint(deltaUs) || !readVarint(length)) {
+        return false;
+    }
+
+    record.channel = static_cast<CaptureChannel>(channel);
+    record.timestampUs = lastTimestampUs + deltaUs;
+    record.data.resize(length);
+    if (length > 0) {
+        file.read(&record.data[0], static_cast<std::streamsize>(length));
+        if (!file) {
+            return false;
+        }
+    }
+
+    lastTimestampUs = record.timestampUs;
+    return true;
+}
+
+// Read an unsigned LEB128 varint
+bool CaptureReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = file.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,194 @@
+#include "net_task.h"
+#include <algorithm>
+#include <iostream>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[NetExecutor] " << msg << std::endl
+
+// Destroy flows that never finished; each takes the tasks it was awaiting with it
+NetExecutor::~NetExecutor() {
+    for (void* address : flows) {
+        std::coroutine_handle<>::from_address(address).destroy();
+    }
+}
+
+// Take ownership of a flow and start it on the next run()
+void NetExecutor::spawn(Task<void> task) {
+    auto handle = std::exchange(task.handle, nullptr);
+    if (!handle) {
+        return;
+    }
+    handle.promise().owner = this;
+    flows.insert(handle.address());
+    ready.push_back(handle);
+}
+
+// Finish a wait and queue its coroutine for the next run()
+bool NetExecutor::complete(const std::shared_ptr<NetWait>& wait, std::optional<std::string> value) {
+    if (wait->finished) {
+        return false;
+    }
+    wait->finished = true;
+    wait->value = std::move(value);
+
+    // A wait finished before its coroutine suspended is picked up by await_ready()
+    if (wait->handle) {
+        ready.push_back(wait->handle);
+    }
+    return true;
+}
+
+// Schedule the wait's timeout
+void NetExecutor::expireAt(const std::shared_ptr<NetWait>& wait, Clock::time_point deadline) {
+    timers.push(Timer{ deadline, nextTimerSequence++, wait });
+}
+
+// Fire due timeouts, then resume what was queued. Coroutines queued while resuming
+// wait for the next run(), so a flow cannot starve the frame.
+void NetExecutor::run(Clock::time_point now) {
+    while (!timers.empty() && timers.top().deadline <= now) {
+        std::shared_ptr<NetWait> wait = timers.top().wait;
+        timers.pop();
+        complete(wait, std::nullopt);
+    }
+
+    size_t count = ready.size();
+    for (size_t i = 0; i < count; i++) {
+        std::coroutine_handle<> handle = ready.front();
+        ready.pop_front();
+        handle.resume();
+    }
+}
+
+// Wait that only its deadline finishes
+NetWaitAwaiter NetExecutor::sleepFor(Clock::duration duration) {
+    auto wait = std::make_shared<NetWait>();
+    expireAt(wait, Clock::now() + duration);
+    return NetWaitAwaiter{ wait };
+}
+
+// Free a spawned flow that returned
+void NetExecutor::release(std::coroutine_handle<> flow, const std::exception_ptr& exception) {
+    if (exception) {
+        try {
+            std::rethrow_exception(exception);
+        } catch (const std::exception& e) {
+            DEBUG_LOG("Flow ended with an exception: " << e.what());
+        } catch (...) {
+            DEBUG_LOG("Flow ended with an unknown exception");
+        }
+    }
+
+    flows.erase(flow.address());
+    flow.destroy();
+}
+
+// Take the next queued payload, or park until one arrives
+NetWaitAwaiter MessageStream::next() {
+    auto wait = std::make_shared<NetWait>();
+    if (!state) {
+        wait->finished = true;
+        return NetWaitAwaiter{ wait };
+    }
+
+    if (!state->queued.empty()) {
+        wait->finished = true;
+        wait->value = std::move(state->queued.front());
+        state->queued.pop_front();
+    } else if (state->closed) {
+        wait->finished = true;
+    } else {
+        state->waiting = wait;
+    }
+    return NetWaitAwaiter{ wait };
+}
+
+// Park until the next message with this command or the timeout
+NetWaitAwaiter MessageRouter::receive(std::string command, std::chrono::milliseconds timeout) {
+    auto wait = std::make_shared<NetWait>();
+
+    // Waits that timed out stay listed until a message or a new wait clears them
+    auto& list = waits[std::move(command)];
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [](const std::shared_ptr<NetWait>& w) { return w->finished; }),
+               list.end());
+    list.push_back(wait);
+
+    executor.expireAt(wait, NetExecutor::Clock::now() + timeout);
+    return NetWaitAwaiter{ wait };
+}
+
+// Open a stream of every message with this command
+MessageStream MessageRouter::subscribe(std::string command) {
+    auto state = std::make_shared<MessageStream::State>();
+    streams[std::move(command)].push_back(state);
+    return MessageStream(state);
+}
+
+// The oldest wait for the command gets the message, and every stream a copy
+void MessageRouter::deliver(std::string_view command, std::string_view payload) {
+    if (empty()) {
+        return;
+    }
+    std::string key(command);
+
+    auto waitList = waits.find(key);
+    if (waitList != waits.end()) {
+        auto& list = waitList->second;
+        auto it = list.begin();
+        while (it != list.end() && !executor.complete(*it, std::string(payload))) {
+            ++it;   // timed out already
+        }
+        list.erase(list.begin(), it == list.end() ? it : it + 1);
+        if (list.empty()) {
+            waits.erase(waitList);
+        }
+    }
+
+    auto streamList = streams.find(key);
+    if (streamList != streams.end()) {
+        auto& list = streamList->second;
+        for (auto it = list.begin(); it != list.end();) {
+            std::shared_ptr<MessageStream::State> state = it->lock();
+            if (!state) {
+                it = list.erase(it);
+                continue;
+            }
+            if (state->waiting && executor.complete(state->waiting, std::string(payload))) {
+                state->waiting.reset();
+            } else {
+                state->queued.emplace_back(payload);
+            }
+            ++it;
+        }
+        if (list.empty()) {
+            streams.erase(streamList);
+        }
+    }
+}
+
+// Wake every single-message wait empty-handed
+void MessageRouter::failWaits() {
+    for (auto& [command, list] : waits) {
+        for (auto& wait : list) {
+            executor.complete(wait, std::nullopt);
+        }
+    }
+    waits.clear();
+}
+
+// Close every stream; flows drain what is queued, then get nullopt
+void MessageRouter::closeStreams() {
+    for (auto& [command, list] : streams) {
+        for (auto& weak : list) {
+            if (auto state = weak.lock()) {
+                state->closed = true;
+                if (state->waiting) {
+                    executor.complete(state->waiting, std::nullopt);
+                    state->waiting.reset();
+                }
+            }
+        }
+    }
+    streams.clear();
+}
@@ -7,30 +7,74 @@
 #include <iomanip>
 #include <nlohmann/json.hpp>
 #include <thread>
-
-// Platform-specific socket includes
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    typedef SOCKET socket_t;
-    #pragma comment(lib, "ws2_32.lib")
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <netdb.h>
-    #include <unistd.h>
-    #include <fcntl.h>
-    typedef int socket_t;
-#endif
+#include <array>
+#include <cmath>
 
 // For debug logs
 #define DEBUG_LOG(msg) std::cout << "[NetworkClient] " << msg << std::endl
 
+namespace {
+    // View of a decoded JSON string; throws for non-strings like get<std::string>() does
+    std::string_view stringView(const FrameJson& value) {
+        const ArenaString& str = value.get_ref<const ArenaString&>();
+        return std::string_view(str.data(), str.size());
+    }
+    
+    // Reconnect backoff: the first attempt is immediate, later ones wait twice as long
+    // as the last up to the maximum. The server keeps a dropped session for 20 seconds.
+    const auto RECONNECT_INITIAL_DELAY = std::chrono::milliseconds(250);
+    const auto RECONNECT_MAX_DELAY = std::chrono::milliseconds(4000);
+    const auto RECONNECT_WINDOW = std::chrono::seconds(15);
+    
+    // Wait before retrying a speculative connection that failed or was closed
+    const auto SPECULATIVE_RETRY_DELAY = std::chrono::seconds(2);
+    
+    // Stream bytes read per update; more waits in the socket for the next one
+    const size_t MAX_STREAM_BYTES_PER_UPDATE = 256 * 1024;
+
+    // The string pool is rebuilt once it holds this many entries more than the
+    // players it currently needs (about four strings each)
+    const size_t STRING_POOL_SLACK = 1024;
+    const size_t STRING_POOL_ENTRIES_PER_PLAYER = 4;
+    
+    // Decode standard base64 into out, reusing its capacity
+    bool decodeBase64(std::string_view input, std::vector<uint8_t>& out) {
+        static const auto table = [] {
+            std::array<int8_t, 256> t{};
+            t.fill(-1);
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 64; i++) {
+                t[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+            }
+            return t;
+        }();
+        
+        out.clear();
+        out.reserve(input.size() / 4 * 3);
+        
+        uint32_t buffer = 0;
+        int bits = 0;
+        for (char c : input) {
+            if (c == '=') {
+                break;
+            }
+            int8_t value = table[static_cast<uint8_t>(c)];
+            if (value < 0) {
+                return false;
+            }
+            buffer = (buffer << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                out.push_back(static_cast<uint8_t>(buffer >> bits));
+            }
+        }
+        return true;
+    }
+}
+
 // Constructor
 NetworkClient::NetworkClient() : 
-    tcpSocket(INVALID_SOCKET),
-    udpSocket(INVALID_SOCKET),
     status(ConnectionStatus::DISCONNECTED),
     statusMessage("Not connected"),
     tcpConnectPending(false),
@@ -58,237 +102,378 @@ bool NetworkClient::initialize() {
 // Connect to server
 bool NetworkClient::connect(const std::string& serverAddress, int tcpPort, int udpPort) {
     // Already connected or connecting
-    if (status == ConnectionStatus::CONNECTED || status == ConnectionStatus::CONNECTING) {
+    if (status == ConnectionStatus::CONNECTED || status == ConnectionStatus::CONNECTING ||
+        status == ConnectionStatus::RECONNECTING) {
         return false;
     }
     
-    // Update status
-    status = ConnectionStatus::CONNECTING;
-    statusMessage = "Connecting to server...";
-    connectStartTime = std::chrono::steady_clock::now();
+    resumeToken.clear();
+    
+    // Adopt the connection prepare() opened if it went to the same place
+    bool samePeer = connectAddress == serverAddress && connectTcpPort == tcpPort && connectUdpPort == udpPort;
+    if (speculative && samePeer && transport) {
+        speculative = false;
+        
+        if (tcpConnectPending) {
+            status = ConnectionStatus::CONNECTING;
+            return true;
+        }
+        
+        DEBUG_LOG("Logging in over the connection opened ahead of time to " << transport->describePeer());
+        status = ConnectionStatus::CONNECTED;
+        statusMessage = "Connected to server";
+        lastMessageTime = std::chrono::steady_clock::now();
+        lastPingTime = lastMessageTime;
+        sendPendingConnect();
+        return true;
+    }
     
-    // Create TCP socket
-    tcpSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (tcpSocket == INVALID_SOCKET) {
+    speculative = false;
+    resetLink();
+    connectAddress = serverAddress;
+    connectTcpPort = tcpPort;
+    connectUdpPort = udpPort;
+    
+    if (!openTransport()) {
         status = ConnectionStatus::CONNECTION_FAILED;
-        statusMessage = "Failed to create TCP socket";
         return false;
     }
     
-    // Create UDP socket
-    udpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (udpSocket == INVALID_SOCKET) {
-        closesocket(tcpSocket);
-        tcpSocket = INVALID_SOCKET;
-        status = ConnectionStatus::CONNECTION_FAILED;
-        statusMessage = "Failed to create UDP socket";
+    // update() polls the transport until it connects or gives up
+    status = ConnectionStatus::CONNECTING;
+    return true;
+}
+
+// Start connecting without logging in
+bool NetworkClient::prepare(const std::string& serverAddress, int tcpPort, int udpPort) {
+    if (replaying || (status != ConnectionStatus::DISCONNECTED && status != ConnectionStatus::CONNECTION_FAILED)) {
         return false;
     }
     
-    // Set server addresses
-    memset(&serverTcpAddr, 0, sizeof(serverTcpAddr));
-    serverTcpAddr.sin_family = AF_INET;
-    serverTcpAddr.sin_port = htons(tcpPort);
-    
-    memset(&serverUdpAddr, 0, sizeof(serverUdpAddr));
-    serverUdpAddr.sin_family = AF_INET;
-    serverUdpAddr.sin_port = htons(udpPort);
-    
-    // Resolve server address
-    if (inet_pton(AF_INET, serverAddress.c_str(), &serverTcpAddr.sin_addr) <= 0) {
-        struct hostent* he = gethostbyname(serverAddress.c_str());
-        if (!he) {
-            closesocket(tcpSocket);
-            closesocket(udpSocket);
-            tcpSocket = INVALID_SOCKET;
-            udpSocket = INVALID_SOCKET;
-            status = ConnectionStatus::CONNECTION_FAILED;
-            statusMessage = "Failed to resolve server address";
-            return false;
+    bool samePeer = connectAddress == serverAddress && connectTcpPort == tcpPort && connectUdpPort == udpPort;
+    if (speculative && samePeer) {
+        return true;
+    }
+    
+    resetLink();
+    connectAddress = serverAddress;
+    connectTcpPort = tcpPort;
+    connectUdpPort = udpPort;
+    speculative = true;
+    
+    DEBUG_LOG("Connecting to " << serverAddress << " ahead of login");
+    if (!openTransport()) {
+        nextSpeculativeAttempt = std::chrono::steady_clock::now() + SPECULATIVE_RETRY_DELAY;
+    }
+    return true;
+}
+
+// Finish the speculative connection, and open it again if it fails or the server lets go
+void NetworkClient::updateSpeculative() {
+    auto now = std::chrono::steady_clock::now();
+    
+    if (!transport) {
+        if (now >= nextSpeculativeAttempt && !openTransport()) {
+            nextSpeculativeAttempt = now + SPECULATIVE_RETRY_DELAY;
         }
-        memcpy(&serverTcpAddr.sin_addr, he->h_addr_list[0], he->h_length);
-        memcpy(&serverUdpAddr.sin_addr, he->h_addr_list[0], he->h_length);
-    } else {
-        serverUdpAddr.sin_addr = serverTcpAddr.sin_addr;
+        return;
     }
     
-    // Set non-blocking mode for TCP socket
-    if (!setSocketNonBlocking(tcpSocket)) {
-        closesocket(tcpSocket);
-        closesocket(udpSocket);
-        tcpSocket = INVALID_SOCKET;
-        udpSocket = INVALID_SOCKET;
-        status = ConnectionStatus::CONNECTION_FAILED;
-        statusMessage = "Failed to set TCP socket to non-blocking mode";
-        return false;
+    if (tcpConnectPending) {
+        checkTcpConnectionStatus();
+        return;
     }
     
-    // Set non-blocking mode for UDP socket
-    if (!setSocketNonBlocking(udpSocket)) {
-        closesocket(tcpSocket);
-        closesocket(udpSocket);
-        tcpSocket = INVALID_SOCKET;
-        udpSocket = INVALID_SOCKET;
-        status = ConnectionStatus::CONNECTION_FAILED;
-        statusMessage = "Failed to set UDP socket to non-blocking mode";
-        return false;
+    // The server says nothing before CONNECT, so reading only shows whether it closed
+    char buffer[256];
+    int bytesReceived = transport->receiveStream(buffer, sizeof(buffer));
+    if (bytesReceived > 0) {
+        tcpBuffer.append(buffer, bytesReceived);
+    } else if (bytesReceived != Transport::STREAM_EMPTY) {
+        DEBUG_LOG("Speculative connection closed, reopening");
+        resetLink();
+        nextSpeculativeAttempt = now + SPECULATIVE_RETRY_DELAY;
+    }
+}
+
+// Create the transport for the connect address and start it connecting
+bool NetworkClient::openTransport() {
+    if (!ioBackend) {
+        ioBackend = IoBackend::create();
     }
     
-    // Initiate connection
-    if (::connect(tcpSocket, (struct sockaddr*)&serverTcpAddr, sizeof(serverTcpAddr)) == SOCKET_ERROR) {
-#ifdef _WIN32
-        if (WSAGetLastError() != WSAEWOULDBLOCK) {
-            closesocket(tcpSocket);
-            closesocket(udpSocket);
-            tcpSocket = INVALID_SOCKET;
-            udpSocket = INVALID_SOCKET;
-            status = ConnectionStatus::CONNECTION_FAILED;
-            statusMessage = "Failed to connect to server";
-            return false;
-        }
-#else
-        if (errno != EINPROGRESS) {
-            closesocket(tcpSocket);
-            closesocket(udpSocket);
-            tcpSocket = INVALID_SOCKET;
-            udpSocket = INVALID_SOCKET;
-            status = ConnectionStatus::CONNECTION_FAILED;
-            statusMessage = "Failed to connect to server";
-            return false;
-        }
-#endif
+    transport = Transport::create(connectAddress, connectTcpPort, connectUdpPort, ioBackend);
+    if (simulatedConditions.enabled()) {
+        transport = std::make_unique<SimulatedTransport>(std::move(transport), simulatedConditions);
+    }
+    
+    if (!transport->open()) {
+        statusMessage = transport->getStatusMessage();
+        transport.reset();
+        return false;
     }
     
+    statusMessage = transport->getStatusMessage();
     tcpConnectPending = true;
-    statusMessage = "Waiting for connection...";
     return true;
 }
 
 // Disconnect from server
 void NetworkClient::disconnect() {
-    if (tcpSocket != INVALID_SOCKET) {
-        closesocket(tcpSocket);
-        tcpSocket = INVALID_SOCKET;
+    // A quit, not a dropped connection: the server ends the session now instead of
+    // keeping it for a resume. Best effort, written straight out with what is queued.
+    if (transport && status == ConnectionStatus::CONNECTED && !playerId.empty() &&
+        tcpOutbound.push("LOGOUT")) {
+        transport->flushStream(tcpOutbound);
     }
     
-    if (udpSocket != INVALID_SOCKET) {
-        closesocket(udpSocket);
-        udpSocket = INVALID_SOCKET;
-    }
+    resetLink();
+    messageRouter.closeStreams();
     
     status = ConnectionStatus::DISCONNECTED;
     statusMessage = "Disconnected from server";
-    tcpConnectPending = false;
-    udpRegistered = false;
+    speculative = false;
+    replaying = false;
+    replayHasRecord = false;
     playerId = "";
     playerColor = "";
+    resumeToken.clear();
+    positionSequences.reset();
+    inputHistory.reset();
+    players.clear();
+    stringPool.clear();
     
 #ifdef _WIN32
     WSACleanup();
 #endif
 }
 
-// Set socket to non-blocking mode
-bool NetworkClient::setSocketNonBlocking(socket_t socket) {
-#ifdef _WIN32
-    u_long mode = 1;
-    return (ioctlsocket(socket, FIONBIO, &mode) == 0);
-#else
-    int flags = fcntl(socket, F_GETFL, 0);
-    return (fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1);
-#endif
+// Close the transport and forget everything tied to this one connection. The session's
+// players, ids and unacknowledged inputs are kept.
+void NetworkClient::resetLink() {
+    if (transport) {
+        transport->disconnect();
+        transport.reset();
+    }
+    
+    // Replies to anything asked on this connection will not come
+    messageRouter.failWaits();
+    
+    tcpOutbound.clear();
+    tcpBuffer.clear();
+    inboundBacklog.clear();
+    tcpConnectPending = false;
+    resumePending = false;
+    udpRegistered = false;
+    congestion.reset();
+    latencyStats.resetInFlight();
+    reliableChannel.reset();
+    outboundScheduler.reset();
+    udpFramer.reset();
+    udpReassembler.reset();
+}
+
+// The connection dropped: keep the world and resume the session if the server gave us
+// a token, otherwise disconnect for good
+void NetworkClient::connectionLost(const std::string& reason) {
+    if (resumeToken.empty() || playerId.empty()) {
+        disconnect();
+        statusMessage = reason;
+        return;
+    }
+    
+    // Losing a connection that was still resuming counts as a failed attempt
+    bool attemptFailed = resumePending || status == ConnectionStatus::RECONNECTING;
+    resetLink();
+    status = ConnectionStatus::RECONNECTING;
+    
+    if (attemptFailed) {
+        scheduleReconnect();
+        return;
+    }
+    
+    DEBUG_LOG(reason << ", resuming session " << playerId);
+    statusMessage = reason + ", reconnecting...";
+    reconnectAttempt = 0;
+    nextReconnectTime = std::chrono::steady_clock::now();
+    reconnectDeadline = nextReconnectTime + RECONNECT_WINDOW;
+}
+
+// Start the next reconnect attempt once its backoff has passed, or give up when the
+// server will have dropped the session
+void NetworkClient::updateReconnect() {
+    if (tcpConnectPending) {
+        return;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    if (now >= reconnectDeadline) {
+        DEBUG_LOG("Could not resume session " << playerId << " after " << reconnectAttempt << " attempts");
+        disconnect();
+        statusMessage = "Connection to server lost";
+        return;
+    }
+    
+    if (now < nextReconnectTime) {
+        return;
+    }
+    
+    reconnectAttempt++;
+    DEBUG_LOG("Reconnect attempt " << reconnectAttempt);
+    if (!openTransport()) {
+        scheduleReconnect();
+    }
+}
+
+// Wait before the next attempt, doubling the delay each time
+void NetworkClient::scheduleReconnect() {
+    transport.reset();
+    tcpConnectPending = false;
+    
+    auto delay = std::min(RECONNECT_MAX_DELAY, RECONNECT_INITIAL_DELAY * (1 << std::clamp(reconnectAttempt - 1, 0, 8)));
+    nextReconnectTime = std::chrono::steady_clock::now() + delay;
+    statusMessage = "Connection lost, reconnecting (attempt " + std::to_string(reconnectAttempt + 1) + ")...";
 }
 
-// Check TCP connection status
+// Ask for the session this client had before the connection dropped
+void NetworkClient::sendResume() {
+    nlohmann::json request = {
+        {"id", playerId},
+        {"token", resumeToken}
+    };
+    
+    DEBUG_LOG("Resuming session " << playerId);
+    resumePending = true;
+    sendTcpMessage("RESUME " + request.dump());
+}
+
+// Poll a connection in progress, returns false until it has connected
 bool NetworkClient::checkTcpConnectionStatus() {
     if (!tcpConnectPending) {
         return true;
     }
     
-    std::cout << "Checking TCP connection status..." << std::endl;
-    
-    // Check if connection completed
-    fd_set writefds;
-    fd_set errorfds;
-    struct timeval tv;
+    Transport::State state = transport->poll();
+    statusMessage = transport->getStatusMessage();
     
-    FD_ZERO(&writefds);
-    FD_ZERO(&errorfds);
-    FD_SET(tcpSocket, &writefds);
-    FD_SET(tcpSocket, &errorfds);
-    
-    tv.tv_sec = 0;
-    tv.tv_usec = 0;
+    if (state == Transport::State::CONNECTING) {
+        return true;
+    }
     
-    int ret = select(tcpSocket + 1, NULL, &writefds, &errorfds, &tv);
+    tcpConnectPending = false;
     
-    if (ret > 0) {
-        if (FD_ISSET(tcpSocket, &errorfds)) {
-            // Connection failed
-            tcpConnectPending = false;
-            status = ConnectionStatus::CONNECTION_FAILED;
-            statusMessage = "Connection to server failed";
-            std::cout << "Connection failed: socket error set" << std::endl;
+    if (state == Transport::State::FAILED) {
+        if (status == ConnectionStatus::RECONNECTING) {
+            scheduleReconnect();
             return false;
         }
-        
-        if (FD_ISSET(tcpSocket, &writefds)) {
-            // Connection succeeded
-            tcpConnectPending = false;
-            status = ConnectionStatus::CONNECTED;
-            statusMessage = "Connected to server";
-            lastMessageTime = std::chrono::steady_clock::now();
-            lastPingTime = std::chrono::steady_clock::now();
-            std::cout << "Connection established successfully" << std::endl;
-            return true;
+        transport.reset();
+        if (speculative) {
+            nextSpeculativeAttempt = std::chrono::steady_clock::now() + SPECULATIVE_RETRY_DELAY;
+            return false;
         }
+        status = ConnectionStatus::CONNECTION_FAILED;
+        messageRouter.failWaits();
+        return false;
     }
     
-    // Check for connection timeout
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - connectStartTime).count();
-    
-    if (elapsed > 10) {
-        tcpConnectPending = false;
-        status = ConnectionStatus::CONNECTION_FAILED;
-        statusMessage = "Connection to server timed out";
-        std::cout << "Connection timed out after " << elapsed << " seconds" << std::endl;
+    // Held open until connect() adopts it
+    if (speculative) {
+        DEBUG_LOG("Connected to " << transport->describePeer() << " ahead of login");
         return false;
     }
     
-    std::cout << "Connection still pending after " << elapsed << " seconds" << std::endl;
+    bool resuming = status == ConnectionStatus::RECONNECTING;
+    status = ConnectionStatus::CONNECTED;
+    lastMessageTime = std::chrono::steady_clock::now();
+    lastPingTime = std::chrono::steady_clock::now();
+    std::cout << "Connection established successfully to " << transport->describePeer() << std::endl;
+    
+    if (resuming) {
+        sendResume();
+    }
     return true;
 }
 
+// Send the CONNECT the game asked for before the connection was up
+void NetworkClient::sendPendingConnect() {
+    if (pendingConnectName.empty() || resumePending) {
+        return;
+    }
+    
+    std::string name = pendingConnectName;
+    pendingConnectName = ""; // Clear it to avoid sending multiple times
+    sessionName = name;
+    
+    // Create connect message with the pending name using JSON
+    nlohmann::json request = {
+        {"name", name},
+        {"color", playerColor.empty() ? "#FF0000" : playerColor}
+    };
+    
+    std::string requestStr = request.dump();
+    DEBUG_LOG("Connection established, sending delayed connect request: CONNECT " << requestStr);
+    sendTcpMessage("CONNECT " + requestStr);
+}
+
 // Update network state
 void NetworkClient::update() {
+    // Everything decoded this frame is allocated from the arena and released on return
+    FrameArena::FrameScope frameScope(frameArena);
+    events.clear();
+    compactStringPool();
+    
+    // Flows whose replies or timeouts came in since the last frame continue first
+    executor.run(std::chrono::steady_clock::now());
+    
+    // Captured traffic replaces the sockets entirely while replaying
+    if (replaying) {
+        updateReplay();
+        return;
+    }
+    
+    // Collect everything the sockets received since the last frame in one go
+    if (ioBackend && drivesIoBackend) {
+        ioBackend->poll();
+    }
+    
+    // A connection opened ahead of login waits here until connect() adopts it
+    if (speculative) {
+        updateSpeculative();
+    }
+    
+    if (status == ConnectionStatus::RECONNECTING) {
+        updateReconnect();
+    }
+    
     // Check connection status
-    if (tcpConnectPending) {
+    if (tcpConnectPending && !speculative) {
         if (!checkTcpConnectionStatus()) {
             return;
         }
         
         // If we just connected and have a pending connect name, send the connect request immediately
-        if (status == ConnectionStatus::CONNECTED && !pendingConnectName.empty()) {
-            std::string name = pendingConnectName;
-            pendingConnectName = ""; // Clear it to avoid sending multiple times
-            
-            // Create connect message with the pending name using JSON
-            nlohmann::json request = {
-                {"name", name},
-                {"color", playerColor.empty() ? "#FF0000" : playerColor}
-            };
-            
-            std::string requestStr = request.dump();
-            DEBUG_LOG("Connection established, sending delayed connect request: CONNECT " << requestStr);
-            sendTcpMessage("CONNECT " + requestStr);
+        if (status == ConnectionStatus::CONNECTED) {
+            sendPendingConnect();
         }
     }
     
     // Process messages if connected
     if (status == ConnectionStatus::CONNECTED) {
+        // Messages the game queued since the last update go out first
+        flushUdpMessages();
+        
         checkTcpMessages();
         checkUdpMessages();
+        processBacklog(true);
+        
+        // The view rides the reliable channel, so it waits for UDP registration
+        if (viewDirty && udpRegistered) {
+            sendViewRect();
+        }
+        
+        flushReliableChannel();
+        flushUdpMessages();
         
         // Check for connection timeout
         auto now = std::chrono::steady_clock::now();
@@ -296,267 +481,444 @@ void NetworkClient::update() {
         
         if (elapsed > connectionTimeout) {
             DEBUG_LOG("Connection timed out after " << elapsed << " seconds");
-            disconnect();
-            status = ConnectionStatus::DISCONNECTED;
-            statusMessage = "Connection to server timed out";
+            connectionLost("Connection to server timed out");
             return;
         }
         
+        congestion.update(now);
+        
         // Send ping if needed
         auto pingElapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastPingTime).count();
         
         if (pingElapsed > pingInterval) {
-            sendTcpMessage("PING");
+            // Pings ride their own UDP stream so a lost segment can't delay them behind snapshots
+            if (udpRegistered) {
+                reliableChannel.send("PING", ReliableStream::PING);
+            } else {
+                sendTcpMessage("PING");
+            }
             lastPingTime = now;
         }
+        
+        flushTcpMessages();
+        
+        // The frame's datagrams leave together
+        if (drivesIoBackend) {
+            ioBackend->submit();
+        }
     }
+    
+    latencyStats.update(std::chrono::steady_clock::now());
+    captureWriter.endFrame();
 }
 
-// Send TCP message
-bool NetworkClient::sendTcpMessage(const std::string& message) {
-    if (tcpSocket == INVALID_SOCKET || status != ConnectionStatus::CONNECTED) {
-        return false;
+// Send what the game queued after update()
+void NetworkClient::flush() {
+    if (replaying || status != ConnectionStatus::CONNECTED || !transport) {
+        return;
     }
     
-    // End message with newline
-    std::string fullMessage = message + "\n";
+    flushUdpMessages();
+    flushTcpMessages();
     
-    // Send message
-    int result = send(tcpSocket, fullMessage.c_str(), static_cast<int>(fullMessage.length()), 0);
+    if (ioBackend && drivesIoBackend) {
+        ioBackend->submit();
+    }
+}
+
+// Connect, then wait for the login and the UDP registration to be confirmed
+Task<bool> NetworkClient::connectAsync(std::string serverAddress, int tcpPort, int udpPort,
+                                       std::string name, std::string color,
+                                       std::chrono::milliseconds timeout) {
+    pendingConnectName = std::move(name);
+    playerColor = std::move(color);
+    if (!connect(serverAddress, tcpPort, udpPort)) {
+        co_return false;
+    }
     
-    if (result == SOCKET_ERROR) {
-        DEBUG_LOG("Failed to send TCP message: " << message);
+    // Both are registered before either can arrive; connect() has already reset the link
+    NetWaitAwaiter config = messageRouter.receive("CONFIG", timeout);
+    NetWaitAwaiter registered = messageRouter.receive("UDP_REGISTERED", timeout);
+    
+    if (!co_await config) {
+        DEBUG_LOG("No CONFIG from " << serverAddress << " within " << timeout.count() << " ms");
+        co_return false;
+    }
+    if (!co_await registered) {
+        DEBUG_LOG("UDP registration with " << serverAddress << " was not confirmed in time");
+        co_return false;
+    }
+    co_return true;
+}
+
+// Send first: no reply can arrive before the wait is registered on this same thread
+Task<std::optional<std::string>> NetworkClient::request(std::string message, std::string replyCommand,
+                                                        std::chrono::milliseconds timeout) {
+    if (!sendTcpMessage(message)) {
+        co_return std::nullopt;
+    }
+    co_return co_await messageRouter.receive(std::move(replyCommand), timeout);
+}
+
+// Log input-to-echo latency percentiles to a CSV file
+bool NetworkClient::startLatencyLog(const std::string& path) {
+    return latencyStats.startLog(path);
+}
+
+// Start recording inbound traffic to a capture file
+bool NetworkClient::startRecording(const std::string& path) {
+    return captureWriter.open(path);
+}
+
+// Stop recording inbound traffic
+void NetworkClient::stopRecording() {
+    captureWriter.close();
+}
+
+// Start feeding a capture file through the message handlers instead of the sockets
+bool NetworkClient::startReplay(const std::string& path, ReplaySpeed speed) {
+    if (status == ConnectionStatus::CONNECTED || status == ConnectionStatus::CONNECTING) {
+        return false;
+    }
+    
+    replayReader = CaptureReader();
+    if (!replayReader.open(path)) {
+        status = ConnectionStatus::CONNECTION_FAILED;
+        statusMessage = "Failed to open capture " + path;
         return false;
     }
     
-    DEBUG_LOG("Sent TCP: " << message);
+    replayHasRecord = replayReader.next(replayRecord);
+    replaySpeed = speed;
+    replayStartTime = std::chrono::steady_clock::now();
+    replaying = true;
+    
+    status = ConnectionStatus::CONNECTED;
+    statusMessage = "Replaying " + path;
+    lastMessageTime = replayStartTime;
+    DEBUG_LOG("Replaying capture " << path
+              << (speed == ReplaySpeed::REALTIME ? " at original speed" : " as fast as possible"));
     return true;
 }
 
-// Send UDP message
-bool NetworkClient::sendUdpMessage(const std::string& message) {
-    if (udpSocket == INVALID_SOCKET || status != ConnectionStatus::CONNECTED) {
+// Feed the records that are due this frame
+void NetworkClient::updateReplay() {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - replayStartTime).count();
+    
+    while (replayHasRecord) {
+        if (replaySpeed == ReplaySpeed::REALTIME && replayRecord.timestampUs > elapsedUs) {
+            break;
+        }
+        
+        CaptureChannel channel = replayRecord.channel;
+        if (channel == CaptureChannel::TCP) {
+            lastMessageTime = now;
+            inboundBacklog.push(replayRecord.data);
+        } else if (channel == CaptureChannel::UDP) {
+            lastMessageTime = now;
+            handleUdpDatagram(replayRecord.data);
+        }
+        
+        replayHasRecord = replayReader.next(replayRecord);
+        
+        // Fast replay reproduces the recorded frame boundaries one per update()
+        if (channel == CaptureChannel::FRAME && replaySpeed == ReplaySpeed::AS_FAST_AS_POSSIBLE) {
+            break;
+        }
+    }
+    
+    // Replayed traffic is handled under the same budget as live traffic
+    processBacklog(true);
+    
+    if (!replayHasRecord && inboundBacklog.empty()) {
+        DEBUG_LOG("Replay finished");
+        replaying = false;
+        status = ConnectionStatus::DISCONNECTED;
+        statusMessage = "Replay finished";
+    }
+}
+
+// Queue a TCP message; the whole frame's messages go out together in flushTcpMessages()
+bool NetworkClient::sendTcpMessage(const std::string& message) {
+    if (!transport || status != ConnectionStatus::CONNECTED) {
         return false;
     }
     
-    // Send message
-    int result = sendto(udpSocket, message.c_str(), static_cast<int>(message.length()), 0,
-                       (struct sockaddr*)&serverUdpAddr, sizeof(serverUdpAddr));
+    if (!tcpOutbound.push(message)) {
+        DEBUG_LOG("Failed to queue TCP message: " << message);
+        return false;
+    }
+    return true;
+}
+
+// Write queued TCP messages, resuming any partial write from the previous frame
+void NetworkClient::flushTcpMessages() {
+    if (!transport || status != ConnectionStatus::CONNECTED) {
+        return;
+    }
     
-    if (result == SOCKET_ERROR) {
-        DEBUG_LOG("Failed to send UDP message: " << message);
+    if (transport->flushStream(tcpOutbound) == TcpOutboundQueue::FlushResult::FAILED) {
+        DEBUG_LOG("Failed to send queued TCP messages");
+        connectionLost("Connection to server lost");
+    }
+}
+
+// Send UDP message
+bool NetworkClient::sendUdpMessage(const std::string& message, TrafficClass trafficClass, std::string key) {
+    if (!transport || status != ConnectionStatus::CONNECTED) {
         return false;
     }
     
+    // Sent on the next flush the budget allows, packed with whatever else goes then
+    outboundScheduler.enqueue(trafficClass, message, std::move(key));
     return true;
 }
 
-// Check for TCP messages
+// Send the queued UDP messages the budget allows, aggregated and fragmented to the
+// datagram size
+void NetworkClient::flushUdpMessages() {
+    std::vector<std::string> scheduled;
+    outboundScheduler.schedule(std::chrono::steady_clock::now(), scheduled);
+    bool inputScheduled = false;
+    for (auto& message : scheduled) {
+        inputScheduled = inputScheduled || message.compare(0, 6, "INPUT ") == 0;
+        udpFramer.enqueue(std::move(message));
+    }
+    
+    if (udpFramer.empty() || !transport) {
+        return;
+    }
+    
+    std::vector<std::string> datagrams;
+    udpFramer.flush(datagrams);
+    
+    for (const auto& datagram : datagrams) {
+        if (!transport->sendDatagram(datagram)) {
+            DEBUG_LOG("Failed to send UDP datagram of " << datagram.size() << " bytes");
+        }
+    }
+    
+    if (inputScheduled) {
+        auto now = std::chrono::steady_clock::now();
+        congestion.onSent(queuedInputTick, now);
+        latencyStats.onInputSent(now);
+    }
+}
+
+// Read what the stream has and queue its complete messages
 void NetworkClient::checkTcpMessages() {
-    if (tcpSocket == INVALID_SOCKET) {
+    if (!transport) {
         return;
     }
     
-    // Receive data
-    char buffer[1024];
-    int bytesReceived = recv(tcpSocket, buffer, sizeof(buffer) - 1, 0);
+    // Reading is cheap next to handling, so take everything up to the cap now and let
+    // the backlog drop stale snapshots before any of them is decoded
+    receiveBuffer.resize(UDP_MAX_DATAGRAM);
+    size_t totalReceived = 0;
+    int bytesReceived = Transport::STREAM_EMPTY;
+    while (totalReceived < MAX_STREAM_BYTES_PER_UPDATE) {
+        bytesReceived = transport->receiveStream(receiveBuffer.data(), receiveBuffer.size());
+        if (bytesReceived <= 0) {
+            break;
+        }
+        totalReceived += bytesReceived;
+        tcpBuffer.append(receiveBuffer.data(), bytesReceived);
+    }
     
-    if (bytesReceived > 0) {
+    if (totalReceived > 0) {
         // Update last message time
         lastMessageTime = std::chrono::steady_clock::now();
+    }
+    
+    // Queue complete messages, then drop them from the buffer in one go
+    size_t start = 0;
+    size_t pos;
+    while ((pos = tcpBuffer.find('\n', start)) != std::string::npos) {
+        std::string_view message(tcpBuffer.data() + start, pos - start);
+        start = pos + 1;
         
-        // Process received data
-        buffer[bytesReceived] = '\0';
-        
-        // Add to buffer
-        tcpBuffer += buffer;
-        
-        // Process complete messages
-        size_t pos;
-        while ((pos = tcpBuffer.find('\n')) != std::string::npos) {
-            std::string message = tcpBuffer.substr(0, pos);
-            tcpBuffer.erase(0, pos + 1);
-            
-            // Process message
-            if (!message.empty()) {
-                processServerMessage(message);
-            }
+        if (!message.empty()) {
+            captureWriter.write(CaptureChannel::TCP, message.data(), message.size());
+            inboundBacklog.push(message);
         }
     }
-    else if (bytesReceived == 0) {
-        // Connection closed by server
+    tcpBuffer.erase(0, start);
+    
+    if (bytesReceived == Transport::STREAM_CLOSED) {
+        // Connection closed by server; its last words, e.g. an ERROR, are handled first
         DEBUG_LOG("Server closed the connection");
-        disconnect();
-        status = ConnectionStatus::DISCONNECTED;
-        statusMessage = "Server closed the connection";
+        processBacklog(false);
+        connectionLost("Server closed the connection");
     }
-    else {
-        // Check for socket errors
-#ifdef _WIN32
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-            DEBUG_LOG("TCP receive error: " << error);
-            disconnect();
-            status = ConnectionStatus::DISCONNECTED;
-            statusMessage = "Connection to server lost";
-        }
-#else
-        if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            DEBUG_LOG("TCP receive error: " << errno);
-            disconnect();
-            status = ConnectionStatus::DISCONNECTED;
-            statusMessage = "Connection to server lost";
-        }
-#endif
+    else if (bytesReceived == Transport::STREAM_FAILED) {
+        connectionLost("Connection to server lost");
     }
 }
 
 // Check for UDP messages
 void NetworkClient::checkUdpMessages() {
-    if (udpSocket == INVALID_SOCKET) {
+    if (!transport) {
         return;
     }
     
-    // Receive data
-    char buffer[1024];
-    struct sockaddr_in senderAddr;
-    socklen_t addrLen = sizeof(senderAddr);
-    
-    int bytesReceived = recvfrom(udpSocket, buffer, sizeof(buffer) - 1, 0,
-                                (struct sockaddr*)&senderAddr, &addrLen);
-    
-    if (bytesReceived > 0) {
+    // Drain every datagram that arrived since the last frame. The buffer holds the
+    // largest possible datagram, so nothing is truncated.
+    receiveBuffer.resize(UDP_MAX_DATAGRAM);
+    while (transport) {
+        int bytesReceived = transport->receiveDatagram(receiveBuffer.data(), receiveBuffer.size());
+        
+        if (bytesReceived <= 0) {
+            break;
+        }
+        
         // Update last message time
         lastMessageTime = std::chrono::steady_clock::now();
         
-        // Process received data
-        buffer[bytesReceived] = '\0';
-        std::string message(buffer);
+        captureWriter.write(CaptureChannel::UDP, receiveBuffer.data(), bytesReceived);
+        handleUdpDatagram(std::string_view(receiveBuffer.data(), bytesReceived));
+    }
+}
+
+// Route a datagram through the reliable channel or straight to the backlog. Reliable
+// messages are acknowledged on arrival, however long they then wait to be handled.
+void NetworkClient::handleUdpDatagram(std::string_view datagram) {
+    auto now = std::chrono::steady_clock::now();
+    
+    // Unpack aggregated messages and reassemble fragmented ones first. Both layers hand
+    // out views into the datagram or their own buffers, copied once into the backlog.
+    datagramMessages.clear();
+    udpReassembler.receive(datagram, datagramMessages, now);
+    
+    for (std::string_view message : datagramMessages) {
+        if (ReliableChannel::isChannelPacket(message)) {
+            reliableMessages.clear();
+            reliableChannel.receive(message, reliableMessages, now);
+            for (std::string_view reliableMessage : reliableMessages) {
+                inboundBacklog.push(reliableMessage);
+            }
+            continue;
+        }
+        
+        inboundBacklog.push(message);
+    }
+}
+
+// Handle queued messages oldest first until the processing budget runs out, or all of
+// them when not budgeted. The budget is checked after each message, so every update
+// makes progress however small it is.
+void NetworkClient::processBacklog(bool budgeted) {
+    auto start = std::chrono::steady_clock::now();
+    size_t handled = 0;
+    
+    while (inboundBacklog.pop(backlogMessage)) {
+        processServerMessage(backlogMessage);
+        handled++;
+        
+        if (!budgeted) {
+            continue;
+        }
+        if (processingBudget.messages > 0 && handled >= processingBudget.messages) {
+            break;
+        }
+        if (processingBudget.time.count() > 0 &&
+            std::chrono::steady_clock::now() - start >= processingBudget.time) {
+            break;
+        }
+    }
+    
+    if (!inboundBacklog.empty()) {
+        deferredUpdates++;
+    }
+}
+
+// Send reliable channel packets that are due and report undeliverable messages
+void NetworkClient::flushReliableChannel() {
+    reliableOutgoing.clear();
+    reliableChannel.update(std::chrono::steady_clock::now(), reliableOutgoing);
+    
+    for (const auto& packet : reliableOutgoing) {
+        // A retransmit replaces its own copy if the first is still waiting for budget
+        ReliableStream stream;
+        std::string_view sequence;
+        if (!ReliableChannel::parsePacketHeader(packet, stream, sequence)) {
+            sendUdpMessage(packet, TrafficClass::CONTROL, "ack");
+            continue;
+        }
         
-        // Process message if from server
-        if (senderAddr.sin_addr.s_addr == serverUdpAddr.sin_addr.s_addr && 
-            senderAddr.sin_port == serverUdpAddr.sin_port) {
-            processServerMessage(message);
+        TrafficClass trafficClass = stream == ReliableStream::CHAT ? TrafficClass::CHAT
+                                  : stream == ReliableStream::MAP ? TrafficClass::BULK
+                                  : TrafficClass::CONTROL;
+        reliableKey.assign("rel ").append(sequence);
+        sendUdpMessage(packet, trafficClass, reliableKey);
+    }
+    
+    for (const auto& message : reliableChannel.takeFailed()) {
+        DEBUG_LOG("Reliable message was never acknowledged: " << message);
+        if (message.compare(0, 12, "UDP_REGISTER") == 0) {
+            statusMessage = "UDP registration failed, using TCP for updates";
+        } else {
+            statusMessage = "Failed to deliver message to server";
         }
     }
 }
 
 // Process message from server
-void NetworkClient::processServerMessage(const std::string& message) {
-    DEBUG_LOG("Received: " << message);
-    
+void NetworkClient::processServerMessage(std::string_view message) {
     // Check if the message starts with a command prefix
     size_t spacePos = message.find_first_of(' ');
-    if (spacePos != std::string::npos) {
-        std::string command = message.substr(0, spacePos);
-        std::string payload = message.substr(spacePos + 1);
+    if (spacePos != std::string_view::npos) {
+        std::string_view command = message.substr(0, spacePos);
+        std::string_view payload = message.substr(spacePos + 1);
         
-        DEBUG_LOG("Processing command: " << command << " with payload: " << payload);
+        // Flows waiting on this command see it too, once the executor runs them
+        messageRouter.deliver(command, payload);
         
         try {
-            // Parse payload as JSON
-            nlohmann::json data = nlohmann::json::parse(payload);
+            // Parse payload as JSON into the frame arena
+            FrameJson data = FrameJson::parse(payload.begin(), payload.end());
             
             if (command == "CONFIG") {
                 // Configuration message
                 if (data.contains("id") && data.contains("color")) {
-                    playerId = data["id"];
-                    playerColor = data["color"];
+                    playerId = stringView(data["id"]);
+                    playerColor = stringView(data["color"]);
                     DEBUG_LOG("Received CONFIG message. Player ID: " << playerId << ", Color: " << playerColor);
                     
+                    // Lets the session survive a dropped connection
+                    if (data.contains("resume")) {
+                        resumeToken = stringView(data["resume"]);
+                    }
+                    
                     // Register UDP address
                     DEBUG_LOG("Sending UDP registration");
                     sendUdpRegistration();
-                    
-                    // Send a position update to get a position assigned
-                    DEBUG_LOG("Sending initial position request");
-                    sendPositionUpdate(0, 0); // Use 0,0 to let server assign position
                 }
             } 
             else if (command == "PLAYERS") {
                 // Player list update
                 if (data.is_array()) {
-                    std::vector<PlayerInfo> newPlayers;
-                    
                     DEBUG_LOG("Processing PLAYERS update with " << data.size() << " players");
-                    
-                    for (const auto& player : data) {
-                        if (player.contains("id") && player.contains("name") && player.contains("color")) {
-                            PlayerInfo info;
-                            info.id = player["id"];
-                            info.name = player["name"];
-                            info.color = player["color"];
-                            
-                            if (player.contains("x") && player.contains("y")) {
-                                info.x = player["x"];
-                                info.y = player["y"];
-                                DEBUG_LOG("Player " << info.name << " (" << info.id << ") at position (" 
-                                         << info.x << "," << info.y << ")");
-                            }
-                            
-                            if (player.contains("mapId")) {
-                                info.mapId = player["mapId"];
-                            } else {
-                                info.mapId = "default";
-                            }
-                            
-                            newPlayers.push_back(info);
-                        }
-                    }
-                    
-                    players = newPlayers;
-                    
-                    // Call the registered callback if available
-                    if (playerListCallback) {
-                        DEBUG_LOG("Calling player list callback with " << players.size() << " players");
-                        playerListCallback(players);
-                    }
-                    
-                    // Check all players and call position callback if we have some with positions
-                    for (const auto& player : players) {
-                        if (positionCallback) {
-                            DEBUG_LOG("Calling position callback for player " << player.id);
-                            positionCallback(player.id, player.x, player.y);
-                        }
-                    }
-                    
-                    DEBUG_LOG("Updated player list: " << players.size() << " players");
+                    decodePlayerList(data, true);
                 }
             } 
-            else if (command == "POSITION") {
-                // Position update
-                if (data.contains("id") && data.contains("x") && data.contains("y")) {
-                    std::string id = data["id"];
-                    float x = data["x"];
-                    float y = data["y"];
-                    
-                    DEBUG_LOG("Position update for player " << id << ": (" << x << ", " << y << ")");
-                    
-                    // Update player position in the list
-                    for (auto& player : players) {
-                        if (player.id == id) {
-                            player.x = x;
-                            player.y = y;
-                            break;
-                        }
-                    }
-                    
-                    // Call the position callback if available
-                    if (positionCallback) {
-                        DEBUG_LOG("Calling position callback for " << id);
-                        positionCallback(id, x, y);
-                    }
-                }
+            else if (command == "POSITION" || command == "UPDATE" || command == "POS_UPDATE") {
+                handlePositionUpdate(data);
+            }
+            else if (command == "ENTER") {
+                handlePlayerEnter(data);
+            }
+            else if (command == "LEAVE") {
+                handlePlayerLeave(data);
+            }
+            else if (command == "CHUNK") {
+                handleChunk(data);
+            }
+            else if (command == "INPUT_ACK") {
+                handleInputAck(data);
             }
             else if (command == "CHAT") {
-                // Chat message
-                if (data.contains("sender") && data.contains("message")) {
-                    std::string sender = data["sender"];
-                    std::string chatMsg = data["message"];
-                    std::string fullMessage = sender + ": " + chatMsg;
-                    chatMessages.push_back(fullMessage);
-                    DEBUG_LOG("Chat message: " << fullMessage);
-                }
+                handleChatMessage(data);
             }
             else if (command == "PONG") {
                 // Pong response, no action needed
@@ -565,62 +927,49 @@ void NetworkClient::processServerMessage(const std::string& message) {
             else if (command == "ERROR") {
                 // Error message
                 if (data.contains("message")) {
-                    std::string errorMsg = data["message"];
+                    std::string_view errorMsg = stringView(data["message"]);
                     DEBUG_LOG("Server error: " << errorMsg);
-                    statusMessage = "Server error: " + errorMsg;
+                    statusMessage = "Server error: ";
+                    statusMessage += errorMsg;
                 }
             }
             else if (command == "UDP_REGISTERED") {
                 // UDP registration confirmation
                 DEBUG_LOG("UDP registration confirmed by server");
                 udpRegistered = true;
+                
+                // A fresh registration may be a fresh session, so declare the view again
+                viewDirty = viewWidth > 0.0f && viewHeight > 0.0f;
+            }
+            else if (command == "RESUMED") {
+                // Same session, same world; UDP and the view register again on this connection
+                DEBUG_LOG("Session " << playerId << " resumed after " << reconnectAttempt << " attempts");
+                resumePending = false;
+                reconnectAttempt = 0;
+                statusMessage = "Reconnected to server";
+                sendUdpRegistration();
+            }
+            else if (command == "RESUME_FAILED") {
+                // The server no longer has the session, so join again as a new player
+                if (data.contains("reason")) {
+                    DEBUG_LOG("Resume failed: " << stringView(data["reason"]));
+                }
+                resumePending = false;
+                resumeToken.clear();
+                playerId.clear();
+                positionSequences.reset();
+                inputHistory.reset();
+                players.clear();
+                events.clear();
+                events.playersChanged = true;
+                stringPool.clear();
+                sendConnectRequest(sessionName, playerColor.empty() ? "#FF0000" : playerColor);
             }
             else if (command == "GAME_STATE") {
                 // Full game state update - similar to PLAYERS but might have additional fields
                 DEBUG_LOG("Received GAME_STATE update");
                 if (data.contains("players") && data["players"].is_array()) {
-                    std::vector<PlayerInfo> newPlayers;
-                    
-                    for (const auto& player : data["players"]) {
-                        if (player.contains("id") && player.contains("name")) {
-                            PlayerInfo info;
-                            info.id = player["id"];
-                            info.name = player["name"];
-                            
-                            if (player.contains("color")) {
-                                info.color = player["color"];
-                            } else {
-                                info.color = "#FF0000"; // Default red
-                            }
-                            
-                            if (player.contains("x") && player.contains("y")) {
-                                info.x = player["x"];
-                                info.y = player["y"];
-                            }
-                            
-                            if (player.contains("mapId")) {
-                                info.mapId = player["mapId"];
-                            } else {
-                                info.mapId = "default";
-                            }
-                            
-                            newPlayers.push_back(info);
-                        }
-                    }
-                    
-                    players = newPlayers;
-                    
-                    // Call the registered callback if available
-                    if (playerListCallback) {
-                        playerListCallback(players);
-                    }
-                    
-                    // Call position callback for each player to ensure UI is updated
-                    for (const auto& player : players) {
-                        if (positionCallback) {
-                            positionCallback(player.id, player.x, player.y);
-                        }
-                    }
+                    decodePlayerList(data["players"], false);
                 }
             }
             return; // Successfully processed command with JSON payload
@@ -638,112 +987,36 @@ void NetworkClient::processServerMessage(const std::string& message) {
     // If we get here, try to process as legacy format without command prefix
     try {
         // Parse message as JSON
-        nlohmann::json data = nlohmann::json::parse(message);
+        FrameJson data = FrameJson::parse(message.begin(), message.end());
         
         // Process different message types
         if (data.contains("type")) {
-            std::string type = data["type"];
+            std::string_view type = stringView(data["type"]);
             
             if (type == "CONFIG") {
                 // Configuration message
                 if (data.contains("id") && data.contains("color")) {
-                    playerId = data["id"];
-                    playerColor = data["color"];
+                    playerId = stringView(data["id"]);
+                    playerColor = stringView(data["color"]);
                     DEBUG_LOG("Received CONFIG message (JSON). Player ID: " << playerId << ", Color: " << playerColor);
                     
                     // Register UDP address
                     DEBUG_LOG("Sending UDP_REGISTER");
                     sendUdpRegistration();
-                    
-                    // Send a position update to get a position assigned
-                    DEBUG_LOG("Sending initial position request");
-                    sendPositionUpdate(0, 0); // Use 0,0 to let server assign position
                 }
             } 
             else if (type == "CHAT") {
-                // Chat message
-                if (data.contains("sender") && data.contains("message")) {
-                    std::string sender = data["sender"];
-                    std::string chatMsg = data["message"];
-                    std::string fullMessage = sender + ": " + chatMsg;
-                    chatMessages.push_back(fullMessage);
-                    DEBUG_LOG("Chat message: " << fullMessage);
-                }
+                handleChatMessage(data);
             } 
             else if (type == "PLAYERS") {
                 // Player list update
                 if (data.contains("players") && data["players"].is_array()) {
-                    std::vector<PlayerInfo> newPlayers;
-                    
                     DEBUG_LOG("Processing PLAYERS update with " << data["players"].size() << " players");
-                    
-                    for (const auto& player : data["players"]) {
-                        if (player.contains("id") && player.contains("name") && player.contains("color")) {
-                            PlayerInfo info;
-                            info.id = player["id"];
-                            info.name = player["name"];
-                            info.color = player["color"];
-                            
-                            if (player.contains("x") && player.contains("y")) {
-                                info.x = player["x"];
-                                info.y = player["y"];
-                                DEBUG_LOG("Player " << info.name << " (" << info.id << ") at position (" 
-                                         << info.x << "," << info.y << ")");
-                            }
-                            
-                            if (player.contains("mapId")) {
-                                info.mapId = player["mapId"];
-                            } else {
-                                info.mapId = "default";
-                            }
-                            
-                            newPlayers.push_back(info);
-                        }
-                    }
-                    
-                    players = newPlayers;
-                    
-                    // Call the registered callback if available
-                    if (playerListCallback) {
-                        DEBUG_LOG("Calling player list callback with " << players.size() << " players");
-                        playerListCallback(players);
-                    }
-                    
-                    // Check all players and call position callback if we have some with positions
-                    for (const auto& player : players) {
-                        if (positionCallback) {
-                            DEBUG_LOG("Calling position callback for player " << player.id);
-                            positionCallback(player.id, player.x, player.y);
-                        }
-                    }
-                    
-                    DEBUG_LOG("Updated player list: " << players.size() << " players");
+                    decodePlayerList(data["players"], true);
                 }
             } 
             else if (type == "POSITION") {
-                // Position update
-                if (data.contains("id") && data.contains("x") && data.contains("y")) {
-                    std::string id = data["id"];
-                    float x = data["x"];
-                    float y = data["y"];
-                    
-                    DEBUG_LOG("Position update for player " << id << ": (" << x << ", " << y << ")");
-                    
-                    // Update player position in the list
-                    for (auto& player : players) {
-                        if (player.id == id) {
-                            player.x = x;
-                            player.y = y;
-                            break;
-                        }
-                    }
-                    
-                    // Call the position callback if available
-                    if (positionCallback) {
-                        DEBUG_LOG("Calling position callback for " << id);
-                        positionCallback(id, x, y);
-                    }
-                }
+                handlePositionUpdate(data);
             }
             else if (type == "PONG") {
                 // Pong response, no action needed
@@ -753,7 +1026,7 @@ void NetworkClient::processServerMessage(const std::string& message) {
     } catch (const std::exception& e) {
         // Legacy string-based message parsing for backward compatibility
         if (message.substr(0, 7) == "CONFIG:") {
-            std::istringstream iss(message.substr(7));
+            std::istringstream iss(std::string(message.substr(7)));
             std::string id, color;
             
             if (std::getline(iss, id, ':') && std::getline(iss, color)) {
@@ -764,21 +1037,17 @@ void NetworkClient::processServerMessage(const std::string& message) {
                 // Register UDP address
                 DEBUG_LOG("Sending UDP registration");
                 sendUdpRegistration();
-                
-                // Request initial position
-                DEBUG_LOG("Sending initial position request");
-                sendPositionUpdate(0, 0);
             }
         } 
         else if (message.substr(0, 5) == "CHAT:") {
-            std::string chatMessage = message.substr(5);
-            chatMessages.push_back(chatMessage);
+            std::string_view chatMessage = message.substr(5);
+            chatMessages.emplace_back(chatMessage);
             DEBUG_LOG("Chat message (legacy): " << chatMessage);
         } 
         else if (message.substr(0, 8) == "PLAYERS:") {
-            std::istringstream iss(message.substr(8));
+            std::istringstream iss(std::string(message.substr(8)));
             std::string playerData;
-            std::vector<PlayerInfo> newPlayers;
+            ArenaVector<PlayerInfo> newPlayers;
             
             DEBUG_LOG("Processing legacy PLAYERS update");
             
@@ -793,9 +1062,9 @@ void NetworkClient::processServerMessage(const std::string& message) {
                     std::getline(playerIss, yStr)) {
                     
                     PlayerInfo info;
-                    info.id = id;
-                    info.name = name;
-                    info.color = color;
+                    info.id = stringPool.intern(id);
+                    info.name = stringPool.intern(name);
+                    info.color = stringPool.intern(color);
                     info.x = std::stof(xStr);
                     info.y = std::stof(yStr);
                     info.mapId = "default";
@@ -806,26 +1075,13 @@ void NetworkClient::processServerMessage(const std::string& message) {
                 }
             }
             
-            players = newPlayers;
-            
-            // Call the registered callback if available
-            if (playerListCallback) {
-                DEBUG_LOG("Calling player list callback (legacy) with " << players.size() << " players");
-                playerListCallback(players);
-            }
-            
-            // Call position callback for each player
-            for (const auto& player : players) {
-                if (positionCallback) {
-                    DEBUG_LOG("Calling position callback (legacy) for player " << player.id);
-                    positionCallback(player.id, player.x, player.y);
-                }
-            }
+            players.assign(newPlayers.begin(), newPlayers.end());
+            publishPlayers();
             
             DEBUG_LOG("Updated player list (legacy): " << players.size() << " players");
         } 
         else if (message.substr(0, 9) == "POSITION:") {
-            std::istringstream iss(message.substr(9));
+            std::istringstream iss(std::string(message.substr(9)));
             std::string id, xStr, yStr;
             
             if (std::getline(iss, id, ':') && 
@@ -846,11 +1102,7 @@ void NetworkClient::processServerMessage(const std::string& message) {
                     }
                 }
                 
-                // Call the position callback if available
-                if (positionCallback) {
-                    DEBUG_LOG("Calling position callback (legacy) for " << id);
-                    positionCallback(id, x, y);
-                }
+                queuePosition(stringPool.intern(id), x, y);
             }
         }
         else if (message == "PONG") {
@@ -868,6 +1120,262 @@ void NetworkClient::processServerMessage(const std::string& message) {
     }
 }
 
+// Decode one player entry, interning the strings the player list keeps
+bool NetworkClient::decodePlayerInfo(const FrameJson& player, bool requireColor, PlayerInfo& info) {
+    if (!player.contains("id") || !player.contains("name") || (requireColor && !player.contains("color"))) {
+        return false;
+    }
+    
+    info.id = stringPool.intern(stringView(player["id"]));
+    info.name = stringPool.intern(stringView(player["name"]));
+    
+    if (player.contains("color")) {
+        info.color = stringPool.intern(stringView(player["color"]));
+    } else {
+        info.color = "#FF0000"; // Default red
+    }
+    
+    if (player.contains("x") && player.contains("y")) {
+        info.x = player["x"];
+        info.y = player["y"];
+    }
+    
+    if (player.contains("mapId")) {
+        info.mapId = stringPool.intern(stringView(player["mapId"]));
+    } else {
+        info.mapId = "default";
+    }
+    
+    return true;
+}
+
+// Replace the player list from a decoded array of players
+void NetworkClient::decodePlayerList(const FrameJson& list, bool requireColor) {
+    ArenaVector<PlayerInfo> newPlayers;
+    newPlayers.reserve(list.size());
+    
+    for (const auto& player : list) {
+        PlayerInfo info;
+        if (decodePlayerInfo(player, requireColor, info)) {
+            newPlayers.push_back(info);
+        }
+    }
+    
+    // Reuses the long-lived vector's capacity
+    players.assign(newPlayers.begin(), newPlayers.end());
+    publishPlayers();
+    
+    DEBUG_LOG("Updated player list: " << players.size() << " players");
+}
+
+// Flag the player list as changed. It carries the latest positions, so queued
+// position events for listed players are superseded.
+void NetworkClient::publishPlayers() {
+    events.playersChanged = true;
+    if (events.positions.empty()) {
+        return;
+    }
+    
+    listedIds.clear();
+    for (const auto& player : players) {
+        listedIds.insert(player.id);
+    }
+    auto listed = [this](const NetworkEventBatch::PositionEvent& event) {
+        return listedIds.count(event.playerId) > 0;
+    };
+    events.positions.erase(std::remove_if(events.positions.begin(), events.positions.end(), listed),
+                           events.positions.end());
+}
+
+// Rebuild the string pool from the players still known, dropping the ids, names and
+// colors of everyone who left. Runs between frames, once the game is done with the
+// previous batch of events.
+void NetworkClient::compactStringPool() {
+    size_t needed = (players.size() + 1) * STRING_POOL_ENTRIES_PER_PLAYER;
+    if (stringPool.size() <= needed + STRING_POOL_SLACK) {
+        return;
+    }
+
+    size_t before = stringPool.size();
+    StringPool compacted;
+    for (auto& info : players) {
+        info.id = compacted.intern(info.id);
+        info.name = compacted.intern(info.name);
+        info.color = compacted.intern(info.color);
+        info.mapId = compacted.intern(info.mapId);
+    }
+    if (!playerId.empty()) {
+        compacted.intern(playerId);
+    }
+
+    // Sequence state survives only for senders that are still around
+    positionSequences.rekey([&compacted](std::string_view sender) { return compacted.find(sender); });
+
+    // Moving the pool moves its storage blocks, not the strings in them
+    stringPool = std::move(compacted);
+    DEBUG_LOG("Compacted string pool from " << before << " to " << stringPool.size() << " entries");
+}
+
+// Queue a position for a player; the id must be interned
+void NetworkClient::queuePosition(std::string_view playerId, float x, float y) {
+    events.positions.push_back({ playerId, x, y });
+}
+
+// Apply a position update for one player: {"id", "x", "y"} from POSITION and UPDATE,
+// or {"playerId", "position": {"x", "y"}} from POS_UPDATE. Any of them may carry "seq".
+void NetworkClient::handlePositionUpdate(const FrameJson& data) {
+    bool nested = data.contains("playerId") && data.contains("position");
+    const char* idKey = nested ? "playerId" : "id";
+    const FrameJson& coordinates = nested ? data["position"] : data;
+    if (!data.contains(idKey) || !coordinates.contains("x") || !coordinates.contains("y")) {
+        return;
+    }
+    
+    std::string_view id = stringView(data[idKey]);
+    float x = coordinates["x"];
+    float y = coordinates["y"];
+    
+    // Drop datagrams that arrived after a newer one from the same sender
+    if (!acceptPositionSequence(id, data)) {
+        return;
+    }
+    
+    // Update player position in the list
+    for (auto& player : players) {
+        if (player.id == id) {
+            player.x = x;
+            player.y = y;
+            break;
+        }
+    }
+    
+    queuePosition(stringPool.intern(id), x, y);
+}
+
+// A player came into our view
+void NetworkClient::handlePlayerEnter(const FrameJson& data) {
+    PlayerInfo info;
+    if (!decodePlayerInfo(data, true, info)) {
+        return;
+    }
+    
+    // Our own entry only carries our server position
+    if (info.id == playerId) {
+        queuePosition(info.id, info.x, info.y);
+        return;
+    }
+    
+    auto it = std::find_if(players.begin(), players.end(),
+                           [&](const PlayerInfo& player) { return player.id == info.id; });
+    if (it != players.end()) {
+        *it = info;
+    } else {
+        players.push_back(info);
+    }
+    
+    DEBUG_LOG("Player " << info.name << " entered view");
+    publishPlayers();
+}
+
+// A player left our view
+void NetworkClient::handlePlayerLeave(const FrameJson& data) {
+    if (!data.contains("id")) {
+        return;
+    }
+    
+    std::string_view id = stringView(data["id"]);
+    auto it = std::remove_if(players.begin(), players.end(),
+                             [&](const PlayerInfo& player) { return player.id == id; });
+    if (it == players.end()) {
+        return;
+    }
+    players.erase(it, players.end());
+    
+    // A later ENTER starts a fresh sequence window for this player
+    positionSequences.forget(id);
+    
+    DEBUG_LOG("Player " << id << " left view");
+    publishPlayers();
+}
+
+// Decode a map chunk and hand it to the chunk callback
+void NetworkClient::handleChunk(const FrameJson& data) {
+    if (!data.contains("mapId") || !data.contains("cx") || !data.contains("cy") ||
+        !data.contains("size") || !data.contains("tileSize") || !data.contains("tiles")) {
+        return;
+    }
+    
+    ChunkData chunk;
+    chunk.mapId = stringView(data["mapId"]);
+    chunk.cx = data["cx"];
+    chunk.cy = data["cy"];
+    chunk.size = data["size"];
+    chunk.tileSize = data["tileSize"];
+    chunk.mapWidth = data.value("mapWidth", 0);
+    chunk.mapHeight = data.value("mapHeight", 0);
+    
+    if (!decodeBase64(stringView(data["tiles"]), chunkTiles)) {
+        DEBUG_LOG("Malformed tiles in chunk " << chunk.cx << "," << chunk.cy);
+        return;
+    }
+    chunk.tiles = chunkTiles.data();
+    chunk.tileCount = chunkTiles.size();
+    
+    if (chunkCallback) {
+        chunkCallback(chunk);
+    }
+}
+
+// Stop resending inputs the server has applied, and pass on where they left the player
+void NetworkClient::handleInputAck(const FrameJson& data) {
+    if (!data.contains("seq") || !data["seq"].is_number_unsigned()) {
+        return;
+    }
+    
+    SequenceNumber sequence = static_cast<SequenceNumber>(data["seq"].get<unsigned int>());
+    auto now = std::chrono::steady_clock::now();
+    bool newest = inputHistory.acknowledge(sequence);
+    congestion.onAcked(sequence, now);
+    
+    // A reordered older ack would rewind the player past inputs already replayed
+    if (newest && data.contains("x") && data["x"].is_number() && data.contains("y") && data["y"].is_number()) {
+        events.inputAcked = true;
+        events.ackX = data["x"];
+        events.ackY = data["y"];
+    }
+    
+    // The echoed sample time and the server's hold time, from servers that send them
+    uint64_t echoedMicros = data.contains("t") && data["t"].is_number_unsigned() ? data["t"].get<uint64_t>() : 0;
+    uint64_t serverMicros = data.contains("srv") && data["srv"].is_number_unsigned() ? data["srv"].get<uint64_t>() : 0;
+    latencyStats.onInputAcked(sequence, echoedMicros, serverMicros, now);
+}
+
+// Append a chat line to the history
+void NetworkClient::handleChatMessage(const FrameJson& data) {
+    if (!data.contains("sender") || !data.contains("message")) {
+        return;
+    }
+    
+    std::string_view sender = stringView(data["sender"]);
+    std::string_view chatMsg = stringView(data["message"]);
+    
+    // Build the line in place; chat history outlives the frame
+    std::string& fullMessage = chatMessages.emplace_back();
+    fullMessage.reserve(sender.size() + 2 + chatMsg.size());
+    fullMessage.append(sender).append(": ").append(chatMsg);
+    DEBUG_LOG("Chat message: " << fullMessage);
+}
+
+// Check the sender sequence number of a position update, if it carries one
+bool NetworkClient::acceptPositionSequence(std::string_view playerId, const FrameJson& data) {
+    if (!data.contains("seq") || !data["seq"].is_number_unsigned()) {
+        return true;
+    }
+    
+    SequenceNumber sequence = static_cast<SequenceNumber>(data["seq"].get<unsigned int>());
+    return positionSequences.accept(stringPool.intern(playerId), sequence);
+}
+
 // Send connect request
 bool NetworkClient::sendConnectRequest(const std::string& playerName, const std::string& colorHex) {
     if (status != ConnectionStatus::CONNECTED) {
@@ -884,6 +1392,7 @@ bool NetworkClient::sendConnectRequest(const std::string& playerName, const std:
     
     std::string requestStr = request.dump();
     pendingConnectName = playerName;
+    sessionName = playerName;
     
     std::cout << "Sending connect request: " << requestStr << std::endl;
     bool result = sendTcpMessage("CONNECT " + requestStr);
@@ -906,20 +1415,70 @@ bool NetworkClient::sendPositionUpdate(float x, float y) {
     nlohmann::json update = {
         {"id", playerId},
         {"x", std::stof(xStr.str())},
-        {"y", std::stof(yStr.str())}
+        {"y", std::stof(yStr.str())},
+        {"seq", ++udpSequence}
     };
     
     std::string updateStr = update.dump();
-    DEBUG_LOG("Sending position update: " << updateStr);
     
     // Try UDP first, but fall back to TCP if UDP not registered
     if (udpRegistered) {
-        return sendUdpMessage("POSITION " + updateStr);
+        return sendUdpMessage("POSITION " + updateStr, TrafficClass::STATE, "position");
     } else {
         return sendTcpMessage("POSITION " + updateStr);
     }
 }
 
+// Whether this tick's input would reach the server. Not while the link is down or
+// the server has fallen a full history behind.
+bool NetworkClient::canRecordInput() const {
+    return status == ConnectionStatus::CONNECTED && udpRegistered && !inputHistory.full();
+}
+
+// Record one simulation tick of input
+bool NetworkClient::recordInput(uint8_t buttons) {
+    if (!canRecordInput()) {
+        return false;
+    }
+    return inputHistory.record(buttons, std::chrono::steady_clock::now());
+}
+
+// Send all unacknowledged inputs in one datagram
+bool NetworkClient::sendInputs(float tickSeconds) {
+    if (status != ConnectionStatus::CONNECTED || !udpRegistered) {
+        return false;
+    }
+    
+    const auto& pending = inputHistory.pending();
+    if (pending.empty()) {
+        return true;
+    }
+    
+    // One hex digit of InputButton bits per tick, oldest first
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string moves;
+    moves.reserve(pending.size());
+    for (const InputCommand& input : pending) {
+        moves.push_back(hexDigits[input.buttons & 0x0F]);
+    }
+    
+    nlohmann::json inputMsg = {
+        {"id", playerId},
+        {"seq", pending.back().tick},
+        {"dt", tickSeconds},
+        {"moves", moves},
+        {"t", LatencyStats::toMicros(pending.back().sampledAt)}
+    };
+    
+    // Each INPUT holds every unacknowledged tick, so a newer one supersedes a waiting one
+    if (!sendUdpMessage("INPUT " + inputMsg.dump(), TrafficClass::STATE, "input")) {
+        return false;
+    }
+    queuedInputTick = pending.back().tick;
+    latencyStats.onInputQueued(pending.back().tick, pending.back().sampledAt);
+    return true;
+}
+
 // Send chat message
 bool NetworkClient::sendChatMessage(const std::string& message) {
     if (status != ConnectionStatus::CONNECTED) {
@@ -934,6 +1493,12 @@ bool NetworkClient::sendChatMessage(const std::string& message) {
     std::string chatStr = chatMsg.dump();
     DEBUG_LOG("Sending chat message: " << chatStr);
     
+    // Chat has its own ordered UDP stream once the server knows our UDP address
+    if (udpRegistered) {
+        reliableChannel.send("CHAT " + chatStr, ReliableStream::CHAT);
+        return true;
+    }
+    
     return sendTcpMessage("CHAT " + chatStr);
 }
 
@@ -951,9 +1516,67 @@ bool NetworkClient::sendMapChange(const std::string& mapId) {
     std::string mapChangeStr = mapChange.dump();
     DEBUG_LOG("Sending map change: " << mapChangeStr);
     
+    // Prefer the reliable UDP channel once the server knows our UDP address
+    if (udpRegistered) {
+        reliableChannel.send("MAP_CHANGE " + mapChangeStr, ReliableStream::MAP);
+        return true;
+    }
+    
     return sendTcpMessage("MAP_CHANGE " + mapChangeStr);
 }
 
+// Declare the area we want player updates for
+void NetworkClient::setViewRect(float x, float y, float width, float height) {
+    // Snap outward to a coarse grid so a scrolling camera re-declares occasionally, not every tick
+    float left = std::floor(x / viewGranularity) * viewGranularity;
+    float top = std::floor(y / viewGranularity) * viewGranularity;
+    width = std::ceil((x + width) / viewGranularity) * viewGranularity - left;
+    height = std::ceil((y + height) / viewGranularity) * viewGranularity - top;
+    x = left;
+    y = top;
+    
+    if (x == viewX && y == viewY && width == viewWidth && height == viewHeight) {
+        return;
+    }
+    
+    viewX = x;
+    viewY = y;
+    viewWidth = width;
+    viewHeight = height;
+    viewDirty = true;
+}
+
+// Request one map chunk on the map stream
+bool NetworkClient::requestChunk(const std::string& mapId, int cx, int cy) {
+    if (status != ConnectionStatus::CONNECTED || !udpRegistered) {
+        return false;
+    }
+    
+    nlohmann::json request = {
+        {"mapId", mapId},
+        {"cx", cx},
+        {"cy", cy}
+    };
+    
+    reliableChannel.send("CHUNK_REQ " + request.dump(), ReliableStream::MAP);
+    return true;
+}
+
+// Send the current view rectangle on the control stream
+void NetworkClient::sendViewRect() {
+    nlohmann::json view = {
+        {"x", viewX},
+        {"y", viewY},
+        {"width", viewWidth},
+        {"height", viewHeight}
+    };
+    
+    std::string viewStr = view.dump();
+    DEBUG_LOG("Sending view: " << viewStr);
+    reliableChannel.send("VIEW " + viewStr, ReliableStream::CONTROL);
+    viewDirty = false;
+}
+
 // Send UDP registration
 bool NetworkClient::sendUdpRegistration() {
     if (status != ConnectionStatus::CONNECTED) {
@@ -966,28 +1589,11 @@ bool NetworkClient::sendUdpRegistration() {
     };
     
     std::string regStr = regMsg.dump();
-    DEBUG_LOG("Sending direct UDP packet for registration: " << regStr);
+    DEBUG_LOG("Queueing reliable UDP registration: " << regStr);
     
-    // Send via UDP socket directly to register the address with the server
-    // Using the exact command prefix that the server expects (UDP_REGISTER)
-    bool result = sendUdpMessage("UDP_REGISTER " + regStr);
-    
-    if (result) {
-        // Try sending a few times to ensure registration goes through
-        // Sometimes the first packet can be lost
-        for (int i = 0; i < 3; i++) {
-            sendUdpMessage("UDP_REGISTER " + regStr);
-            // Small delay between attempts
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-        
-        DEBUG_LOG("UDP registration sent (multiple attempts)");
-        
-        // Mark as registered, though server will confirm this
-        udpRegistered = true;
-    } else {
-        DEBUG_LOG("Failed to send UDP registration");
-    }
-    
-    return result;
-} 
\ No newline at end of file
+    // The reliable channel retransmits until the server acknowledges; we only switch
+    // positions to UDP once UDP_REGISTERED arrives
+    udpRegistered = false;
+    reliableChannel.send("UDP_REGISTER " + regStr, ReliableStream::CONTROL);
+    return true;
+}
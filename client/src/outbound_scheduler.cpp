@@ -0,0 +1,124 @@
+#include "outbound_scheduler.h"
+#include <algorithm>
+
+namespace {
+    // Priority gained per schedule() while waiting, by TrafficClass
+    const double STATE_PRIORITY = 8.0;
+    const double CONTROL_PRIORITY = 4.0;
+    const double CHAT_PRIORITY = 2.0;
+    const double BULK_PRIORITY = 1.0;
+
+    // The uplink may burst this many seconds of its rate
+    const double UPLINK_BURST_SECONDS = 0.1;
+
+    // Default per-class limits in bytes per second and burst bytes
+    const double CHAT_RATE = 2048.0;
+    const double CHAT_BURST = 4096.0;
+    const double BULK_RATE = 8192.0;
+    const double BULK_BURST = 8192.0;
+}
+
+// Set the refill rate and burst size; the bucket starts full
+void TokenBucket::configure(double bytesPerSecond, double burstBytes) {
+    rate = std::max(0.0, bytesPerSecond);
+    burst = std::max(0.0, burstBytes);
+    tokens = burst;
+}
+
+// Add the tokens earned since the last refill
+void TokenBucket::refill(Clock::time_point now) {
+    if (hasRefilled && rate > 0.0) {
+        double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+        tokens = std::min(burst, tokens + elapsed * rate);
+    }
+    lastRefill = now;
+    hasRefilled = true;
+}
+
+// Spend tokens for a sent message
+void TokenBucket::consume(size_t bytes) {
+    if (rate > 0.0) {
+        tokens -= static_cast<double>(bytes);
+    }
+}
+
+// Constructor
+OutboundScheduler::OutboundScheduler() {
+    classPriority[static_cast<size_t>(TrafficClass::STATE)] = STATE_PRIORITY;
+    classPriority[static_cast<size_t>(TrafficClass::CONTROL)] = CONTROL_PRIORITY;
+    classPriority[static_cast<size_t>(TrafficClass::CHAT)] = CHAT_PRIORITY;
+    classPriority[static_cast<size_t>(TrafficClass::BULK)] = BULK_PRIORITY;
+
+    setClassLimit(TrafficClass::CHAT, CHAT_RATE, CHAT_BURST);
+    setClassLimit(TrafficClass::BULK, BULK_RATE, BULK_BURST);
+}
+
+// Queue a message, merging it into a waiting one with the same key
+void OutboundScheduler::enqueue(TrafficClass trafficClass, std::string message, std::string key) {
+    if (!key.empty()) {
+        auto it = std::find_if(queue.begin(), queue.end(), [&](const Entry& entry) { return entry.key == key; });
+        if (it != queue.end()) {
+            it->trafficClass = trafficClass;
+            it->message = std::move(message);
+            mergedCount++;
+            return;
+        }
+    }
+
+    Entry entry;
+    entry.trafficClass = trafficClass;
+    entry.message = std::move(message);
+    entry.key = std::move(key);
+    entry.order = nextOrder++;
+    queue.push_back(std::move(entry));
+}
+
+// Release the most important messages the buckets allow
+void OutboundScheduler::schedule(Clock::time_point now, std::vector<std::string>& outgoing) {
+    uplink.refill(now);
+    for (auto& bucket : classBuckets) {
+        bucket.refill(now);
+    }
+
+    if (queue.empty()) {
+        return;
+    }
+
+    for (auto& entry : queue) {
+        entry.priority += classPriority[static_cast<size_t>(entry.trafficClass)];
+    }
+    std::sort(queue.begin(), queue.end(), [](const Entry& a, const Entry& b) {
+        return a.priority != b.priority ? a.priority > b.priority : a.order < b.order;
+    });
+
+    std::vector<Entry> deferred;
+    for (auto& entry : queue) {
+        TokenBucket& classBucket = classBuckets[static_cast<size_t>(entry.trafficClass)];
+        if (!uplink.available() || !classBucket.available()) {
+            deferred.push_back(std::move(entry));
+            continue;
+        }
+
+        uplink.consume(entry.message.size());
+        classBucket.consume(entry.message.size());
+        outgoing.push_back(std::move(entry.message));
+    }
+
+    deferredCount += deferred.size();
+    queue.swap(deferred);
+}
+
+// Limit the whole uplink
+void OutboundScheduler::setUplinkRate(double bytesPerSecond) {
+    uplink.configure(bytesPerSecond, bytesPerSecond * UPLINK_BURST_SECONDS);
+}
+
+// Limit one class of traffic
+void OutboundScheduler::setClassLimit(TrafficClass trafficClass, double bytesPerSecond, double burstBytes) {
+    classBuckets[static_cast<size_t>(trafficClass)].configure(bytesPerSecond, burstBytes);
+}
+
+// Drop everything queued
+void OutboundScheduler::reset() {
+    queue.clear();
+}
@@ -5,13 +5,20 @@
 
 #define DEBUG_LOG(msg) std::cout << "[PlayerManager] " << msg << std::endl
 
+namespace {
+    // The server's default map, until chunk data reports the real size
+    constexpr int DEFAULT_MAP_CHUNKS = 64;
+    constexpr int CHUNK_SIZE_TILES = 32;
+    constexpr int TILE_SIZE_PIXELS = 32;
+    constexpr float DEFAULT_WORLD_SIZE = DEFAULT_MAP_CHUNKS * CHUNK_SIZE_TILES * TILE_SIZE_PIXELS;
+}
+
 PlayerManager::PlayerManager(int width, int height) : 
-    screenWidth(width),
-    screenHeight(height) {
+    worldWidth(DEFAULT_WORLD_SIZE),
+    worldHeight(DEFAULT_WORLD_SIZE) {
     
     // Initialize local player
-    localPlayer.x = screenWidth / 2;
-    localPlayer.y = screenHeight / 2;
+    localPlayer.snapTo(width / 2, height / 2);
     localPlayer.initialPositionReceived = false;
     localPlayer.radius = 20.0f;
     localPlayer.speed = 200.0f;
@@ -19,82 +26,87 @@ PlayerManager::PlayerManager(int width, int height) :
 }
 
 // Update local player position
-void PlayerManager::updateLocalPlayer(float deltaTime, bool chatInputActive) {
-    if (chatInputActive) return; // Don't move when chatting
-    if (!localPlayer.initialPositionReceived) return; // Don't move until initial position is received
+uint8_t PlayerManager::updateLocalPlayer(float deltaTime, bool chatInputActive) {
+    if (chatInputActive) return 0; // Don't move when chatting
+    if (!localPlayer.initialPositionReceived) return 0; // Don't move until initial position is received
     
+    // Movement keys
+    uint8_t buttons = 0;
+    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) buttons |= INPUT_UP;
+    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) buttons |= INPUT_DOWN;
+    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) buttons |= INPUT_LEFT;
+    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) buttons |= INPUT_RIGHT;
+    
+    applyInput(buttons, deltaTime);
+    return buttons;
+}
+
+// Move the local player by one tick of input, the same way the server simulates it
+void PlayerManager::applyInput(uint8_t buttons, float deltaTime) {
     float speed = localPlayer.speed * deltaTime;
     
-    // Movement keys
-    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
-        localPlayer.y -= speed;
-    }
-    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
-        localPlayer.y += speed;
-    }
-    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) {
-        localPlayer.x -= speed;
-    }
-    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) {
-        localPlayer.x += speed;
-    }
+    if (buttons & INPUT_UP) localPlayer.y -= speed;
+    if (buttons & INPUT_DOWN) localPlayer.y += speed;
+    if (buttons & INPUT_LEFT) localPlayer.x -= speed;
+    if (buttons & INPUT_RIGHT) localPlayer.x += speed;
     
-    // Keep player within screen bounds
+    // Keep player within the map, as the server does
     if (localPlayer.x < localPlayer.radius) localPlayer.x = localPlayer.radius;
     if (localPlayer.y < localPlayer.radius) localPlayer.y = localPlayer.radius;
-    if (localPlayer.x > screenWidth - localPlayer.radius) localPlayer.x = screenWidth - localPlayer.radius;
-    if (localPlayer.y > screenHeight - localPlayer.radius) localPlayer.y = screenHeight - localPlayer.radius;
+    if (localPlayer.x > worldWidth - localPlayer.radius) localPlayer.x = worldWidth - localPlayer.radius;
+    if (localPlayer.y > worldHeight - localPlayer.radius) localPlayer.y = worldHeight - localPlayer.radius;
 }
 
-// Update player list based on server data
-void PlayerManager::updatePlayers(const std::vector<PlayerInfo>& playerInfos, const std::string& localPlayerId) {
-    DEBUG_LOG("Updating player list with " << playerInfos.size() << " players");
-    
-    bool foundLocalPlayer = false;
+// Replay unacknowledged inputs on top of the server's acknowledged position
+void PlayerManager::reconcile(float x, float y, const std::deque<InputCommand>& pending, float tickSeconds) {
+    if (!localPlayer.initialPositionReceived) return;
     
+    localPlayer.serverX = x;
+    localPlayer.serverY = y;
+    localPlayer.x = x;
+    localPlayer.y = y;
+    for (const auto& input : pending) {
+        applyInput(input.buttons, tickSeconds);
+    }
+}
+
+// Update player list based on server data. Interest-based lists usually leave the
+// local player out, which keeps its predicted position.
+void PlayerManager::updatePlayers(const std::vector<PlayerInfo>& playerInfos, const std::string& localPlayerId) {
     // Update existing players and add new ones
     for (const auto& playerInfo : playerInfos) {
-        DEBUG_LOG("Processing player: " << playerInfo.id << " (" << playerInfo.name << ")");
-        
         // Check if this is the local player
         if (playerInfo.id == localPlayerId) {
-            foundLocalPlayer = true;
-            
             // If this is the first time we're seeing the local player or if server sent a position update
             if (!localPlayer.initialPositionReceived || playerInfo.x != 0.0f || playerInfo.y != 0.0f) {
                 // Use the server-provided position
-                localPlayer.x = playerInfo.x;
-                localPlayer.y = playerInfo.y;
+                localPlayer.snapTo(playerInfo.x, playerInfo.y);
                 localPlayer.serverX = playerInfo.x;
                 localPlayer.serverY = playerInfo.y;
                 localPlayer.initialPositionReceived = true;
-                
-                DEBUG_LOG("Using server-provided position: (" << playerInfo.x << "," << playerInfo.y << ")");
-            } else {
-                DEBUG_LOG("Found local player: " << playerInfo.name << " at position (" 
-                          << localPlayer.x << "," << localPlayer.y << ")");
             }
         }
         // Otherwise, it's another player
         else {
-            bool isNewPlayer = (players.find(playerInfo.id) == players.end());
+            bool isNewPlayer = (players.find(std::string(playerInfo.id)) == players.end());
             
             // Get reference to player (creates if not exists)
-            Player& player = players[playerInfo.id];
+            Player& player = players[std::string(playerInfo.id)];
             player.id = playerInfo.id;
             player.name = playerInfo.name;
-            player.color = ColorUtils::parseColorString(playerInfo.color);
+            player.color = ColorUtils::parseColorString(std::string(playerInfo.color));
             player.mapId = playerInfo.mapId;
             player.isActive = true;
             
             // Always use the server's position for other players
-            player.x = playerInfo.x;
-            player.y = playerInfo.y;
+            if (isNewPlayer) {
+                player.snapTo(playerInfo.x, playerInfo.y);
+            } else {
+                player.x = playerInfo.x;
+                player.y = playerInfo.y;
+            }
             player.serverX = playerInfo.x;
             player.serverY = playerInfo.y;
-            
-            DEBUG_LOG("Updated position for player " << playerInfo.name << ": (" 
-                      << playerInfo.x << "," << playerInfo.y << ")");
         }
     }
     
@@ -116,28 +128,32 @@ void PlayerManager::updatePlayers(const std::vector<PlayerInfo>& playerInfos, co
             ++it;
         }
     }
+}
+
+// Apply the events gathered by one network update
+void PlayerManager::applyNetworkEvents(const NetworkEventBatch& events, const std::vector<PlayerInfo>& playerInfos,
+                                       const std::string& localPlayerId) {
+    if (events.playersChanged) {
+        updatePlayers(playerInfos, localPlayerId);
+    }
     
-    // If we didn't find the local player in the list, something is wrong
-    if (!foundLocalPlayer && !localPlayerId.empty()) {
-        DEBUG_LOG("Warning: Local player ID " << localPlayerId << " not found in player list!");
+    for (const auto& position : events.positions) {
+        processPositionUpdate(position.playerId, position.x, position.y, localPlayerId);
     }
 }
 
 // Process position update from server for a specific player
-void PlayerManager::processPositionUpdate(const std::string& playerId, float x, float y, const std::string& localPlayerId) {
-    std::cout << "Received position update for player: " << playerId << " at position (" << x << ", " << y << ")" << std::endl;
-    
+void PlayerManager::processPositionUpdate(std::string_view playerId, float x, float y, const std::string& localPlayerId) {
     // Check if it's our own player
     if (playerId == localPlayerId) {
         // If this is the first position update received from the server
         if (!localPlayer.initialPositionReceived) {
             // Initialize player at the server's position
-            localPlayer.x = x;
-            localPlayer.y = y;
+            localPlayer.snapTo(x, y);
             localPlayer.serverX = x;
             localPlayer.serverY = y;
             localPlayer.initialPositionReceived = true;
-            std::cout << "Initial position received from server: (" << x << ", " << y << ")" << std::endl;
+            DEBUG_LOG("Initial position received from server: (" << x << ", " << y << ")");
         } else {
             // Just update the server position for correction
             localPlayer.serverX = x;
@@ -147,7 +163,7 @@ void PlayerManager::processPositionUpdate(const std::string& playerId, float x,
     }
     
     // Find player
-    auto it = players.find(playerId);
+    auto it = players.find(std::string(playerId));
     if (it != players.end()) {
         // For other players, directly update their position
         it->second.x = x;
@@ -155,6 +171,28 @@ void PlayerManager::processPositionUpdate(const std::string& playerId, float x,
     }
 }
 
+// Record the current positions as the previous simulation state
+void PlayerManager::beginTick() {
+    localPlayer.prevX = localPlayer.x;
+    localPlayer.prevY = localPlayer.y;
+    
+    for (auto& [id, player] : players) {
+        player.prevX = player.x;
+        player.prevY = player.y;
+    }
+}
+
+// Blend the last two simulation states for drawing; alpha is the fraction of a tick elapsed
+void PlayerManager::interpolate(float alpha) {
+    localPlayer.renderX = localPlayer.prevX + (localPlayer.x - localPlayer.prevX) * alpha;
+    localPlayer.renderY = localPlayer.prevY + (localPlayer.y - localPlayer.prevY) * alpha;
+    
+    for (auto& [id, player] : players) {
+        player.renderX = player.prevX + (player.x - player.prevX) * alpha;
+        player.renderY = player.prevY + (player.y - player.prevY) * alpha;
+    }
+}
+
 // Correct player position based on server position
 void PlayerManager::correctPlayerPosition() {
     // Temporarily commented out because the function is not working as expected
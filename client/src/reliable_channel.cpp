@@ -0,0 +1,348 @@
+#include "reliable_channel.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[ReliableChannel] " << msg << std::endl
+
+namespace {
+    const double MIN_RTO_MS = 100.0;
+    const double MAX_RTO_MS = 2000.0;
+    const double INITIAL_RTO_MS = 250.0;
+    const double CLOCK_GRANULARITY_MS = 10.0;
+
+    // Body of a packet that fills an abandoned stream slot; no message is a bare "~SKIP"
+    const char* const SKIP_MESSAGE = "~SKIP";
+
+    // Parse a decimal number ending at a space or the end of text, and advance past it
+    template <typename T>
+    bool parseField(std::string_view& text, T& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        text.remove_prefix(static_cast<size_t>(result.ptr - text.data()));
+        if (text.empty()) {
+            return true;
+        }
+        if (text.front() != ' ') {
+            return false;
+        }
+        text.remove_prefix(1);
+        return true;
+    }
+}
+
+// Constructor
+ReliableChannel::ReliableChannel(size_t windowSize, int maxTransmissions) :
+    windowSize(std::min<size_t>(windowSize, 32)), // ack bitfield covers 32 older sequences
+    maxTransmissions(maxTransmissions)
+{
+}
+
+// Queue a message for reliable, in-order delivery on a stream
+void ReliableChannel::send(const std::string& message, ReliableStream stream) {
+    StreamMessage payload;
+    payload.stream = stream;
+    payload.streamSequence = nextStreamSequence[static_cast<size_t>(stream)]++;
+    payload.message = message;
+    queued.push_back(std::move(payload));
+}
+
+// Check whether a datagram belongs to the reliable channel
+bool ReliableChannel::isChannelPacket(std::string_view datagram) {
+    return datagram.compare(0, 4, "REL ") == 0 || datagram.compare(0, 4, "ACK ") == 0;
+}
+
+// Pick the stream and sequence out of "REL <seq> <ack> <ackBits> <stream> ..."
+bool ReliableChannel::parsePacketHeader(std::string_view packet, ReliableStream& stream, std::string_view& sequence) {
+    if (packet.compare(0, 4, "REL ") != 0) {
+        return false;
+    }
+
+    std::string_view fields[4];
+    size_t start = 4;
+    for (auto& field : fields) {
+        size_t end = packet.find(' ', start);
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        field = packet.substr(start, end - start);
+        start = end + 1;
+    }
+
+    if (fields[3].size() != 1 || fields[3][0] < '0' ||
+        fields[3][0] >= '0' + static_cast<int>(ReliableStream::COUNT)) {
+        return false;
+    }
+    stream = static_cast<ReliableStream>(fields[3][0] - '0');
+    sequence = fields[0];
+    return true;
+}
+
+// Handle an inbound datagram
+bool ReliableChannel::receive(std::string_view datagram, std::vector<std::string_view>& delivered,
+                              Clock::time_point now) {
+    if (!isChannelPacket(datagram)) {
+        return false;
+    }
+
+    released.clear();
+    std::string_view fields = datagram.substr(4);
+
+    if (datagram[0] == 'A') {
+        unsigned int ack = 0;
+        uint32_t ackBits = 0;
+        if (parseField(fields, ack) && parseField(fields, ackBits)) {
+            processAcks(static_cast<SequenceNumber>(ack), ackBits, now);
+        }
+        return true;
+    }
+
+    unsigned int sequence = 0;
+    unsigned int ack = 0;
+    uint32_t ackBits = 0;
+    unsigned int stream = 0;
+    unsigned int streamSequence = 0;
+    if (!parseField(fields, sequence) || !parseField(fields, ack) || !parseField(fields, ackBits) ||
+        !parseField(fields, stream) || !parseField(fields, streamSequence) ||
+        stream >= static_cast<unsigned int>(ReliableStream::COUNT)) {
+        DEBUG_LOG("Malformed reliable packet: " << datagram);
+        return true;
+    }
+
+    processAcks(static_cast<SequenceNumber>(ack), ackBits, now);
+
+    // Always acknowledge, even duplicates, since our previous ack may have been lost
+    ackPending = true;
+    if (!recordReceived(static_cast<SequenceNumber>(sequence))) {
+        return true;
+    }
+
+    // The message is everything after the header's separating space
+    deliverInOrder(static_cast<ReliableStream>(stream), static_cast<SequenceNumber>(streamSequence),
+                   fields, delivered);
+    return true;
+}
+
+// Deliver a message if it is next on its stream, holding later ones until the gap fills.
+// Only messages that arrive out of order are copied.
+void ReliableChannel::deliverInOrder(ReliableStream stream, SequenceNumber streamSequence, std::string_view message,
+                                     std::vector<std::string_view>& delivered) {
+    InboundStream& inbound = inboundStreams[static_cast<size_t>(stream)];
+
+    if (streamSequence != inbound.expected) {
+        if (sequenceGreaterThan(streamSequence, inbound.expected)) {
+            inbound.buffered.emplace(streamSequence, std::string(message));
+        }
+        return;
+    }
+
+    // A skip marker takes its slot in the order but delivers nothing
+    if (message != SKIP_MESSAGE) {
+        delivered.push_back(message);
+    }
+    inbound.expected++;
+
+    // Release anything that was waiting on this message
+    auto it = inbound.buffered.find(inbound.expected);
+    while (it != inbound.buffered.end()) {
+        if (it->second != SKIP_MESSAGE) {
+            delivered.push_back(released.emplace_back(std::move(it->second)));
+        }
+        inbound.buffered.erase(it);
+        inbound.expected++;
+        it = inbound.buffered.find(inbound.expected);
+    }
+}
+
+// Messages received out of order and waiting for an earlier one on their stream
+size_t ReliableChannel::getReorderBufferedCount() const {
+    size_t count = 0;
+    for (const auto& inbound : inboundStreams) {
+        count += inbound.buffered.size();
+    }
+    return count;
+}
+
+// Record an inbound sequence, returns false if it was already received
+bool ReliableChannel::recordReceived(SequenceNumber sequence) {
+    if (!hasRemoteSequence) {
+        hasRemoteSequence = true;
+        remoteSequence = sequence;
+        remoteAckBits = 0;
+        return true;
+    }
+
+    if (sequence == remoteSequence) {
+        return false;
+    }
+
+    if (sequenceGreaterThan(sequence, remoteSequence)) {
+        SequenceNumber shift = static_cast<SequenceNumber>(sequence - remoteSequence);
+        // The previous newest sequence becomes bit (shift - 1), older bits move up with it
+        uint32_t shifted = (shift >= 32) ? 0 : (remoteAckBits << shift);
+        if (shift <= 32) {
+            shifted |= (1u << (shift - 1));
+        }
+        remoteAckBits = shifted;
+        remoteSequence = sequence;
+        return true;
+    }
+
+    SequenceNumber age = static_cast<SequenceNumber>(remoteSequence - sequence);
+    if (age > 32) {
+        // Older than the ack window; the sender window guarantees this is a duplicate
+        return false;
+    }
+
+    uint32_t bit = 1u << (age - 1);
+    if (remoteAckBits & bit) {
+        return false;
+    }
+
+    remoteAckBits |= bit;
+    return true;
+}
+
+// Remove acknowledged messages from the in-flight list
+void ReliableChannel::processAcks(SequenceNumber ack, uint32_t ackBits, Clock::time_point now) {
+    auto acknowledged = [&](SequenceNumber sequence) {
+        if (sequence == ack) {
+            return true;
+        }
+        SequenceNumber age = static_cast<SequenceNumber>(ack - sequence);
+        return age >= 1 && age <= 32 && (ackBits & (1u << (age - 1))) != 0;
+    };
+
+    auto it = inFlight.begin();
+    while (it != inFlight.end()) {
+        if (acknowledged(it->sequence)) {
+            // Karn's rule: only unambiguous samples update the estimate
+            if (it->transmissions == 1) {
+                addRttSample(std::chrono::duration<double, std::milli>(now - it->lastSent).count());
+            }
+            it = inFlight.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Update the smoothed RTT and retransmit timeout (RFC 6298)
+void ReliableChannel::addRttSample(double sampleMs) {
+    if (!hasRttSample) {
+        hasRttSample = true;
+        smoothedRttMs = sampleMs;
+        rttVarianceMs = sampleMs / 2.0;
+    } else {
+        rttVarianceMs = 0.75 * rttVarianceMs + 0.25 * std::abs(smoothedRttMs - sampleMs);
+        smoothedRttMs = 0.875 * smoothedRttMs + 0.125 * sampleMs;
+    }
+
+    retransmitTimeoutMs = smoothedRttMs + std::max(CLOCK_GRANULARITY_MS, 4.0 * rttVarianceMs);
+    retransmitTimeoutMs = std::clamp(retransmitTimeoutMs, MIN_RTO_MS, MAX_RTO_MS);
+}
+
+// Build a reliable packet carrying the current ack state
+std::string ReliableChannel::buildPacket(SequenceNumber sequence, const StreamMessage& payload) const {
+    std::ostringstream oss;
+    oss << "REL " << sequence << " " << remoteSequence << " " << remoteAckBits << " "
+        << static_cast<unsigned int>(payload.stream) << " " << payload.streamSequence << " " << payload.message;
+    return oss.str();
+}
+
+// Emit packets due now
+void ReliableChannel::update(Clock::time_point now, std::vector<std::string>& outgoing) {
+    bool ackSent = false;
+
+    // Retransmit expired messages with exponential backoff per message
+    auto it = inFlight.begin();
+    while (it != inFlight.end()) {
+        double timeoutMs = std::min(retransmitTimeoutMs * (1 << std::min(it->transmissions - 1, 4)), MAX_RTO_MS);
+        double elapsedMs = std::chrono::duration<double, std::milli>(now - it->lastSent).count();
+
+        if (elapsedMs < timeoutMs) {
+            ++it;
+            continue;
+        }
+
+        // The message is lost to the caller, but its stream slot still has to be filled
+        if (!it->abandoned && it->transmissions >= maxTransmissions) {
+            DEBUG_LOG("Giving up on reliable message " << it->sequence << " after "
+                      << it->transmissions << " transmissions, skipping its stream slot");
+            failed.push_back(std::move(it->payload.message));
+            it->payload.message = SKIP_MESSAGE;
+            it->abandoned = true;
+        }
+
+        outgoing.push_back(buildPacket(it->sequence, it->payload));
+        it->lastSent = now;
+        it->transmissions++;
+        retransmitCount++;
+        ackSent = true;
+        ++it;
+    }
+
+    // Move queued messages into the send window. The window bounds the sequence span
+    // in flight, not the count, so the oldest message always stays within the
+    // receiver's ack bitfield.
+    auto windowOpen = [&]() {
+        return inFlight.empty() ||
+               static_cast<SequenceNumber>(nextSequence - inFlight.front().sequence) < windowSize;
+    };
+
+    while (!queued.empty() && windowOpen()) {
+        PendingMessage pending;
+        pending.sequence = nextSequence++;
+        pending.payload = std::move(queued.front());
+        pending.lastSent = now;
+        pending.transmissions = 1;
+        queued.pop_front();
+
+        outgoing.push_back(buildPacket(pending.sequence, pending.payload));
+        inFlight.push_back(std::move(pending));
+        ackSent = true;
+    }
+
+    // Standalone ack if nothing carried it
+    if (ackPending && !ackSent && hasRemoteSequence) {
+        std::ostringstream oss;
+        oss << "ACK " << remoteSequence << " " << remoteAckBits;
+        outgoing.push_back(oss.str());
+    }
+    ackPending = false;
+}
+
+// Messages that exhausted their retransmissions
+std::vector<std::string> ReliableChannel::takeFailed() {
+    std::vector<std::string> result;
+    result.swap(failed);
+    return result;
+}
+
+// Drop all state
+void ReliableChannel::reset() {
+    queued.clear();
+    inFlight.clear();
+    failed.clear();
+    nextSequence = 0;
+    nextStreamSequence.fill(0);
+    for (auto& inbound : inboundStreams) {
+        inbound.expected = 0;
+        inbound.buffered.clear();
+    }
+    released.clear();
+    hasRemoteSequence = false;
+    remoteSequence = 0;
+    remoteAckBits = 0;
+    ackPending = false;
+    hasRttSample = false;
+    smoothedRttMs = 0.0;
+    rttVarianceMs = 0.0;
+    retransmitTimeoutMs = INITIAL_RTO_MS;
+    retransmitCount = 0;
+}
@@ -0,0 +1,254 @@
+#include "simulated_transport.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[SimulatedTransport] " << msg << std::endl
+
+namespace {
+    // Longest a datagram may wait for the link before it is dropped
+    const auto MAX_LINK_QUEUE = std::chrono::seconds(1);
+
+    // Longest a reordered datagram waits for another to overtake it
+    const auto MAX_REORDER_HOLD = std::chrono::milliseconds(100);
+
+    // Largest inbound read from the inner transport
+    const size_t RECEIVE_BUFFER_BYTES = 65536;
+
+    std::chrono::steady_clock::duration milliseconds(double ms) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(ms));
+    }
+}
+
+// Constructor
+SimulatedTransport::SimulatedTransport(std::unique_ptr<Transport> inner, const NetworkConditions& conditions) :
+    inner(std::move(inner)),
+    conditions(conditions),
+    random(conditions.seed),
+    receiveBuffer(RECEIVE_BUFFER_BYTES)
+{
+    DEBUG_LOG("Simulating " << conditions.latencyMs << " ms +/- " << conditions.jitterMs << " ms, "
+              << conditions.lossPercent << "% loss, " << conditions.duplicatePercent << "% duplicates, "
+              << conditions.reorderPercent << "% reordered, "
+              << conditions.bandwidthBytesPerSecond << " B/s, seed " << conditions.seed);
+}
+
+// Connecting is not impaired
+bool SimulatedTransport::open() {
+    bool opened = inner->open();
+    statusMessage = inner->getStatusMessage();
+    return opened;
+}
+
+// Report the inner transport's progress
+Transport::State SimulatedTransport::poll() {
+    State state = inner->poll();
+    statusMessage = inner->getStatusMessage();
+    return state;
+}
+
+// Drop everything in flight along with the connection
+void SimulatedTransport::disconnect() {
+    inner->disconnect();
+    outbound = Link();
+    inbound = Link();
+    streamOutbound.clear();
+    streamFailed = false;
+    streamReady.clear();
+    datagramsReady.clear();
+    streamEnd = STREAM_EMPTY;
+}
+
+// Roll against a percentage
+bool SimulatedTransport::chance(double percent) {
+    if (percent <= 0.0) {
+        return false;
+    }
+    return std::uniform_real_distribution<double>(0.0, 100.0)(random) < percent;
+}
+
+// Serialize bytes onto the link, then add propagation delay and jitter
+std::optional<SimulatedTransport::Clock::time_point> SimulatedTransport::transmit(
+    Link& link, size_t bytes, Clock::time_point now, bool mayDrop) {
+    Clock::time_point start = std::max(now, link.freeAt);
+    if (mayDrop && start - now > MAX_LINK_QUEUE) {
+        return std::nullopt;
+    }
+
+    link.freeAt = start;
+    if (conditions.bandwidthBytesPerSecond > 0.0) {
+        link.freeAt += milliseconds(1000.0 * static_cast<double>(bytes) / conditions.bandwidthBytesPerSecond);
+    }
+
+    double delayMs = conditions.latencyMs;
+    if (conditions.jitterMs > 0.0) {
+        delayMs += std::uniform_real_distribution<double>(-conditions.jitterMs, conditions.jitterMs)(random);
+    }
+    return link.freeAt + milliseconds(std::max(0.0, delayMs));
+}
+
+// Lose, duplicate or mark a datagram for reordering, then put it on the link
+void SimulatedTransport::scheduleDatagram(Link& link, std::string_view datagram, Clock::time_point now) {
+    if (chance(conditions.lossPercent)) {
+        return;
+    }
+
+    int copies = chance(conditions.duplicatePercent) ? 2 : 1;
+    bool reorder = chance(conditions.reorderPercent);
+
+    for (int i = 0; i < copies; i++) {
+        std::optional<Clock::time_point> due = transmit(link, datagram.size(), now, true);
+        if (!due) {
+            return;
+        }
+        link.datagrams.push({ *due, nextOrder++, std::string(datagram), reorder && i == 0 });
+    }
+}
+
+// Put stream bytes on the link behind everything sent before them
+void SimulatedTransport::scheduleStream(Link& link, std::string data, Clock::time_point now) {
+    Clock::time_point due = *transmit(link, data.size(), now, false);
+    due = std::max(due, link.lastStreamDue);
+    link.lastStreamDue = due;
+    link.stream.push_back({ due, nextOrder++, std::move(data), false });
+}
+
+// Deliver due datagrams in arrival order; a reordered one waits for the next to pass it
+template <typename Deliver>
+void SimulatedTransport::releaseDatagrams(Link& link, Clock::time_point now, Deliver deliver) {
+    while (!link.datagrams.empty() && link.datagrams.top().due <= now) {
+        Packet packet = link.datagrams.top();
+        link.datagrams.pop();
+
+        if (packet.reorder && !link.held) {
+            link.held = std::move(packet);
+            link.heldUntil = now + MAX_REORDER_HOLD;
+            continue;
+        }
+
+        deliver(packet.data);
+        if (link.held) {
+            deliver(link.held->data);
+            link.held.reset();
+        }
+    }
+
+    if (link.held && now >= link.heldUntil) {
+        deliver(link.held->data);
+        link.held.reset();
+    }
+}
+
+// Advance both directions to now
+void SimulatedTransport::pump(Clock::time_point now) {
+    // Outbound: whatever crossed the link goes to the real transport
+    releaseDatagrams(outbound, now, [this](const std::string& datagram) {
+        inner->sendDatagram(datagram);
+    });
+
+    while (!outbound.stream.empty() && outbound.stream.front().due <= now) {
+        streamOutbound.push(outbound.stream.front().data);
+        outbound.stream.pop_front();
+    }
+    if (!streamFailed && streamOutbound.getQueuedMessages() > 0 &&
+        inner->flushStream(streamOutbound) == TcpOutboundQueue::FlushResult::FAILED) {
+        streamFailed = true;
+    }
+
+    // Inbound: everything the real transport has enters the link
+    while (streamEnd == STREAM_EMPTY) {
+        int received = inner->receiveStream(receiveBuffer.data(), receiveBuffer.size());
+        if (received > 0) {
+            scheduleStream(inbound, std::string(receiveBuffer.data(), received), now);
+        } else {
+            // STREAM_EMPTY keeps reading next time; closed or failed ends the stream
+            streamEnd = received;
+            break;
+        }
+    }
+
+    int datagramSize;
+    while ((datagramSize = inner->receiveDatagram(receiveBuffer.data(), receiveBuffer.size())) > 0) {
+        scheduleDatagram(inbound, std::string_view(receiveBuffer.data(), datagramSize), now);
+    }
+
+    while (!inbound.stream.empty() && inbound.stream.front().due <= now) {
+        streamReady.append(inbound.stream.front().data);
+        inbound.stream.pop_front();
+    }
+
+    releaseDatagrams(inbound, now, [this](const std::string& datagram) {
+        datagramsReady.push_back(datagram);
+    });
+}
+
+// Move queued messages onto the simulated link
+TcpOutboundQueue::FlushResult SimulatedTransport::flushStream(TcpOutboundQueue& queue) {
+    auto now = Clock::now();
+
+    std::string message;
+    while (queue.popFront(message)) {
+        message.push_back('\n');
+        scheduleStream(outbound, std::move(message), now);
+        message.clear();
+    }
+
+    pump(now);
+
+    if (streamFailed) {
+        return TcpOutboundQueue::FlushResult::FAILED;
+    }
+    return outbound.stream.empty() && streamOutbound.getQueuedMessages() == 0
+        ? TcpOutboundQueue::FlushResult::DRAINED
+        : TcpOutboundQueue::FlushResult::PENDING;
+}
+
+// Hand over stream bytes that have crossed the link
+int SimulatedTransport::receiveStream(char* buffer, size_t size) {
+    pump(Clock::now());
+
+    if (!streamReady.empty()) {
+        size_t count = std::min(size, streamReady.size());
+        std::memcpy(buffer, streamReady.data(), count);
+        streamReady.erase(0, count);
+        return static_cast<int>(count);
+    }
+
+    // The close arrives after the data sent before it
+    if (streamEnd != STREAM_EMPTY && inbound.stream.empty()) {
+        return streamEnd;
+    }
+    if (streamFailed) {
+        return STREAM_FAILED;
+    }
+    return STREAM_EMPTY;
+}
+
+// Put a datagram on the link; like UDP, success says nothing about delivery
+bool SimulatedTransport::sendDatagram(std::string_view datagram) {
+    auto now = Clock::now();
+    scheduleDatagram(outbound, datagram, now);
+    pump(now);
+    return true;
+}
+
+// Hand over the next datagram that has crossed the link
+int SimulatedTransport::receiveDatagram(char* buffer, size_t size) {
+    if (datagramsReady.empty()) {
+        pump(Clock::now());
+    }
+
+    while (!datagramsReady.empty()) {
+        std::string datagram = std::move(datagramsReady.front());
+        datagramsReady.pop_front();
+
+        // Like recvfrom with a short buffer: an oversized datagram is dropped
+        if (datagram.size() <= size) {
+            std::memcpy(buffer, datagram.data(), datagram.size());
+            return static_cast<int>(datagram.size());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include "stub_server.h"
+#include <algorithm>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[StubServer] " << msg << std::endl
+
+namespace {
+    // Spawn points are laid out in rows from here
+    const float SPAWN_X = 100.0f;
+    const float SPAWN_Y = 100.0f;
+    const float SPAWN_SPACING = 32.0f;
+    const int SPAWN_COLUMNS = 16;
+
+    // Position messages as the client sends and expects them
+    std::string positionMessage(const std::string& id, float x, float y, const nlohmann::json& seq) {
+        nlohmann::json update = { {"id", id}, {"x", x}, {"y", y} };
+        if (!seq.is_null()) {
+            update["seq"] = seq;
+        }
+        return "POSITION " + update.dump();
+    }
+}
+
+// Start listening
+StubServer::StubServer(std::string name) :
+    listener(std::move(name)),
+    receiveBuffer(UDP_MAX_DATAGRAM)
+{
+}
+
+// One server frame
+void StubServer::update() {
+    auto now = Clock::now();
+
+    while (auto transport = listener.accept()) {
+        auto session = std::make_unique<Session>();
+        session->transport = std::move(transport);
+        sessions.push_back(std::move(session));
+    }
+
+    for (size_t i = 0; i < sessions.size(); i++) {
+        receive(*sessions[i], now);
+    }
+
+    // Closed sessions leave, and everyone else gets the shorter roster
+    auto closed = std::remove_if(sessions.begin(), sessions.end(),
+                                 [](const std::unique_ptr<Session>& session) { return session->closed; });
+    if (closed != sessions.end()) {
+        rosterChanged |= std::any_of(closed, sessions.end(),
+                                     [](const std::unique_ptr<Session>& session) { return !session->id.empty(); });
+        sessions.erase(closed, sessions.end());
+    }
+
+    // One roster per update however many joined or left, after their CONFIGs
+    if (rosterChanged) {
+        broadcastPlayers();
+        rosterChanged = false;
+    }
+
+    for (auto& session : sessions) {
+        send(*session, now);
+    }
+}
+
+// Handle everything a client sent since the last update
+void StubServer::receive(Session& session, Clock::time_point now) {
+    int received;
+    while ((received = session.transport->receiveStream(receiveBuffer.data(), receiveBuffer.size())) > 0) {
+        session.tcpBuffer.append(receiveBuffer.data(), received);
+    }
+    if (received == Transport::STREAM_CLOSED || received == Transport::STREAM_FAILED) {
+        session.closed = true;
+    }
+
+    size_t start = 0;
+    size_t end;
+    while ((end = session.tcpBuffer.find('\n', start)) != std::string::npos) {
+        handleMessage(session, std::string_view(session.tcpBuffer).substr(start, end - start), false);
+        start = end + 1;
+    }
+    session.tcpBuffer.erase(0, start);
+
+    std::vector<std::string_view> messages;
+    std::vector<std::string_view> delivered;
+    while ((received = session.transport->receiveDatagram(receiveBuffer.data(), receiveBuffer.size())) > 0) {
+        messages.clear();
+        session.udpReassembler.receive(std::string_view(receiveBuffer.data(), received), messages, now);
+
+        for (const auto& message : messages) {
+            if (!ReliableChannel::isChannelPacket(message)) {
+                handleMessage(session, message, false);
+                continue;
+            }
+            delivered.clear();
+            session.reliableChannel.receive(message, delivered, now);
+            for (const auto& reliableMessage : delivered) {
+                handleMessage(session, reliableMessage, true);
+            }
+        }
+    }
+    session.udpReassembler.expire(now);
+}
+
+// Dispatch one message by its command
+void StubServer::handleMessage(Session& session, std::string_view message, bool reliable) {
+    while (!message.empty() && (message.back() == '\r' || message.back() == '\n')) {
+        message.remove_suffix(1);
+    }
+
+    size_t space = message.find(' ');
+    std::string_view command = message.substr(0, space);
+    std::string_view payload = space == std::string_view::npos ? std::string_view() : message.substr(space + 1);
+
+    try {
+        if (command == "CONNECT") {
+            handleConnect(session, payload);
+        } else if (session.id.empty()) {
+            ignoredCount++;     // everything else needs a session
+            return;
+        } else if (command == "UDP_REGISTER" || command == "UDP_REG") {
+            handleUdpRegister(session, payload, reliable);
+        } else if (command == "POSITION") {
+            handlePosition(session, payload);
+        } else if (command == "CHAT") {
+            handleChat(session, payload);
+        } else if (command == "PING") {
+            handlePing(session, reliable);
+        } else if (command == "LOGOUT") {
+            session.closed = true;
+        } else {
+            ignoredCount++;
+            return;
+        }
+        handledCount++;
+    } catch (const std::exception& e) {
+        DEBUG_LOG("Bad " << command << " from " << (session.id.empty() ? "new client" : session.id) << ": " << e.what());
+        ignoredCount++;
+    }
+}
+
+// Create the player, answer with CONFIG and tell everyone who is here
+void StubServer::handleConnect(Session& session, std::string_view payload) {
+    if (!session.id.empty()) {
+        return;
+    }
+
+    auto request = nlohmann::json::parse(payload);
+    session.name = request.at("name").get<std::string>();
+    session.color = request.value("color", "#FF0000");
+
+    int number = nextPlayerNumber++;
+    session.id = "p" + std::to_string(number);
+    session.x = SPAWN_X + ((number - 1) % SPAWN_COLUMNS) * SPAWN_SPACING;
+    session.y = SPAWN_Y + ((number - 1) / SPAWN_COLUMNS) * SPAWN_SPACING;
+
+    nlohmann::json config = { {"id", session.id}, {"color", session.color}, {"mapId", "default"} };
+    session.tcpOutbound.push("CONFIG " + config.dump());
+    rosterChanged = true;
+}
+
+// Confirm the session's datagram channel
+void StubServer::handleUdpRegister(Session& session, std::string_view payload, bool reliable) {
+    auto request = nlohmann::json::parse(payload);
+    if (request.at("id").get<std::string>() != session.id) {
+        return;
+    }
+
+    session.udpRegistered = true;
+    nlohmann::json reply = { {"id", session.id} };
+    std::string message = "UDP_REGISTERED " + reply.dump();
+    if (reliable) {
+        session.reliableChannel.send(message, ReliableStream::CONTROL);
+    } else {
+        session.udpFramer.enqueue(std::move(message));
+    }
+}
+
+// Move the player and tell everyone; the spawn point went out with the roster
+void StubServer::handlePosition(Session& session, std::string_view payload) {
+    auto update = nlohmann::json::parse(payload);
+    session.x = update.at("x").get<float>();
+    session.y = update.at("y").get<float>();
+
+    broadcastUnreliable(positionMessage(session.id, session.x, session.y, update.value("seq", nlohmann::json())));
+}
+
+// Relay chat under the sender's name
+void StubServer::handleChat(Session& session, std::string_view payload) {
+    auto request = nlohmann::json::parse(payload);
+    nlohmann::json chat = { {"sender", session.name}, {"message", request.at("message").get<std::string>()} };
+    broadcastReliable("CHAT " + chat.dump(), ReliableStream::CHAT);
+}
+
+// Answer on the channel the ping came on
+void StubServer::handlePing(Session& session, bool reliable) {
+    if (reliable) {
+        session.reliableChannel.send("PONG", ReliableStream::PING);
+    } else {
+        session.tcpOutbound.push("PONG");
+    }
+}
+
+// The full roster, on one line, over TCP as the real server sends it
+void StubServer::broadcastPlayers() {
+    nlohmann::json players = nlohmann::json::array();
+    for (const auto& session : sessions) {
+        if (!session->id.empty() && !session->closed) {
+            players.push_back({ {"id", session->id}, {"name", session->name}, {"color", session->color},
+                                {"x", session->x}, {"y", session->y}, {"mapId", "default"} });
+        }
+    }
+
+    std::string message = "PLAYERS " + players.dump();
+    for (auto& session : sessions) {
+        if (!session->id.empty() && !session->closed) {
+            session->tcpOutbound.push(message);
+        }
+    }
+}
+
+// State everyone can afford to lose
+void StubServer::broadcastUnreliable(const std::string& message) {
+    for (auto& session : sessions) {
+        if (session->id.empty() || session->closed) {
+            continue;
+        }
+        if (session->udpRegistered) {
+            session->udpFramer.enqueue(message);
+        } else {
+            session->tcpOutbound.push(message);
+        }
+    }
+}
+
+// Messages that must arrive, in order within their stream
+void StubServer::broadcastReliable(const std::string& message, ReliableStream stream) {
+    for (auto& session : sessions) {
+        if (session->id.empty() || session->closed) {
+            continue;
+        }
+        if (session->udpRegistered) {
+            session->reliableChannel.send(message, stream);
+        } else {
+            session->tcpOutbound.push(message);
+        }
+    }
+}
+
+// Hand this frame's replies, retransmits and acknowledgements to the transport
+void StubServer::send(Session& session, Clock::time_point now) {
+    std::vector<std::string> packets;
+    session.reliableChannel.update(now, packets);
+    for (auto& packet : packets) {
+        session.udpFramer.enqueue(std::move(packet));
+    }
+
+    if (!session.udpFramer.empty()) {
+        std::vector<std::string> datagrams;
+        session.udpFramer.flush(datagrams);
+        for (const auto& datagram : datagrams) {
+            session.transport->sendDatagram(datagram);
+        }
+    }
+
+    session.transport->flushStream(session.tcpOutbound);
+}
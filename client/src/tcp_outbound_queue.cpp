@@ -0,0 +1,151 @@
+#include "tcp_outbound_queue.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+    #include <ws2tcpip.h>
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+#endif
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[TcpOutboundQueue] " << msg << std::endl
+
+namespace {
+    // Buffers per gathered write; POSIX guarantees at least 16 for IOV_MAX
+    const size_t MAX_SEGMENTS = 16;
+}
+
+// Constructor
+TcpOutboundQueue::TcpOutboundQueue(size_t maxQueuedBytes) :
+    maxQueuedBytes(maxQueuedBytes)
+{
+}
+
+// Queue one newline-framed message
+bool TcpOutboundQueue::push(const std::string& message) {
+    if (queuedBytes + message.size() + 1 > maxQueuedBytes) {
+        DEBUG_LOG("Outbound queue full (" << queuedBytes << " bytes), dropping message");
+        return false;
+    }
+
+    frames.emplace_back();
+    std::string& frame = frames.back();
+    frame.reserve(message.size() + 1);
+    frame.append(message);
+    frame.push_back('\n');
+    queuedBytes += frame.size();
+    return true;
+}
+
+// Hand the next whole message to the caller
+bool TcpOutboundQueue::popFront(std::string& message) {
+    if (frames.empty() || headOffset != 0) {
+        return false;
+    }
+
+    message = std::move(frames.front());
+    frames.pop_front();
+    queuedBytes -= message.size();
+    message.pop_back();
+    return true;
+}
+
+// Advance past bytes the kernel accepted
+void TcpOutboundQueue::consume(size_t bytes) {
+    queuedBytes -= bytes;
+
+    while (bytes > 0) {
+        size_t remaining = frames.front().size() - headOffset;
+        if (bytes < remaining) {
+            headOffset += bytes;
+            return;
+        }
+
+        bytes -= remaining;
+        frames.pop_front();
+        headOffset = 0;
+    }
+}
+
+// Write as much as the socket accepts without blocking
+TcpOutboundQueue::FlushResult TcpOutboundQueue::flush(socket_t socket) {
+    while (!frames.empty()) {
+        size_t segmentCount = std::min(frames.size(), MAX_SEGMENTS);
+        size_t requested = 0;
+
+#ifdef _WIN32
+        WSABUF buffers[MAX_SEGMENTS];
+        for (size_t i = 0; i < segmentCount; i++) {
+            size_t offset = (i == 0) ? headOffset : 0;
+            buffers[i].buf = const_cast<char*>(frames[i].data() + offset);
+            buffers[i].len = static_cast<ULONG>(frames[i].size() - offset);
+            requested += buffers[i].len;
+        }
+
+        DWORD sent = 0;
+        writeCalls++;
+        if (WSASend(socket, buffers, static_cast<DWORD>(segmentCount), &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+            int error = WSAGetLastError();
+            if (error == WSAEWOULDBLOCK) {
+                return FlushResult::PENDING;
+            }
+            DEBUG_LOG("TCP send error: " << error);
+            return FlushResult::FAILED;
+        }
+        size_t written = static_cast<size_t>(sent);
+#else
+        struct iovec buffers[MAX_SEGMENTS];
+        for (size_t i = 0; i < segmentCount; i++) {
+            size_t offset = (i == 0) ? headOffset : 0;
+            buffers[i].iov_base = const_cast<char*>(frames[i].data() + offset);
+            buffers[i].iov_len = frames[i].size() - offset;
+            requested += buffers[i].iov_len;
+        }
+
+        struct msghdr header {};
+        header.msg_iov = buffers;
+        header.msg_iovlen = segmentCount;
+
+        int flags = 0;
+#ifdef MSG_NOSIGNAL
+        // A reset peer must surface as an error here, not kill the process with SIGPIPE
+        flags |= MSG_NOSIGNAL;
+#endif
+
+        writeCalls++;
+        ssize_t result = sendmsg(socket, &header, flags);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return FlushResult::PENDING;
+            }
+            DEBUG_LOG("TCP send error: " << errno);
+            return FlushResult::FAILED;
+        }
+        size_t written = static_cast<size_t>(result);
+#endif
+
+        consume(written);
+
+        // A short write means the socket buffer is full; resume on the next flush
+        if (written < requested) {
+            partialWrites++;
+            return FlushResult::PENDING;
+        }
+    }
+
+    return FlushResult::DRAINED;
+}
+
+// Drop everything queued
+void TcpOutboundQueue::clear() {
+    frames.clear();
+    headOffset = 0;
+    queuedBytes = 0;
+}
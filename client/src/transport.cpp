@@ -0,0 +1,27 @@
+#include "transport.h"
+#include "inet_transport.h"
+#include "unix_transport.h"
+#include "loopback_transport.h"
+
+// Pick the transport for an address
+std::unique_ptr<Transport> Transport::create(const std::string& address, int tcpPort, int udpPort,
+                                             std::shared_ptr<IoBackend> io) {
+    if (address.compare(0, UNIX_ADDRESS_PREFIX.size(), UNIX_ADDRESS_PREFIX) == 0) {
+        return std::make_unique<UnixTransport>(address.substr(UNIX_ADDRESS_PREFIX.size()));
+    }
+    if (address.compare(0, LOOPBACK_ADDRESS_PREFIX.size(), LOOPBACK_ADDRESS_PREFIX) == 0) {
+        return std::make_unique<LoopbackTransport>(address.substr(LOOPBACK_ADDRESS_PREFIX.size()));
+    }
+    return std::make_unique<InetTransport>(address, tcpPort, udpPort, std::move(io));
+}
+
+// Set socket to non-blocking mode
+bool setSocketNonBlocking(socket_t socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return (ioctlsocket(socket, FIONBIO, &mode) == 0);
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return (fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1);
+#endif
+}
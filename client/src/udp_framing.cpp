@@ -0,0 +1,232 @@
+#include "udp_framing.h"
+#include <algorithm>
+#include <charconv>
+
+namespace {
+    constexpr std::string_view AGGREGATE_PREFIX = "AGG ";
+    constexpr std::string_view FRAGMENT_PREFIX = "FRAG ";
+
+    // "FRAG 65535 65535 65535 " is the longest fragment header
+    constexpr size_t FRAGMENT_HEADER_RESERVE = 24;
+
+    // Smallest budget that still leaves fragments a useful payload
+    constexpr size_t MIN_DATAGRAM_SIZE = 128;
+
+    size_t decimalDigits(size_t value) {
+        size_t digits = 1;
+        while (value >= 10) {
+            value /= 10;
+            digits++;
+        }
+        return digits;
+    }
+
+    // Parse a decimal number terminated by delimiter and advance past it
+    template <typename T>
+    bool parseField(std::string_view& text, char delimiter, T& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec != std::errc() || result.ptr == text.data() + text.size() || *result.ptr != delimiter) {
+            return false;
+        }
+        text.remove_prefix(static_cast<size_t>(result.ptr - text.data()) + 1);
+        return true;
+    }
+}
+
+UdpFramer::UdpFramer(size_t maxDatagramSize) {
+    setMaxDatagramSize(maxDatagramSize);
+}
+
+// Queue a message for the next flush
+void UdpFramer::enqueue(std::string message) {
+    queued.push_back(std::move(message));
+    messageCount++;
+}
+
+// Clamp the budget to what a datagram can carry
+void UdpFramer::setMaxDatagramSize(size_t size) {
+    maxDatagramSize = std::clamp(size, MIN_DATAGRAM_SIZE, UDP_MAX_DATAGRAM);
+}
+
+// Pack queued messages greedily, in order, into as few datagrams as fit the budget
+void UdpFramer::flush(std::vector<std::string>& datagrams) {
+    std::vector<std::string> batch;
+    size_t batchSize = AGGREGATE_PREFIX.size();
+
+    auto emitBatch = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+        if (batch.size() == 1) {
+            datagrams.push_back(std::move(batch.front()));
+        } else {
+            std::string datagram;
+            datagram.reserve(batchSize);
+            datagram.append(AGGREGATE_PREFIX);
+            for (const auto& message : batch) {
+                datagram.append(std::to_string(message.size())).append(1, ':').append(message);
+            }
+            datagrams.push_back(std::move(datagram));
+        }
+        datagramCount++;
+        batch.clear();
+        batchSize = AGGREGATE_PREFIX.size();
+    };
+
+    while (!queued.empty()) {
+        std::string message = std::move(queued.front());
+        queued.pop_front();
+
+        if (message.size() > maxDatagramSize) {
+            emitBatch();
+            fragment(message, datagrams);
+            continue;
+        }
+
+        size_t framedSize = decimalDigits(message.size()) + 1 + message.size();
+        if (!batch.empty() && batchSize + framedSize > maxDatagramSize) {
+            emitBatch();
+        }
+        batch.push_back(std::move(message));
+        batchSize += framedSize;
+    }
+    emitBatch();
+}
+
+// Split one oversized payload into FRAG datagrams
+void UdpFramer::fragment(const std::string& payload, std::vector<std::string>& datagrams) {
+    size_t partSize = maxDatagramSize - FRAGMENT_HEADER_RESERVE;
+    size_t count = (payload.size() + partSize - 1) / partSize;
+    uint16_t id = nextFragmentId++;
+
+    for (size_t index = 0; index < count; index++) {
+        std::string datagram;
+        datagram.reserve(maxDatagramSize);
+        datagram.append(FRAGMENT_PREFIX)
+                .append(std::to_string(id)).append(1, ' ')
+                .append(std::to_string(index)).append(1, ' ')
+                .append(std::to_string(count)).append(1, ' ')
+                .append(payload, index * partSize, partSize);
+        datagrams.push_back(std::move(datagram));
+        datagramCount++;
+    }
+    fragmentedCount++;
+}
+
+// Drop anything still queued
+void UdpFramer::reset() {
+    queued.clear();
+}
+
+UdpReassembler::UdpReassembler(size_t maxFragments, size_t maxPending, std::chrono::milliseconds timeout)
+    : maxFragments(maxFragments), maxPending(maxPending), timeout(timeout) {}
+
+// Decode one datagram
+void UdpReassembler::receive(std::string_view datagram, std::vector<std::string_view>& messages,
+                             Clock::time_point now) {
+    expire(now);
+    decode(datagram, messages, now, 0);
+}
+
+void UdpReassembler::decode(std::string_view datagram, std::vector<std::string_view>& messages,
+                            Clock::time_point now, int depth) {
+    if (datagram.compare(0, AGGREGATE_PREFIX.size(), AGGREGATE_PREFIX) == 0) {
+        if (!unpackAggregate(datagram.substr(AGGREGATE_PREFIX.size()), messages)) {
+            malformedCount++;
+        }
+        return;
+    }
+
+    if (datagram.compare(0, FRAGMENT_PREFIX.size(), FRAGMENT_PREFIX) == 0) {
+        // A reassembled payload is never itself fragmented
+        if (depth > 0) {
+            malformedCount++;
+            return;
+        }
+        addFragment(datagram.substr(FRAGMENT_PREFIX.size()), messages, now, depth);
+        return;
+    }
+
+    messages.push_back(datagram);
+}
+
+// Split "<length>:<message>..." into messages; stops at the first malformed entry
+bool UdpReassembler::unpackAggregate(std::string_view body, std::vector<std::string_view>& messages) {
+    while (!body.empty()) {
+        size_t length = 0;
+        if (!parseField(body, ':', length) || length > body.size()) {
+            return false;
+        }
+        messages.push_back(body.substr(0, length));
+        body.remove_prefix(length);
+    }
+    return true;
+}
+
+// Store one fragment and decode the payload once every part has arrived
+void UdpReassembler::addFragment(std::string_view body, std::vector<std::string_view>& messages,
+                                 Clock::time_point now, int depth) {
+    uint16_t id = 0;
+    size_t index = 0;
+    size_t count = 0;
+    if (!parseField(body, ' ', id) || !parseField(body, ' ', index) || !parseField(body, ' ', count) ||
+        count == 0 || count > maxFragments || index >= count || body.empty()) {
+        malformedCount++;
+        return;
+    }
+
+    auto it = pending.find(id);
+    if (it == pending.end()) {
+        // Make room by dropping the oldest partial payload
+        if (pending.size() >= maxPending) {
+            auto oldest = std::min_element(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+                return a.second.firstSeen < b.second.firstSeen;
+            });
+            pending.erase(oldest);
+            expiredCount++;
+        }
+        it = pending.emplace(id, PartialPayload{}).first;
+        it->second.parts.resize(count);
+        it->second.firstSeen = now;
+    } else if (it->second.parts.size() != count) {
+        // The id wrapped around to a new payload
+        it->second = PartialPayload{};
+        it->second.parts.resize(count);
+        it->second.firstSeen = now;
+    }
+
+    PartialPayload& partial = it->second;
+    if (!partial.parts[index].empty()) {
+        return; // duplicate
+    }
+    partial.parts[index] = std::string(body);
+    if (++partial.received < count) {
+        return;
+    }
+
+    // A reassembled payload never holds a FRAG, so one datagram completes at most one
+    reassembled.clear();
+    for (const auto& part : partial.parts) {
+        reassembled += part;
+    }
+    pending.erase(it);
+    decode(reassembled, messages, now, depth + 1);
+}
+
+// Drop partial payloads older than the timeout
+void UdpReassembler::expire(Clock::time_point now) {
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second.firstSeen > timeout) {
+            it = pending.erase(it);
+            expiredCount++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Drop all partial payloads
+void UdpReassembler::reset() {
+    pending.clear();
+    reassembled.clear();
+}
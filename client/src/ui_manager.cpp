@@ -121,34 +121,41 @@ void UIManager::drawConnectingScreen(const std::string& statusMsg) {
 }
 
 void UIManager::drawGameScreen(const Player& localPlayer, const std::unordered_map<std::string, Player>& players, 
-                              const char* nameInput, const std::vector<std::string>& chatMessages, 
+                              const Camera2D& camera, const char* nameInput, const std::vector<std::string>& chatMessages, 
                               const std::vector<std::string>& networkChatMsgs,
                               bool chatInputActive, const char* chatInput, const Rectangle& chatInputBox) {
-    // Draw all other players
+    // Players are drawn in world space
+    BeginMode2D(camera);
+    
+    // Draw all other players on our map
     for (const auto& [id, player] : players) {
-        if (!player.isActive) continue;
+        if (!player.isActive || player.mapId != localPlayer.mapId) continue;
         
-        DrawCircle(static_cast<int>(player.x), static_cast<int>(player.y), 
+        DrawCircle(static_cast<int>(player.renderX), static_cast<int>(player.renderY), 
                   player.radius, player.color);
         
         // Draw player name
         DrawText(player.name.c_str(), 
-                static_cast<int>(player.x - MeasureText(player.name.c_str(), 16)/2), 
-                static_cast<int>(player.y - player.radius - 20), 
+                static_cast<int>(player.renderX - MeasureText(player.name.c_str(), 16)/2), 
+                static_cast<int>(player.renderY - player.radius - 20), 
                 16, BLACK);
     }
     
     // Draw local player only if initial position was received
     if (localPlayer.initialPositionReceived) {
-        DrawCircle(static_cast<int>(localPlayer.x), static_cast<int>(localPlayer.y), 
+        DrawCircle(static_cast<int>(localPlayer.renderX), static_cast<int>(localPlayer.renderY), 
                   localPlayer.radius, localPlayer.color);
         
         // Draw local player name
         DrawText(nameInput, 
-                static_cast<int>(localPlayer.x - MeasureText(nameInput, 16)/2), 
-                static_cast<int>(localPlayer.y - localPlayer.radius - 20), 
+                static_cast<int>(localPlayer.renderX - MeasureText(nameInput, 16)/2), 
+                static_cast<int>(localPlayer.renderY - localPlayer.radius - 20), 
                 16, BLACK);
-    } else {
+    }
+    
+    EndMode2D();
+    
+    if (!localPlayer.initialPositionReceived) {
         // Draw waiting message if the position hasn't been received yet
         const char* waitMessage = "Waiting for server...";
         DrawText(waitMessage, 
@@ -219,4 +226,12 @@ void UIManager::drawDisconnectedScreen(const std::string& reason) {
     const char* instruction = "Press ENTER to return to menu";
     int instructionWidth = MeasureText(instruction, 20);
     DrawText(instruction, screenWidth / 2 - instructionWidth / 2, 300, 20, DARKBLUE);
-} 
\ No newline at end of file
+}
+
+void UIManager::drawReconnectingBanner(const std::string& statusMsg) {
+    // The world stays on screen underneath while the session is resumed
+    DrawRectangle(0, 40, screenWidth, 30, Fade(BLACK, 0.6f));
+    
+    int textWidth = MeasureText(statusMsg.c_str(), 18);
+    DrawText(statusMsg.c_str(), screenWidth / 2 - textWidth / 2, 46, 18, ORANGE);
+}
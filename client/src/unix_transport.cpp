@@ -0,0 +1,280 @@
+#include "unix_transport.h"
+#include "udp_framing.h"
+#include <iostream>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <sys/un.h>
+#endif
+
+// For debug logs
+#define DEBUG_LOG(msg) std::cout << "[UnixTransport] " << msg << std::endl
+
+namespace {
+    // Datagram bytes allowed to wait for the server before new datagrams are dropped
+    const size_t MAX_PENDING_DATAGRAM_BYTES = 256 * 1024;
+
+    // Bytes in a datagram's length prefix
+    const size_t LENGTH_PREFIX_BYTES = 4;
+
+    // How much one read from the datagram connection takes
+    const size_t DATAGRAM_READ_BYTES = 16 * 1024;
+
+#ifndef _WIN32
+    // Send flags that turn a closed peer into an error instead of SIGPIPE
+    int sendFlags() {
+#ifdef MSG_NOSIGNAL
+        return MSG_NOSIGNAL;
+#else
+        return 0;
+#endif
+    }
+
+    // Connect a non-blocking AF_UNIX stream socket and announce what it carries
+    socket_t connectChannel(const std::string& path, const char* hello) {
+        socket_t sock = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (sock == INVALID_SOCKET) {
+            return INVALID_SOCKET;
+        }
+
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+        struct sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.data(), path.size());
+
+        // Local connects complete or fail immediately, there is no handshake to wait for
+        if (::connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            DEBUG_LOG("Connect to " << path << " failed: errno " << errno);
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+
+        // The hello fits any fresh socket buffer, so it goes out whole before non-blocking mode
+        size_t helloLength = std::strlen(hello);
+        if (send(sock, hello, helloLength, sendFlags()) != static_cast<ssize_t>(helloLength) ||
+            !setSocketNonBlocking(sock)) {
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+
+        return sock;
+    }
+#endif
+}
+
+// Constructor
+UnixTransport::UnixTransport(std::string path) :
+    path(std::move(path))
+{
+}
+
+// Destructor
+UnixTransport::~UnixTransport() {
+    disconnect();
+}
+
+// Connect both channels
+bool UnixTransport::open() {
+    disconnect();
+    state = State::CONNECTING;
+    statusMessage = "Connecting to unix:" + path + "...";
+
+#ifdef _WIN32
+    fail("Unix socket addresses are not supported on this platform");
+    return false;
+#else
+    if (path.empty() || path.size() >= sizeof(sockaddr_un::sun_path)) {
+        fail("Invalid unix socket path");
+        return false;
+    }
+
+    streamSocket = connectChannel(path, "STREAM\n");
+    datagramSocket = streamSocket == INVALID_SOCKET ? INVALID_SOCKET : connectChannel(path, "DGRAM\n");
+    if (streamSocket == INVALID_SOCKET || datagramSocket == INVALID_SOCKET) {
+        fail("Connection to server failed");
+        return false;
+    }
+
+    state = State::CONNECTED;
+    statusMessage = "Connected to server";
+    return true;
+#endif
+}
+
+// Connecting finishes in open(), so there is nothing to drive
+Transport::State UnixTransport::poll() {
+    return state;
+}
+
+// Give up on connecting
+Transport::State UnixTransport::fail(const std::string& message) {
+    disconnect();
+    state = State::FAILED;
+    statusMessage = message;
+    return state;
+}
+
+// Close both connections
+void UnixTransport::disconnect() {
+    if (streamSocket != INVALID_SOCKET) {
+        closesocket(streamSocket);
+        streamSocket = INVALID_SOCKET;
+    }
+
+    if (datagramSocket != INVALID_SOCKET) {
+        closesocket(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+    }
+
+    datagramOutbound.clear();
+    datagramInbound.clear();
+}
+
+// Write as much of the queue as the socket takes
+TcpOutboundQueue::FlushResult UnixTransport::flushStream(TcpOutboundQueue& queue) {
+    if (streamSocket == INVALID_SOCKET) {
+        return TcpOutboundQueue::FlushResult::FAILED;
+    }
+    return queue.flush(streamSocket);
+}
+
+// Read whatever the stream connection has
+int UnixTransport::receiveStream(char* buffer, size_t size) {
+#ifdef _WIN32
+    return STREAM_FAILED;
+#else
+    if (streamSocket == INVALID_SOCKET) {
+        return STREAM_FAILED;
+    }
+
+    ssize_t bytesReceived = recv(streamSocket, buffer, size, 0);
+    if (bytesReceived > 0) {
+        return static_cast<int>(bytesReceived);
+    }
+    if (bytesReceived == 0) {
+        return STREAM_CLOSED;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return STREAM_EMPTY;
+    }
+
+    DEBUG_LOG("Stream receive error: " << errno);
+    return STREAM_FAILED;
+#endif
+}
+
+// Write pending datagram bytes; false once the connection is gone
+bool UnixTransport::flushDatagrams() {
+#ifdef _WIN32
+    return false;
+#else
+    while (!datagramOutbound.empty() && datagramSocket != INVALID_SOCKET) {
+        ssize_t sent = send(datagramSocket, datagramOutbound.data(), datagramOutbound.size(), sendFlags());
+        if (sent > 0) {
+            datagramOutbound.erase(0, static_cast<size_t>(sent));
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+
+        // The stream connection reports the disconnect; datagrams just stop
+        DEBUG_LOG("Datagram send error: " << errno);
+        closesocket(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+        datagramOutbound.clear();
+    }
+    return datagramSocket != INVALID_SOCKET;
+#endif
+}
+
+// Frame one datagram and send what the socket takes
+bool UnixTransport::sendDatagram(std::string_view datagram) {
+    if (datagramSocket == INVALID_SOCKET) {
+        return false;
+    }
+
+    // Like a full UDP socket buffer: the server is behind, so this one is lost
+    if (datagramOutbound.size() > MAX_PENDING_DATAGRAM_BYTES) {
+        return false;
+    }
+
+    uint32_t length = static_cast<uint32_t>(datagram.size());
+    char prefix[LENGTH_PREFIX_BYTES] = {
+        static_cast<char>(length >> 24),
+        static_cast<char>(length >> 16),
+        static_cast<char>(length >> 8),
+        static_cast<char>(length)
+    };
+    datagramOutbound.append(prefix, LENGTH_PREFIX_BYTES);
+    datagramOutbound.append(datagram.data(), datagram.size());
+
+    return flushDatagrams();
+}
+
+// Return the next whole datagram, reading more from the connection as needed
+int UnixTransport::receiveDatagram(char* buffer, size_t size) {
+#ifdef _WIN32
+    return 0;
+#else
+    // Leftovers from a short write go out whether or not anything new is sent
+    flushDatagrams();
+
+    while (true) {
+        if (datagramInbound.size() >= LENGTH_PREFIX_BYTES) {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(datagramInbound.data());
+            size_t length = (static_cast<size_t>(bytes[0]) << 24) | (static_cast<size_t>(bytes[1]) << 16) |
+                            (static_cast<size_t>(bytes[2]) << 8) | static_cast<size_t>(bytes[3]);
+
+            if (length > UDP_MAX_DATAGRAM) {
+                // Framing is lost; nothing after this can be trusted
+                DEBUG_LOG("Datagram length " << length << " out of range, closing datagram channel");
+                closesocket(datagramSocket);
+                datagramSocket = INVALID_SOCKET;
+                datagramInbound.clear();
+                return 0;
+            }
+
+            size_t frameBytes = LENGTH_PREFIX_BYTES + length;
+            if (datagramInbound.size() >= frameBytes) {
+                bool fits = length <= size;
+                if (fits) {
+                    std::memcpy(buffer, datagramInbound.data() + LENGTH_PREFIX_BYTES, length);
+                }
+                datagramInbound.erase(datagramInbound.begin(), datagramInbound.begin() + frameBytes);
+
+                // Like recvfrom with a short buffer: an oversized datagram is dropped
+                if (fits) {
+                    return static_cast<int>(length);
+                }
+                continue;
+            }
+        }
+
+        if (datagramSocket == INVALID_SOCKET) {
+            return 0;
+        }
+
+        size_t used = datagramInbound.size();
+        datagramInbound.resize(used + DATAGRAM_READ_BYTES);
+        ssize_t bytesReceived = recv(datagramSocket, datagramInbound.data() + used, DATAGRAM_READ_BYTES, 0);
+        datagramInbound.resize(used + (bytesReceived > 0 ? static_cast<size_t>(bytesReceived) : 0));
+
+        if (bytesReceived > 0) {
+            continue;
+        }
+        if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+
+        DEBUG_LOG("Datagram channel closed");
+        closesocket(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+        return 0;
+    }
+#endif
+}
@@ -0,0 +1,179 @@
+// Builds a packed asset archive (.gmpk) from files and directories.
+//
+//   asset_packer <output.gmpk> <file or directory>...
+//
+// Directories are walked recursively; each asset is named by its path relative to the
+// directory it was found under, with forward slashes (e.g. "sprites/player.png").
+
+#include "asset_format.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct PendingAsset {
+        std::string name;
+        fs::path path;
+        AssetType type = AssetType::RAW;
+        uint64_t nameHash = 0;
+    };
+
+    AssetType typeForExtension(std::string extension) {
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == ".png" || extension == ".bmp" || extension == ".qoi" ||
+            extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".gif") {
+            return AssetType::IMAGE;
+        }
+        if (extension == ".ttf" || extension == ".otf") {
+            return AssetType::FONT;
+        }
+        return AssetType::RAW;
+    }
+
+    void addAsset(std::vector<PendingAsset>& assets, const fs::path& path, const std::string& name) {
+        PendingAsset asset;
+        asset.name = name;
+        asset.path = path;
+        asset.type = typeForExtension(path.extension().string());
+        asset.nameHash = hashAssetName(asset.name);
+        assets.push_back(std::move(asset));
+    }
+
+    bool collect(std::vector<PendingAsset>& assets, const fs::path& input) {
+        std::error_code ec;
+        if (fs::is_regular_file(input, ec)) {
+            addAsset(assets, input, input.filename().generic_string());
+            return true;
+        }
+        if (!fs::is_directory(input, ec)) {
+            std::cerr << "Not a file or directory: " << input << std::endl;
+            return false;
+        }
+
+        for (const auto& item : fs::recursive_directory_iterator(input, ec)) {
+            if (item.is_regular_file()) {
+                addAsset(assets, item.path(), fs::relative(item.path(), input).generic_string());
+            }
+        }
+        return !ec;
+    }
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void writePadding(std::ofstream& out, uint64_t& position, uint64_t alignment) {
+        static const char zeros[ASSET_DATA_ALIGNMENT] = {};
+        uint64_t padded = alignUp(position, alignment);
+        out.write(zeros, static_cast<std::streamsize>(padded - position));
+        position = padded;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.gmpk> <file or directory>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<PendingAsset> assets;
+    for (int i = 2; i < argc; i++) {
+        if (!collect(assets, argv[i])) {
+            return 1;
+        }
+    }
+
+    // The client binary-searches the index by hash
+    std::sort(assets.begin(), assets.end(), [](const PendingAsset& a, const PendingAsset& b) {
+        return a.nameHash != b.nameHash ? a.nameHash < b.nameHash : a.name < b.name;
+    });
+
+    for (size_t i = 1; i < assets.size(); i++) {
+        if (assets[i].name == assets[i - 1].name) {
+            std::cerr << "Duplicate asset name: " << assets[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    // Lay out header, index, names, then aligned data
+    std::vector<AssetIndexEntry> index(assets.size());
+    uint64_t position = sizeof(AssetArchiveHeader) + index.size() * sizeof(AssetIndexEntry);
+
+    for (size_t i = 0; i < assets.size(); i++) {
+        index[i].nameHash = assets[i].nameHash;
+        index[i].nameOffset = position;
+        index[i].nameLength = static_cast<uint32_t>(assets[i].name.size());
+        index[i].type = assets[i].type;
+        position += assets[i].name.size();
+    }
+
+    for (size_t i = 0; i < assets.size(); i++) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(assets[i].path, ec);
+        if (ec) {
+            std::cerr << "Cannot read " << assets[i].path << ": " << ec.message() << std::endl;
+            return 1;
+        }
+        position = alignUp(position, ASSET_DATA_ALIGNMENT);
+        index[i].dataOffset = position;
+        index[i].dataSize = size;
+        position += size;
+    }
+
+    AssetArchiveHeader header{};
+    std::memcpy(header.magic, ASSET_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = static_cast<uint32_t>(index.size());
+    header.indexOffset = sizeof(AssetArchiveHeader);
+    header.fileSize = position;
+
+    std::ofstream out(argv[1], std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.data()),
+              static_cast<std::streamsize>(index.size() * sizeof(AssetIndexEntry)));
+    for (const auto& asset : assets) {
+        out.write(asset.name.data(), static_cast<std::streamsize>(asset.name.size()));
+    }
+
+    uint64_t written = sizeof(AssetArchiveHeader) + index.size() * sizeof(AssetIndexEntry);
+    for (const auto& asset : assets) {
+        written += asset.name.size();
+    }
+
+    std::vector<char> buffer;
+    for (size_t i = 0; i < assets.size(); i++) {
+        writePadding(out, written, ASSET_DATA_ALIGNMENT);
+
+        std::ifstream in(assets[i].path, std::ios::binary);
+        buffer.resize(static_cast<size_t>(index[i].dataSize));
+        if (!in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+            std::cerr << "Cannot read " << assets[i].path << std::endl;
+            return 1;
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        written += buffer.size();
+    }
+
+    if (!out.flush() || written != header.fileSize) {
+        std::cerr << "Failed writing " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << assets.size() << " assets into " << argv[1]
+              << " (" << header.fileSize << " bytes)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Runs many NetworkClients against an in-process StubServer on one thread, with no
+// sockets and no JVM, and reports where the client-side networking time goes.
+//
+//   loopback_bench [--clients N] [--frames N] [--chat-every N]
+//
+// Every client joins and registers its datagram channel, then each frame sends a
+// position update; every --chat-every frames one client also chats. Client logging is
+// silenced so that it does not dominate the timings.
+
+#include "io_backend.h"
+#include "network.h"
+#include "stub_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int clients = 8;
+        int frames = 200;
+        int chatEvery = 10;
+    };
+
+    bool parseOptions(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            int value = std::atoi(argv[++i]);
+            if (value <= 0) {
+                return false;
+            }
+            if (arg == "--clients") {
+                options.clients = value;
+            } else if (arg == "--frames") {
+                options.frames = value;
+            } else if (arg == "--chat-every") {
+                options.chatEvery = value;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double millisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Join and register the datagram channel
+    Task<void> runClient(NetworkClient& client, std::string address, int index, int& joined) {
+        std::string name = "bench" + std::to_string(index);
+        if (co_await client.connectAsync(address, 0, 0, name, "#00FF00")) {
+            joined++;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--clients N] [--frames N] [--chat-every N]" << std::endl;
+        return 1;
+    }
+
+    // The client logs every connection step; keep it out of the measurement. Without a
+    // buffer the stream fails every write unformatted; restoring one clears that.
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+
+    StubServer server;
+
+    // One backend for every client, as a load generator would share it, polled and
+    // submitted once per frame here; loopback connections never touch it
+    auto io = IoBackend::create(IoBackendKind::SELECT);
+
+    std::vector<std::unique_ptr<NetworkClient>> clients;
+    int joined = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < options.clients; i++) {
+        auto client = std::make_unique<NetworkClient>();
+        client->setIoBackend(io, true);
+        client->spawn(runClient(*client, server.getAddress(), i, joined));
+        clients.push_back(std::move(client));
+    }
+
+    // Frames until everyone is in, capped so a broken build cannot hang
+    int joinFrames = 0;
+    while (joined < options.clients && joinFrames < 1000) {
+        io->poll();
+        for (auto& client : clients) {
+            client->update();
+        }
+        io->submit();
+        server.update();
+        joinFrames++;
+    }
+    double joinMs = millisecondsSince(start);
+    if (joined < options.clients) {
+        std::cout.rdbuf(console);
+        std::cerr << "Only " << joined << " of " << options.clients << " clients joined" << std::endl;
+        return 1;
+    }
+
+    // Steady state
+    double clientMs = 0.0;
+    double serverMs = 0.0;
+    uint64_t handledBefore = server.getHandledCount();
+    for (int frame = 0; frame < options.frames; frame++) {
+        auto clientStart = Clock::now();
+        io->poll();
+        for (int i = 0; i < options.clients; i++) {
+            NetworkClient& client = *clients[i];
+            client.sendPositionUpdate(static_cast<float>(frame % 500 + 1), static_cast<float>(i + 1));
+            if (frame % options.chatEvery == 0 && i == frame / options.chatEvery % options.clients) {
+                client.sendChatMessage("hello from " + std::to_string(i));
+            }
+            client.update();
+        }
+        io->submit();
+        clientMs += millisecondsSince(clientStart);
+
+        auto serverStart = Clock::now();
+        server.update();
+        serverMs += millisecondsSince(serverStart);
+    }
+
+    std::cout.rdbuf(console);
+
+    uint64_t handled = server.getHandledCount() - handledBefore;
+    size_t peakBacklog = 0;
+    uint64_t deferredUpdates = 0;
+    for (const auto& client : clients) {
+        peakBacklog = std::max(peakBacklog, client->getInboundBacklog().getPeakMessages());
+        deferredUpdates += client->getDeferredUpdateCount();
+    }
+    std::cout << "clients:          " << options.clients << std::endl;
+    std::cout << "join:             " << joinMs << " ms over " << joinFrames << " frames" << std::endl;
+    std::cout << "frames:           " << options.frames << std::endl;
+    std::cout << "client time:      " << clientMs / options.frames << " ms/frame, "
+              << clientMs * 1000.0 / options.frames / options.clients << " us/client/frame" << std::endl;
+    std::cout << "server time:      " << serverMs / options.frames << " ms/frame" << std::endl;
+    std::cout << "server handled:   " << handled << " messages, "
+              << handled / ((clientMs + serverMs) / 1000.0) << " messages/s" << std::endl;
+    std::cout << "client backlog:   " << peakBacklog << " messages at most, "
+              << deferredUpdates << " updates over budget" << std::endl;
+    return 0;
+}
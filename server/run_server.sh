@@ -3,14 +3,16 @@
 # Default port settings
 TCP_PORT=9999
 UDP_PORT=9998
+UNIX_SOCKET=
 
 # Process command line arguments
-while getopts "t:u:" opt; do
+while getopts "t:u:x:" opt; do
   case $opt in
     t) TCP_PORT=$OPTARG ;;
     u) UDP_PORT=$OPTARG ;;
+    x) UNIX_SOCKET=$OPTARG ;;
     *) 
-      echo "Usage: $0 [-t tcp_port] [-u udp_port]"
+      echo "Usage: $0 [-t tcp_port] [-u udp_port] [-x unix_socket_path]"
       exit 1
       ;;
   esac
@@ -32,4 +34,4 @@ fi
 
 # Run the application using the generated start script
 echo "Running the server..."
-build/install/guildmaster-server/bin/guildmaster-server -DtcpPort=$TCP_PORT -DudpPort=$UDP_PORT 
\ No newline at end of file
+build/install/guildmaster-server/bin/guildmaster-server -DtcpPort=$TCP_PORT -DudpPort=$UDP_PORT ${UNIX_SOCKET:+-DunixSocket=$UNIX_SOCKET} 
\ No newline at end of file
@@ -1,5 +1,6 @@
 package com.guildmaster.server
 
+import com.guildmaster.server.network.DEFAULT_MAX_DATAGRAM_BYTES
 import mu.KotlinLogging
 import kotlin.concurrent.thread
 
@@ -17,11 +18,15 @@ fun main(args: Array<String>) {
     
     val tcpPort = System.getProperty("tcpPort")?.toIntOrNull() ?: DEFAULT_TCP_PORT
     val udpPort = System.getProperty("udpPort")?.toIntOrNull() ?: DEFAULT_UDP_PORT
+    val udpMtu = System.getProperty("udpMtu")?.toIntOrNull() ?: DEFAULT_MAX_DATAGRAM_BYTES
+    val unixSocket = System.getProperty("unixSocket")?.takeIf { it.isNotBlank() }
     
     Logger.info { "Using TCP port: $tcpPort" }
     Logger.info { "Using UDP port: $udpPort" }
+    Logger.info { "Using UDP datagram budget: $udpMtu bytes" }
+    unixSocket?.let { Logger.info { "Using unix socket: $it" } }
     
-    val server = GameServer(tcpPort, udpPort)
+    val server = GameServer(tcpPort, udpPort, udpMtu, unixSocket)
     server.start()
     
     Runtime.getRuntime().addShutdownHook(thread(start = false) {
@@ -3,8 +3,10 @@ package com.guildmaster.server
 import com.guildmaster.server.broadcast.Broadcaster
 import com.guildmaster.server.cli.CommandHandler
 import com.guildmaster.server.gameplay.GameService
+import com.guildmaster.server.network.DEFAULT_MAX_DATAGRAM_BYTES
 import com.guildmaster.server.network.TcpService
 import com.guildmaster.server.network.UdpService
+import com.guildmaster.server.network.UnixTransportService
 import com.guildmaster.server.session.SessionManager
 import java.util.concurrent.Executors
 import java.util.concurrent.TimeUnit
@@ -12,19 +14,27 @@ import java.util.concurrent.TimeUnit
 class GameServer(
     private val tcpPort: Int,
     private val udpPort: Int,
+    private val maxDatagramBytes: Int = DEFAULT_MAX_DATAGRAM_BYTES,
+    private val unixSocketPath: String? = null,
 ) {
     private val sessionManager = SessionManager()
     private val tcpService = TcpService(sessionManager, tcpPort)
     private val broadcaster = Broadcaster(sessionManager, tcpService)
-    private val udpService = UdpService(sessionManager, broadcaster, udpPort)
+    private val gameService = GameService(this)
+    private val udpService = UdpService(sessionManager, broadcaster, gameService, udpPort, maxDatagramBytes)
+    private val unixTransportService = unixSocketPath?.let { UnixTransportService(it, tcpService, udpService) }
     private val commandHandler = CommandHandler(this, sessionManager, broadcaster)
     private val executor = Executors.newSingleThreadScheduledExecutor()
-    private val gameService = GameService(this)
+
+    init {
+        tcpService.onSessionResumed = udpService::resync
+    }
 
     fun start() {
         try {
             tcpService.start()
             udpService.start()
+            unixTransportService?.start()
             startHeartbeat()
             commandHandler.start()
             Logger.info { "Server started on TCP port $tcpPort and UDP port $udpPort" }
@@ -47,6 +57,7 @@ class GameServer(
     fun stop() {
         Logger.info { "Stopping server..." }
         commandHandler.stop()
+        unixTransportService?.stop()
         tcpService.stop()
         udpService.stop()
         executor.shutdown()
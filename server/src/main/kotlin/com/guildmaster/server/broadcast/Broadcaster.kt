@@ -49,12 +49,12 @@ class Broadcaster(
         }
     }
 
-    fun broadcastPositionUpdate(playerId: String, position: Vector2f, mapId: String) {
+    fun broadcastPositionUpdate(playerId: String, position: Vector2f, mapId: String, seq: Int? = null) {
         sessionManager.getSessionByPlayerId(playerId).let { result ->
             when (result) {
                 is Response.Success -> {
                     val session = result.data
-                    val message = Protocol.createPositionUpdateMessage(playerId, position, mapId)
+                    val message = Protocol.createPositionUpdateMessage(playerId, position, mapId, seq)
                     broadcastToPlayer(session.player, message)
                 }
 
@@ -107,7 +107,12 @@ class Broadcaster(
                 is Response.Success -> {
                     val players = result.data.map { it.player }
                     val message = Protocol.createPlayersListMessage(players)
-                    broadcastToMap(mapId, message)
+                    // Sessions with a view rectangle get ENTER/LEAVE from InterestManager instead
+                    result.data.filter { it.viewRect == null }.forEach { session ->
+                        session.tcpAddress?.let { address ->
+                            tcpService.sendMessage(address, message)
+                        }
+                    }
                 }
 
                 is Response.Error -> {
@@ -0,0 +1,127 @@
+package com.guildmaster.server.broadcast
+
+import com.guildmaster.server.Logger
+import com.guildmaster.server.network.Protocol
+import com.guildmaster.server.session.PlayerSession
+import com.guildmaster.server.session.Response
+import com.guildmaster.server.session.SessionManager
+import com.guildmaster.server.session.ViewRect
+import java.util.concurrent.ConcurrentHashMap
+
+// Players stay visible until this far outside the view, so edge walkers don't flicker
+private const val LEAVE_MARGIN = 64f
+private const val MAX_VIEW_EXTENT = 4096f
+
+/**
+ * Delivery for interest events. ENTER and LEAVE must arrive; UPDATE may be dropped.
+ */
+interface InterestTransport {
+    fun sendReliable(session: PlayerSession, message: String)
+    fun sendUnreliable(session: PlayerSession, message: String)
+}
+
+/**
+ * Area-of-interest replication. Each client declares a view rectangle and is sent
+ * ENTER when a player comes into view, UPDATE while that player moves, and LEAVE
+ * when it goes, instead of the full roster of its map. Sessions that never declared
+ * a view keep receiving the legacy map-wide PLAYERS broadcasts.
+ */
+class InterestManager(
+    private val sessionManager: SessionManager,
+    private val transport: InterestTransport
+) {
+    // Viewers interested in each player, the reverse of PlayerSession.interestSet
+    private val observers = ConcurrentHashMap<String, MutableSet<String>>()
+
+    fun setView(viewer: PlayerSession, view: ViewRect) {
+        viewer.viewRect = view.clamped(MAX_VIEW_EXTENT)
+        refresh(viewer)
+    }
+
+    /**
+     * Recompute every viewer's interest set. Called periodically so players walking
+     * into a view are picked up without scanning viewers on each move.
+     */
+    fun refreshAll() {
+        when (val result = sessionManager.getAllSessions()) {
+            // Detached viewers keep the set they last saw until they resume and resync
+            is Response.Success -> result.data.filter { it.viewRect != null && !it.isDetached }.forEach(::refresh)
+            is Response.Error -> Logger.warn { "Failed to refresh interest: ${result.message}" }
+        }
+    }
+
+    /**
+     * Recompute one viewer's interest set and send the differences
+     */
+    fun refresh(viewer: PlayerSession) {
+        val view = viewer.viewRect ?: return
+        val nearby = when (val result = sessionManager.getSessionsInArea(viewer.player.mapId, view.expanded(LEAVE_MARGIN))) {
+            is Response.Success -> result.data
+            is Response.Error -> {
+                Logger.warn { "Failed to query interest area for ${viewer.player.id}: ${result.message}" }
+                return
+            }
+        }
+
+        synchronized(viewer) {
+            val nearbyIds = nearby.mapTo(HashSet()) { it.player.id }
+            viewer.interestSet.filter { it !in nearbyIds }.forEach { leave(viewer, it) }
+
+            nearby.forEach { other ->
+                val position = other.player.position
+                if (other.player.id !in viewer.interestSet && view.contains(position.x, position.y)) {
+                    enter(viewer, other)
+                }
+            }
+        }
+    }
+
+    /**
+     * Catch up a viewer that resumed after a dropped connection: ENTER and LEAVE for the
+     * players that came and went while it was away, then the current position of each
+     * player it kept, instead of the whole neighbourhood again.
+     */
+    fun resync(viewer: PlayerSession) {
+        val retained = viewer.interestSet.toSet()
+        refresh(viewer)
+
+        viewer.interestSet.filter { it in retained }.forEach { playerId ->
+            when (val result = sessionManager.getSessionByPlayerId(playerId)) {
+                is Response.Success -> transport.sendReliable(
+                    viewer, Protocol.createUpdateMessage(playerId, result.data.player.position)
+                )
+                is Response.Error -> leave(viewer, playerId)
+            }
+        }
+    }
+
+    /**
+     * Send a moved player's position to the viewers that currently see it
+     */
+    fun onPlayerMoved(mover: PlayerSession, seq: Int?) {
+        val viewerIds = observers[mover.player.id] ?: return
+        val message = Protocol.createUpdateMessage(mover.player.id, mover.player.position, seq)
+
+        viewerIds.forEach { viewerId ->
+            when (val result = sessionManager.getSessionByPlayerId(viewerId)) {
+                is Response.Success -> transport.sendUnreliable(result.data, message)
+                is Response.Error -> viewerIds.remove(viewerId)
+            }
+        }
+    }
+
+    private fun enter(viewer: PlayerSession, other: PlayerSession) {
+        viewer.interestSet.add(other.player.id)
+        observers.computeIfAbsent(other.player.id) { ConcurrentHashMap.newKeySet() }.add(viewer.player.id)
+        transport.sendReliable(viewer, Protocol.createEnterMessage(other.player))
+    }
+
+    private fun leave(viewer: PlayerSession, playerId: String) {
+        viewer.interestSet.remove(playerId)
+        observers.computeIfPresent(playerId) { _, viewers ->
+            viewers.remove(viewer.player.id)
+            if (viewers.isEmpty()) null else viewers
+        }
+        transport.sendReliable(viewer, Protocol.createLeaveMessage(playerId))
+    }
+}
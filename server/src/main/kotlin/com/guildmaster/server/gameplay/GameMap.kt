@@ -2,10 +2,24 @@ package com.guildmaster.server.gameplay
 
 import com.guildmaster.server.Logger
 import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.ConcurrentLinkedQueue
 
+private const val DEFAULT_MAP_CHUNKS = 64
+private const val TERRAIN_SCALE_TILES = 12
 
-class GameMap(val id: String) {
+// Generated chunks kept per map; older ones are dropped and regenerated on request
+private const val MAX_CACHED_CHUNKS = 256
+
+
+class GameMap(
+    val id: String,
+    val widthChunks: Int = DEFAULT_MAP_CHUNKS,
+    val heightChunks: Int = DEFAULT_MAP_CHUNKS
+) {
     private val players = ConcurrentHashMap<String, PlayerState>()
+    private val chunks = ConcurrentHashMap<Long, MapChunk>()
+    private val chunkOrder = ConcurrentLinkedQueue<Long>()
+    private val seed = id.hashCode()
     
     fun addPlayer(playerId: String) {
         players[playerId] = PlayerState()
@@ -41,6 +55,67 @@ class GameMap(val id: String) {
     fun getPlayerCount(): Int {
         return players.size
     }
+
+    /**
+     * Tiles of one chunk, generated on first request. Null outside the map. Generation
+     * is deterministic, so only the [MAX_CACHED_CHUNKS] most recently generated chunks
+     * are kept and the rest are generated again if asked for.
+     */
+    fun getChunk(cx: Int, cy: Int): MapChunk? {
+        if (cx !in 0 until widthChunks || cy !in 0 until heightChunks) {
+            return null
+        }
+        val key = (cx.toLong() shl 32) or (cy.toLong() and 0xFFFFFFFFL)
+        val chunk = chunks.computeIfAbsent(key) {
+            chunkOrder.add(key)
+            generateChunk(cx, cy)
+        }
+        while (chunks.size > MAX_CACHED_CHUNKS) {
+            val oldest = chunkOrder.poll() ?: break
+            chunks.remove(oldest)
+        }
+        return chunk
+    }
+
+    private fun generateChunk(cx: Int, cy: Int): MapChunk {
+        val tiles = ByteArray(CHUNK_SIZE_TILES * CHUNK_SIZE_TILES)
+        for (ty in 0 until CHUNK_SIZE_TILES) {
+            for (tx in 0 until CHUNK_SIZE_TILES) {
+                val height = terrainHeight(cx * CHUNK_SIZE_TILES + tx, cy * CHUNK_SIZE_TILES + ty)
+                tiles[ty * CHUNK_SIZE_TILES + tx] = when {
+                    height < 0.30f -> TileType.WATER
+                    height < 0.36f -> TileType.SAND
+                    height < 0.70f -> TileType.GRASS
+                    height < 0.82f -> TileType.DIRT
+                    else -> TileType.STONE
+                }
+            }
+        }
+        return MapChunk(cx, cy, tiles)
+    }
+
+    // Smoothed value noise, so the same map id always produces the same world
+    private fun terrainHeight(tileX: Int, tileY: Int): Float {
+        val gx = Math.floorDiv(tileX, TERRAIN_SCALE_TILES)
+        val gy = Math.floorDiv(tileY, TERRAIN_SCALE_TILES)
+        val fx = smooth((tileX - gx * TERRAIN_SCALE_TILES) / TERRAIN_SCALE_TILES.toFloat())
+        val fy = smooth((tileY - gy * TERRAIN_SCALE_TILES) / TERRAIN_SCALE_TILES.toFloat())
+
+        val top = lerp(latticeValue(gx, gy), latticeValue(gx + 1, gy), fx)
+        val bottom = lerp(latticeValue(gx, gy + 1), latticeValue(gx + 1, gy + 1), fx)
+        return lerp(top, bottom, fy)
+    }
+
+    private fun latticeValue(x: Int, y: Int): Float {
+        var h = seed xor (x * 374761393) xor (y * 668265263)
+        h = (h xor (h ushr 13)) * 1274126177
+        h = h xor (h ushr 16)
+        return (h and 0xFFFF) / 65535f
+    }
+
+    private fun smooth(t: Float): Float = t * t * (3f - 2f * t)
+
+    private fun lerp(a: Float, b: Float, t: Float): Float = a + (b - a) * t
 }
 
 data class PlayerState(
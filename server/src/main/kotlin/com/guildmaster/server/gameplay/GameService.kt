@@ -3,12 +3,23 @@ package com.guildmaster.server.gameplay
 import com.guildmaster.server.GameServer
 import com.guildmaster.server.Logger
 import com.guildmaster.server.session.Response
-import java.util.concurrent.ConcurrentHashMap
+import java.util.Collections
 
+// Maps kept loaded; the least recently used is dropped past this and rebuilt on demand
+private const val MAX_LOADED_MAPS = 32
 
 
 class GameService(private val server: GameServer) {
-    private val maps = ConcurrentHashMap<String, GameMap>()
+    /**
+     * Loaded maps, least recently used first. A map is only its generated terrain,
+     * which its id determines, so dropping one loses nothing.
+     */
+    private val maps: MutableMap<String, GameMap> = Collections.synchronizedMap(
+        object : LinkedHashMap<String, GameMap>(16, 0.75f, true) {
+            override fun removeEldestEntry(eldest: MutableMap.MutableEntry<String, GameMap>): Boolean =
+                size > MAX_LOADED_MAPS
+        }
+    )
     
     fun createMap(id: String): Response<GameMap> {
         return try {
@@ -21,6 +32,15 @@ class GameService(private val server: GameServer) {
         }
     }
     
+    fun getOrCreateMap(id: String): Response<GameMap> {
+        return try {
+            Response.Success(maps.computeIfAbsent(id) { GameMap(it) })
+        } catch (e: Exception) {
+            Logger.error(e) { "Failed to get or create map $id" }
+            Response.Error("Failed to get or create map")
+        }
+    }
+
     fun getMap(id: String): Response<GameMap> {
         return maps[id]?.let { Response.Success(it) }
             ?: Response.Error("Map not found")
@@ -38,7 +58,7 @@ class GameService(private val server: GameServer) {
     
     fun getAllMaps(): Response<List<GameMap>> {
         return try {
-            Response.Success(maps.values.toList())
+            Response.Success(synchronized(maps) { maps.values.toList() })
         } catch (e: Exception) {
             Logger.error(e) { "Failed to get all maps" }
             Response.Error("Failed to get all maps")
@@ -0,0 +1,21 @@
+package com.guildmaster.server.gameplay
+
+const val CHUNK_SIZE_TILES = 32
+const val TILE_SIZE_PIXELS = 32
+
+/**
+ * Tile ids understood by the client's chunk renderer
+ */
+object TileType {
+    const val GRASS: Byte = 0
+    const val DIRT: Byte = 1
+    const val WATER: Byte = 2
+    const val STONE: Byte = 3
+    const val SAND: Byte = 4
+}
+
+/**
+ * A CHUNK_SIZE_TILES square block of a map's tiles, stored row-major.
+ * Clients stream chunks around their camera instead of loading whole maps.
+ */
+class MapChunk(val cx: Int, val cy: Int, val tiles: ByteArray)
@@ -0,0 +1,57 @@
+package com.guildmaster.server.gameplay
+
+import org.joml.Vector2f
+
+// Must match the client's Player defaults, or prediction drifts from the server
+private const val PLAYER_SPEED = 200f
+private const val PLAYER_RADIUS = 20f
+
+// Longest tick a client may claim, so a bogus dt can't teleport a player
+private const val MAX_INPUT_DT = 0.1f
+
+// Most ticks one INPUT may carry; the client's unacknowledged input history holds as many
+const val MAX_INPUT_TICKS = 128
+
+/**
+ * Movement buttons held during one client simulation tick
+ */
+object InputButtons {
+    const val UP = 1
+    const val DOWN = 2
+    const val LEFT = 4
+    const val RIGHT = 8
+}
+
+/**
+ * Server-side simulation of client inputs
+ */
+object Movement {
+    /**
+     * Apply [moves], one hex digit of [InputButtons] per tick, starting at [position].
+     * Returns the new position, kept inside the map.
+     */
+    fun applyMoves(position: Vector2f, moves: CharSequence, dt: Float, map: GameMap): Vector2f {
+        val step = PLAYER_SPEED * tickSeconds(dt)
+        val maxX = map.widthChunks * CHUNK_SIZE_TILES * TILE_SIZE_PIXELS - PLAYER_RADIUS
+        val maxY = map.heightChunks * CHUNK_SIZE_TILES * TILE_SIZE_PIXELS - PLAYER_RADIUS
+        var x = position.x
+        var y = position.y
+
+        for (move in moves) {
+            val buttons = Character.digit(move, 16)
+            if (buttons < 0) continue
+            if (buttons and InputButtons.UP != 0) y -= step
+            if (buttons and InputButtons.DOWN != 0) y += step
+            if (buttons and InputButtons.LEFT != 0) x -= step
+            if (buttons and InputButtons.RIGHT != 0) x += step
+            x = x.coerceIn(PLAYER_RADIUS, maxX)
+            y = y.coerceIn(PLAYER_RADIUS, maxY)
+        }
+        return Vector2f(x, y)
+    }
+
+    /**
+     * Length of one tick as simulated, from the one the client claims
+     */
+    fun tickSeconds(dt: Float): Float = dt.coerceIn(0f, MAX_INPUT_DT)
+}
@@ -1,13 +1,18 @@
 package com.guildmaster.server.network
 
+import com.guildmaster.server.gameplay.CHUNK_SIZE_TILES
+import com.guildmaster.server.gameplay.GameMap
+import com.guildmaster.server.gameplay.TILE_SIZE_PIXELS
 import com.guildmaster.server.player.Player
 import com.guildmaster.server.serialization.Vector2fSerializer
 import kotlinx.serialization.Contextual
+import kotlinx.serialization.SerialName
 import kotlinx.serialization.Serializable
 import kotlinx.serialization.encodeToString
 import kotlinx.serialization.json.Json
 import kotlinx.serialization.modules.contextual
 import org.joml.Vector2f
+import java.util.Base64
 
 /**
  * Protocol definitions and message handling for client-server communication.
@@ -22,6 +27,11 @@ object Protocol {
         }
     }
 
+    // Single-line serializer for messages framed by newlines or datagrams
+    val wireJson = Json(json) {
+        prettyPrint = false
+    }
+
     // Message types
     const val MSG_CONNECT = "CONNECT"
     const val MSG_CONFIG = "CONFIG"
@@ -30,8 +40,16 @@ object Protocol {
     const val MSG_PLAYERS = "PLAYERS"
     const val MSG_MAP = "MAP"
     const val MSG_UDP_REG = "UDP_REG"
+    const val MSG_UDP_REGISTERED = "UDP_REGISTERED"
     const val MSG_PONG = "PONG"
     const val MSG_LOGIN_SUCCESS = "MSG_LOGIN_SUCCESS"
+    const val MSG_ENTER = "ENTER"
+    const val MSG_LEAVE = "LEAVE"
+    const val MSG_UPDATE = "UPDATE"
+    const val MSG_CHUNK = "CHUNK"
+    const val MSG_INPUT_ACK = "INPUT_ACK"
+    const val MSG_RESUMED = "RESUMED"
+    const val MSG_RESUME_FAILED = "RESUME_FAILED"
 
     // Command types
     const val CMD_CONNECT = "CONNECT"
@@ -43,6 +61,12 @@ object Protocol {
     const val CMD_LOGIN = "LOGIN"
     const val CMD_PING = "PING"
     const val CMD_UDP_REGISTER = "UDP_REG"
+    const val CMD_MAP_CHANGE = "MAP_CHANGE"
+    const val CMD_VIEW = "VIEW"
+    const val CMD_CHUNK_REQ = "CHUNK_REQ"
+    const val CMD_INPUT = "INPUT"
+    const val CMD_RESUME = "RESUME"
+    const val CMD_LOGOUT = "LOGOUT"
 
     // Message classes
     @Serializable
@@ -51,16 +75,28 @@ object Protocol {
     @Serializable
     data class ConfigMessage(
         val id: String,
-        val udpPort: Int,
+        val udpPort: Int? = null,
         val color: String? = null,
-        val mapId: String? = null
+        val mapId: String? = null,
+        // Presented in RESUME to take the session back after a dropped connection
+        val resume: String? = null
     )
 
+    @Serializable
+    data class ResumeRequest(val id: String, val token: String)
+
+    @Serializable
+    data class ResumedMessage(val id: String)
+
+    @Serializable
+    data class ResumeFailedMessage(val reason: String)
+
     @Serializable
     data class PositionMessage(
         val playerId: String? = null,
         @Contextual val position: Vector2f,
-        val mapId: String
+        val mapId: String,
+        val seq: Int? = null
     )
 
     @Serializable
@@ -75,6 +111,55 @@ object Protocol {
     @Serializable
     data class MapChangeMessage(val mapId: String, val playerIds: List<String>)
 
+    @Serializable
+    data class ChatRequest(val message: String)
+
+    @Serializable
+    data class ChatBroadcast(val sender: String, val message: String)
+
+    @Serializable
+    data class MapChangeRequest(@SerialName("map_id") val mapId: String)
+
+    @Serializable
+    data class ViewRequest(val x: Float, val y: Float, val width: Float, val height: Float)
+
+    @Serializable
+    data class LeaveMessage(val id: String)
+
+    @Serializable
+    data class UpdateMessage(val id: String, val x: Float, val y: Float, val seq: Int? = null)
+
+    // The client's unacknowledged input ticks, one hex digit each, oldest first and ending at seq
+    @Serializable
+    data class InputMessage(val seq: Int, val dt: Float, val moves: String, val id: String? = null, val t: Long? = null)
+
+    // t echoes the client's sample time; srv is how long the server held the INPUT, in microseconds;
+    // x and y are the player's position after tick seq, for the client to reconcile against
+    @Serializable
+    data class InputAck(
+        val seq: Int,
+        val t: Long? = null,
+        val srv: Long? = null,
+        val x: Float? = null,
+        val y: Float? = null
+    )
+
+    @Serializable
+    data class ChunkRequest(val mapId: String, val cx: Int, val cy: Int)
+
+    // Tiles are base64 of size * size tile ids, row-major; empty for chunks outside the map
+    @Serializable
+    data class ChunkMessage(
+        val mapId: String,
+        val cx: Int,
+        val cy: Int,
+        val size: Int,
+        val tileSize: Int,
+        val mapWidth: Int,
+        val mapHeight: Int,
+        val tiles: String
+    )
+
     @Serializable
     data class LoginMessage(val player: Player)
 
@@ -122,6 +207,55 @@ object Protocol {
     fun encodeMapChangeMessage(message: MapChangeMessage): String =
         "$CMD_MAP ${json.encodeToString(MapChangeMessage.serializer(), message)}"
 
+    // Chat as the client expects it: {"sender": ..., "message": ...} on a single line
+    fun encodeChatBroadcast(sender: String, message: String): String =
+        wireJson.encodeToString(ChatBroadcast.serializer(), ChatBroadcast(sender, message))
+
+    // Session handshake: the new player's id and resume token, and the outcome of a resume
+    fun createConfigMessage(player: Player, resumeToken: String): String =
+        "$MSG_CONFIG ${wireJson.encodeToString(ConfigMessage.serializer(),
+            ConfigMessage(id = player.id, color = player.color, mapId = player.mapId, resume = resumeToken))}"
+
+    fun createResumedMessage(playerId: String): String =
+        "$MSG_RESUMED ${wireJson.encodeToString(ResumedMessage.serializer(), ResumedMessage(playerId))}"
+
+    fun createResumeFailedMessage(reason: String): String =
+        "$MSG_RESUME_FAILED ${wireJson.encodeToString(ResumeFailedMessage.serializer(), ResumeFailedMessage(reason))}"
+
+    // Interest events: a player came into view, left it, or moved while in view
+    fun createEnterMessage(player: Player): String =
+        "$MSG_ENTER ${wireJson.encodeToString(PlayerInfo.serializer(), PlayerInfo.fromPlayer(player))}"
+
+    fun createLeaveMessage(playerId: String): String =
+        "$MSG_LEAVE ${wireJson.encodeToString(LeaveMessage.serializer(), LeaveMessage(playerId))}"
+
+    fun createUpdateMessage(playerId: String, position: Vector2f, seq: Int? = null): String =
+        "$MSG_UPDATE ${wireJson.encodeToString(UpdateMessage.serializer(), UpdateMessage(playerId, position.x, position.y, seq))}"
+
+    fun createInputAckMessage(
+        seq: Int,
+        echoedTime: Long? = null,
+        serverMicros: Long? = null,
+        position: Vector2f? = null
+    ): String =
+        "$MSG_INPUT_ACK ${wireJson.encodeToString(InputAck.serializer(),
+            InputAck(seq, echoedTime, serverMicros, position?.x, position?.y))}"
+
+    fun createChunkMessage(map: GameMap, cx: Int, cy: Int): String {
+        val tiles = map.getChunk(cx, cy)?.let { Base64.getEncoder().encodeToString(it.tiles) } ?: ""
+        val message = ChunkMessage(
+            mapId = map.id,
+            cx = cx,
+            cy = cy,
+            size = CHUNK_SIZE_TILES,
+            tileSize = TILE_SIZE_PIXELS,
+            mapWidth = map.widthChunks,
+            mapHeight = map.heightChunks,
+            tiles = tiles
+        )
+        return "$MSG_CHUNK ${wireJson.encodeToString(ChunkMessage.serializer(), message)}"
+    }
+
     // Function to create player list message
     fun createPlayersListMessage(players: List<Player>): String {
         return buildString {
@@ -131,10 +265,10 @@ object Protocol {
         }
     }
 
-    fun createPositionUpdateMessage(playerId: String, position: Vector2f, mapId: String): String {
+    fun createPositionUpdateMessage(playerId: String, position: Vector2f, mapId: String, seq: Int? = null): String {
         return buildString {
             append("POS_UPDATE ")
-            append(json.encodeToString(PositionMessage(playerId, position, mapId)))
+            append(wireJson.encodeToString(PositionMessage(playerId, position, mapId, seq)))
             append("\n")
         }
     }
@@ -0,0 +1,269 @@
+package com.guildmaster.server.network
+
+import com.guildmaster.server.Logger
+
+private const val MIN_RTO_MS = 100.0
+private const val MAX_RTO_MS = 2000.0
+private const val INITIAL_RTO_MS = 250.0
+private const val CLOCK_GRANULARITY_MS = 10.0
+private const val ACK_WINDOW = 32
+private const val UINT32_MASK = 0xFFFFFFFFL
+
+// Body of a packet that fills an abandoned stream slot; no message is a bare "~SKIP"
+private const val SKIP_MESSAGE = "~SKIP"
+
+/**
+ * Must-arrive, per-stream ordered message layer over UDP, the server side of the
+ * client's ReliableChannel.
+ *
+ * Wire format:
+ *   REL <seq> <ack> <ackBits> <stream> <streamSeq> <message>
+ *   ACK <ack> <ackBits>
+ *   REL <seq> <ack> <ackBits> <stream> <streamSeq> ~SKIP
+ *
+ * Bit i of ackBits acknowledges packet sequence (ack - 1 - i). Messages are retransmitted
+ * on an RTT-based timer and given up on after [maxTransmissions], but their stream slot
+ * is not: the same packet is retransmitted as a ~SKIP marker until acknowledged, which
+ * moves the receiver past it without delivering anything. streamSeq orders messages
+ * within a stream, so a loss only holds back later messages of the same stream, and
+ * never for good.
+ */
+class ReliableUdpChannel(
+    windowSize: Int = ACK_WINDOW,
+    private val maxTransmissions: Int = 10
+) {
+    private class StreamMessage(val stream: Int, val streamSequence: Int, val message: String)
+
+    private class PendingMessage(
+        val sequence: Int,
+        var payload: StreamMessage,
+        var lastSentMs: Long,
+        var transmissions: Int,
+        var abandoned: Boolean = false
+    )
+
+    private val windowSize = windowSize.coerceAtMost(ACK_WINDOW)
+    private val queued = ArrayDeque<StreamMessage>()
+    private val inFlight = ArrayDeque<PendingMessage>()
+
+    private var nextSequence = 0
+    private val nextStreamSequence = IntArray(STREAM_COUNT)
+
+    // Per-stream receive ordering
+    private val expectedStreamSequence = IntArray(STREAM_COUNT)
+    private val bufferedStreamMessages = Array(STREAM_COUNT) { HashMap<Int, String>() }
+
+    private var hasRemoteSequence = false
+    private var remoteSequence = 0
+    private var remoteAckBits = 0L
+    private var ackPending = false
+
+    private var hasRttSample = false
+    private var smoothedRttMs = 0.0
+    private var rttVarianceMs = 0.0
+
+    var retransmitTimeoutMs = INITIAL_RTO_MS
+        private set
+
+    var lastActivityMs = System.currentTimeMillis()
+        private set
+
+    /**
+     * Queue a message for reliable, in-order delivery on a stream
+     */
+    @Synchronized
+    fun send(message: String, stream: Int = STREAM_CONTROL) {
+        val streamSequence = nextStreamSequence[stream]
+        nextStreamSequence[stream] = (streamSequence + 1) and 0xFFFF
+        queued.addLast(StreamMessage(stream, streamSequence, message))
+    }
+
+    /**
+     * Handle an inbound datagram. Returns null if it is not a channel packet,
+     * otherwise the newly received messages (possibly none).
+     */
+    @Synchronized
+    fun receive(datagram: String, nowMs: Long = System.currentTimeMillis()): List<String>? {
+        if (!isChannelPacket(datagram)) return null
+        lastActivityMs = nowMs
+
+        val parts = datagram.split(' ', limit = 7)
+        if (parts[0] == "ACK") {
+            val ack = parts.getOrNull(1)?.toIntOrNull()
+            val ackBits = parts.getOrNull(2)?.toLongOrNull()
+            if (ack != null && ackBits != null) {
+                processAcks(ack, ackBits, nowMs)
+            }
+            return emptyList()
+        }
+
+        val sequence = parts.getOrNull(1)?.toIntOrNull()
+        val ack = parts.getOrNull(2)?.toIntOrNull()
+        val ackBits = parts.getOrNull(3)?.toLongOrNull()
+        val stream = parts.getOrNull(4)?.toIntOrNull()
+        val streamSequence = parts.getOrNull(5)?.toIntOrNull()
+        if (sequence == null || ack == null || ackBits == null || stream == null || streamSequence == null ||
+            stream !in 0 until STREAM_COUNT || parts.size < 7
+        ) {
+            Logger.warn { "Malformed reliable packet: $datagram" }
+            return emptyList()
+        }
+
+        processAcks(ack, ackBits, nowMs)
+
+        // Always acknowledge, even duplicates, since our previous ack may have been lost
+        ackPending = true
+        if (!recordReceived(sequence and 0xFFFF)) return emptyList()
+
+        return deliverInOrder(stream, streamSequence and 0xFFFF, parts[6])
+    }
+
+    /**
+     * Packets due now: retransmits, new sends and a standalone ack if nothing carried it
+     */
+    @Synchronized
+    fun update(nowMs: Long = System.currentTimeMillis()): List<String> {
+        val outgoing = mutableListOf<String>()
+        var ackSent = false
+
+        val iterator = inFlight.iterator()
+        while (iterator.hasNext()) {
+            val pending = iterator.next()
+            val backoff = 1 shl (pending.transmissions - 1).coerceAtMost(4)
+            val timeoutMs = (retransmitTimeoutMs * backoff).coerceAtMost(MAX_RTO_MS)
+            if (nowMs - pending.lastSentMs < timeoutMs) continue
+
+            // The message is lost, but its stream slot still has to be filled
+            if (!pending.abandoned && pending.transmissions >= maxTransmissions) {
+                Logger.warn { "Giving up on reliable message ${pending.sequence}: ${pending.payload.message}" }
+                pending.payload = StreamMessage(pending.payload.stream, pending.payload.streamSequence, SKIP_MESSAGE)
+                pending.abandoned = true
+            }
+
+            outgoing.add(buildPacket(pending.sequence, pending.payload))
+            pending.lastSentMs = nowMs
+            pending.transmissions++
+            ackSent = true
+        }
+
+        // The window bounds the sequence span in flight so the oldest message stays ackable
+        while (queued.isNotEmpty() &&
+            (inFlight.isEmpty() || ((nextSequence - inFlight.first().sequence) and 0xFFFF) < windowSize)
+        ) {
+            val pending = PendingMessage(nextSequence, queued.removeFirst(), nowMs, 1)
+            nextSequence = (nextSequence + 1) and 0xFFFF
+            outgoing.add(buildPacket(pending.sequence, pending.payload))
+            inFlight.addLast(pending)
+            ackSent = true
+        }
+
+        if (ackPending && !ackSent && hasRemoteSequence) {
+            outgoing.add("ACK $remoteSequence $remoteAckBits")
+        }
+        ackPending = false
+
+        return outgoing
+    }
+
+    private fun buildPacket(sequence: Int, payload: StreamMessage): String =
+        "REL $sequence $remoteSequence $remoteAckBits ${payload.stream} ${payload.streamSequence} ${payload.message}"
+
+    private fun deliverInOrder(stream: Int, streamSequence: Int, message: String): List<String> {
+        val expected = expectedStreamSequence[stream]
+        val buffered = bufferedStreamMessages[stream]
+
+        if (streamSequence != expected) {
+            if (SequenceNumbers.isNewer(streamSequence, expected)) {
+                buffered[streamSequence] = message
+            }
+            return emptyList()
+        }
+
+        // A skip marker takes its slot in the order but delivers nothing
+        val delivered = mutableListOf<String>()
+        if (message != SKIP_MESSAGE) delivered.add(message)
+
+        // Release anything that was waiting on this message
+        var next = (expected + 1) and 0xFFFF
+        while (true) {
+            val waiting = buffered.remove(next) ?: break
+            if (waiting != SKIP_MESSAGE) delivered.add(waiting)
+            next = (next + 1) and 0xFFFF
+        }
+        expectedStreamSequence[stream] = next
+        return delivered
+    }
+
+    private fun processAcks(ack: Int, ackBits: Long, nowMs: Long) {
+        val iterator = inFlight.iterator()
+        while (iterator.hasNext()) {
+            val pending = iterator.next()
+            val age = (ack - pending.sequence) and 0xFFFF
+            val acknowledged = age == 0 ||
+                (age in 1..ACK_WINDOW && ((ackBits shr (age - 1)) and 1L) == 1L)
+            if (!acknowledged) continue
+
+            // Karn's rule: only unambiguous samples update the estimate
+            if (pending.transmissions == 1) {
+                addRttSample((nowMs - pending.lastSentMs).toDouble())
+            }
+            iterator.remove()
+        }
+    }
+
+    private fun recordReceived(sequence: Int): Boolean {
+        if (!hasRemoteSequence) {
+            hasRemoteSequence = true
+            remoteSequence = sequence
+            remoteAckBits = 0L
+            return true
+        }
+
+        if (sequence == remoteSequence) return false
+
+        if (SequenceNumbers.isNewer(sequence, remoteSequence)) {
+            val shift = (sequence - remoteSequence) and 0xFFFF
+            var shifted = if (shift >= ACK_WINDOW) 0L else (remoteAckBits shl shift) and UINT32_MASK
+            if (shift <= ACK_WINDOW) {
+                shifted = shifted or (1L shl (shift - 1))
+            }
+            remoteAckBits = shifted
+            remoteSequence = sequence
+            return true
+        }
+
+        // Older than the ack window: the sender's window guarantees it is a duplicate
+        val age = (remoteSequence - sequence) and 0xFFFF
+        if (age > ACK_WINDOW) return false
+
+        val bit = 1L shl (age - 1)
+        if ((remoteAckBits and bit) != 0L) return false
+
+        remoteAckBits = remoteAckBits or bit
+        return true
+    }
+
+    private fun addRttSample(sampleMs: Double) {
+        if (!hasRttSample) {
+            hasRttSample = true
+            smoothedRttMs = sampleMs
+            rttVarianceMs = sampleMs / 2.0
+        } else {
+            rttVarianceMs = 0.75 * rttVarianceMs + 0.25 * Math.abs(smoothedRttMs - sampleMs)
+            smoothedRttMs = 0.875 * smoothedRttMs + 0.125 * sampleMs
+        }
+        retransmitTimeoutMs = (smoothedRttMs + maxOf(CLOCK_GRANULARITY_MS, 4.0 * rttVarianceMs))
+            .coerceIn(MIN_RTO_MS, MAX_RTO_MS)
+    }
+
+    companion object {
+        const val STREAM_CONTROL = 0
+        const val STREAM_CHAT = 1
+        const val STREAM_MAP = 2
+        const val STREAM_PING = 3
+        const val STREAM_COUNT = 4
+
+        fun isChannelPacket(datagram: String): Boolean =
+            datagram.startsWith("REL ") || datagram.startsWith("ACK ")
+    }
+}
@@ -0,0 +1,17 @@
+package com.guildmaster.server.network
+
+/**
+ * Wraparound-safe comparison of the 16-bit sequence numbers carried by unreliable messages.
+ */
+object SequenceNumbers {
+    private const val HALF_RANGE = 32768
+
+    /**
+     * True if [a] is newer than [b], taking wraparound into account
+     */
+    fun isNewer(a: Int, b: Int): Boolean {
+        val x = a and 0xFFFF
+        val y = b and 0xFFFF
+        return (x > y && x - y <= HALF_RANGE) || (x < y && y - x > HALF_RANGE)
+    }
+}
@@ -7,10 +7,15 @@ import com.guildmaster.server.session.PlayerSession
 import com.guildmaster.server.session.Response
 import com.guildmaster.server.session.SessionManager
 import kotlinx.serialization.SerializationException
+import java.io.ByteArrayOutputStream
 import java.net.InetSocketAddress
 import java.nio.ByteBuffer
 import java.nio.channels.SocketChannel
 
+private const val NEWLINE = '\n'.code.toByte()
+
+// Longest command line accepted; a client sending more without a newline is disconnected
+private const val MAX_LINE_BYTES = 64 * 1024
 
 class TcpClientHandler(
     private val sessionManager: SessionManager,
@@ -21,6 +26,9 @@ class TcpClientHandler(
     private var isRunning = true
     private var session: PlayerSession? = null
     
+    // Bytes of a line whose newline hasn't arrived yet
+    private val partialLine = ByteArrayOutputStream()
+    
     override fun run() {
         try {
             val buffer = ByteBuffer.allocate(1024)
@@ -31,12 +39,8 @@ class TcpClientHandler(
                     break
                 }
                 
-                buffer.flip()
-                val data = ByteArray(buffer.remaining())
-                buffer.get(data)
+                processIncomingData(buffer.array(), buffer.position())
                 buffer.clear()
-                
-                processIncomingData(String(data))
             }
         } catch (e: Exception) {
             if (isRunning) {
@@ -47,20 +51,48 @@ class TcpClientHandler(
         }
     }
     
-    private fun processIncomingData(data: String) {
-        data.split("\n").forEach { line ->
-            if (line.isBlank()) return@forEach
+    /**
+     * Split the first [length] bytes read into newline-terminated lines. A read can end
+     * mid-line, or mid-character, so the tail is kept until its newline arrives and each
+     * line is decoded as UTF-8 only once it is complete.
+     */
+    private fun processIncomingData(data: ByteArray, length: Int) {
+        var lineStart = 0
+        for (i in 0 until length) {
+            if (data[i] != NEWLINE) continue
             
-            try {
-                when {
-                    line.startsWith(Protocol.CMD_LOGIN) -> handleLogin(line)
-                    line.startsWith(Protocol.CMD_UDP_REGISTER) -> handleUdpRegistration(line)
-                    else -> handleCommand(line)
-                }
-            } catch (e: Exception) {
-                Logger.error(e) { "Error processing line: $line" }
-                sendMessage("ERROR Internal server error")
+            val line = if (partialLine.size() == 0) {
+                String(data, lineStart, i - lineStart, Charsets.UTF_8)
+            } else {
+                partialLine.write(data, lineStart, i - lineStart)
+                String(partialLine.toByteArray(), Charsets.UTF_8).also { partialLine.reset() }
             }
+            processLine(line)
+            lineStart = i + 1
+        }
+        
+        partialLine.write(data, lineStart, length - lineStart)
+        if (partialLine.size() > MAX_LINE_BYTES) {
+            Logger.warn { "Client $clientAddress sent a line over $MAX_LINE_BYTES bytes, disconnecting" }
+            isRunning = false
+        }
+    }
+    
+    private fun processLine(line: String) {
+        if (line.isBlank()) return
+        
+        try {
+            when {
+                line.startsWith(Protocol.CMD_LOGIN) -> handleLogin(line)
+                line.startsWith(Protocol.CMD_CONNECT) -> handleConnect(line)
+                line.startsWith(Protocol.CMD_RESUME) -> handleResume(line)
+                line.startsWith(Protocol.CMD_LOGOUT) -> handleLogout()
+                line.startsWith(Protocol.CMD_UDP_REGISTER) -> handleUdpRegistration(line)
+                else -> handleCommand(line)
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error processing line: $line" }
+            sendMessage("ERROR Internal server error")
         }
     }
 
@@ -88,6 +120,74 @@ class TcpClientHandler(
         }
     }
 
+    private fun handleConnect(message: String) {
+        try {
+            val data = Protocol.json.decodeFromString<Protocol.ConnectMessage>(
+                message.substring(Protocol.CMD_CONNECT.length).trim()
+            )
+
+            when (val result = sessionManager.createSession(data.name, data.color, clientAddress)) {
+                is Response.Success -> {
+                    session = result.data
+                    sendMessage("${Protocol.createConfigMessage(result.data.player, result.data.resumeToken)}\n")
+                }
+                is Response.Error -> {
+                    sendMessage("ERROR ${result.message}")
+                }
+            }
+        } catch (e: SerializationException) {
+            Logger.warn(e) { "Invalid connect JSON received: $message" }
+            sendMessage("ERROR Invalid connect JSON received")
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling connect" }
+            sendMessage("ERROR Failed to process connect")
+        }
+    }
+
+    /**
+     * Take over a session whose previous connection dropped. The client keeps its world
+     * and registers UDP again; it is sent only what changed while it was away.
+     */
+    private fun handleResume(message: String) {
+        try {
+            val data = Protocol.json.decodeFromString<Protocol.ResumeRequest>(
+                message.substring(Protocol.CMD_RESUME.length).trim()
+            )
+            val previousAddress = (sessionManager.getSessionByPlayerId(data.id) as? Response.Success)?.data?.tcpAddress
+
+            when (val result = sessionManager.resumeSession(data.id, data.token, clientAddress)) {
+                is Response.Success -> {
+                    session = result.data
+                    Logger.info { "Session ${data.id} resumed from $clientAddress" }
+                    sendMessage("${Protocol.createResumedMessage(data.id)}\n")
+                    previousAddress?.takeIf { it != clientAddress }?.let { tcpService.closeClient(it) }
+                    tcpService.onSessionResumed(result.data)
+                }
+                is Response.Error -> {
+                    sendMessage("${Protocol.createResumeFailedMessage(result.message)}\n")
+                }
+            }
+        } catch (e: SerializationException) {
+            Logger.warn(e) { "Invalid resume JSON received: $message" }
+            sendMessage("${Protocol.createResumeFailedMessage("Invalid resume request")}\n")
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling resume" }
+            sendMessage("${Protocol.createResumeFailedMessage("Failed to process resume")}\n")
+        }
+    }
+
+    /**
+     * The player quit. The session ends now rather than waiting out the resume grace
+     * period, and the disconnect that follows has nothing left to detach.
+     */
+    private fun handleLogout() {
+        session?.let { session ->
+            sessionManager.endSession(session.player.id, clientAddress)
+            Logger.info { "Session ${session.player.id} logged out" }
+        }
+        session = null
+    }
+
     private fun handleUdpRegistration(message: String) {
         try {
             val data = Protocol.json.decodeFromString<Protocol.UdpRegisterMessage>(
@@ -127,8 +227,10 @@ class TcpClientHandler(
     
     private fun handleDisconnect() {
         isRunning = false
+        // A connection that drops without LOGOUT keeps its session for a grace period,
+        // so the client can resume it
         session?.let { session ->
-            sessionManager.removeSession(session.player.id)
+            sessionManager.detachSession(session.player.id, clientAddress)
         }
         tcpService.removeClient(this)
         close()
@@ -1,6 +1,7 @@
 package com.guildmaster.server.network
 
 import com.guildmaster.server.Logger
+import com.guildmaster.server.session.PlayerSession
 import com.guildmaster.server.session.SessionManager
 import java.net.InetSocketAddress
 import java.nio.channels.ServerSocketChannel
@@ -20,6 +21,9 @@ class TcpService(
     // Thread-safe if multiple threads add/remove
     private val clients = CopyOnWriteArrayList<TcpClientHandler>()
 
+    // Called after a client resumes a detached session, to send what it missed
+    var onSessionResumed: (PlayerSession) -> Unit = {}
+
     fun start() {
         if (isRunning) return
 
@@ -54,8 +58,14 @@ class TcpService(
     }
 
     private fun handleNewConnection(clientChannel: SocketChannel) {
-        val clientAddress = clientChannel.remoteAddress as InetSocketAddress
+        adopt(clientChannel, clientChannel.remoteAddress as InetSocketAddress)
+    }
 
+    /**
+     * Serve a stream connection accepted elsewhere, e.g. on the unix socket. [clientAddress]
+     * identifies the client wherever a TCP peer address would.
+     */
+    fun adopt(clientChannel: SocketChannel, clientAddress: InetSocketAddress) {
         // Pass references that TcpClientHandler needs
         val client = TcpClientHandler(
             sessionManager = sessionManager,
@@ -77,6 +87,13 @@ class TcpService(
         }
     }
 
+    /**
+     * Close the connection from [target], e.g. one a resumed session has left behind
+     */
+    fun closeClient(target: InetSocketAddress) {
+        clients.find { it.clientAddress == target }?.close()
+    }
+
     fun removeClient(client: TcpClientHandler) {
         clients.remove(client)
     }
@@ -0,0 +1,220 @@
+package com.guildmaster.server.network
+
+import java.io.ByteArrayOutputStream
+import java.net.InetSocketAddress
+
+// Default datagram budget: fits the IPv6 minimum MTU (1280) after IP and UDP headers
+const val DEFAULT_MAX_DATAGRAM_BYTES = 1200
+
+// Largest payload a UDP datagram can carry; receive buffers are this big
+const val MAX_DATAGRAM_BYTES = 65507
+
+private const val MIN_DATAGRAM_BYTES = 128
+
+// "FRAG 65535 65535 65535 " is the longest fragment header
+private const val FRAGMENT_HEADER_RESERVE = 24
+
+private val AGGREGATE_PREFIX = "AGG ".toByteArray()
+private val FRAGMENT_PREFIX = "FRAG ".toByteArray()
+
+/**
+ * Datagram framing under the message protocol. Small messages queued together share one
+ * datagram and large ones are split across several, so no datagram exceeds the budget.
+ *
+ * Wire format (text, like the rest of the protocol):
+ *   <message>                                   one message, sent as-is
+ *   AGG <length>:<message><length>:<message>... several messages, lengths in bytes
+ *   FRAG <id> <index> <count> <bytes>           part of a datagram too large to send
+ * A reassembled FRAG payload is decoded again, so it may itself be an AGG.
+ *
+ * Not thread-safe; the owner serializes access.
+ */
+class UdpFramer(maxDatagramBytes: Int = DEFAULT_MAX_DATAGRAM_BYTES) {
+    val maxDatagramBytes = maxDatagramBytes.coerceIn(MIN_DATAGRAM_BYTES, MAX_DATAGRAM_BYTES)
+    private val queued = ArrayList<ByteArray>()
+
+    fun enqueue(message: ByteArray) {
+        queued.add(message)
+    }
+
+    fun isEmpty(): Boolean = queued.isEmpty()
+
+    /**
+     * Pack everything queued, in order, into as few datagrams as fit the budget.
+     * [nextFragmentId] numbers oversized payloads and must not repeat soon per receiver.
+     */
+    fun flush(nextFragmentId: () -> Int): List<ByteArray> {
+        val datagrams = ArrayList<ByteArray>()
+        val batch = ArrayList<ByteArray>()
+        var batchSize = AGGREGATE_PREFIX.size
+
+        fun emitBatch() {
+            when (batch.size) {
+                0 -> return
+                1 -> datagrams.add(batch[0])
+                else -> {
+                    val out = ByteArrayOutputStream(batchSize)
+                    out.write(AGGREGATE_PREFIX)
+                    batch.forEach { message ->
+                        out.write("${message.size}:".toByteArray())
+                        out.write(message)
+                    }
+                    datagrams.add(out.toByteArray())
+                }
+            }
+            batch.clear()
+            batchSize = AGGREGATE_PREFIX.size
+        }
+
+        queued.forEach { message ->
+            if (message.size > maxDatagramBytes) {
+                emitBatch()
+                fragment(message, nextFragmentId() and 0xFFFF, datagrams)
+                return@forEach
+            }
+
+            val framedSize = message.size.toString().length + 1 + message.size
+            if (batch.isNotEmpty() && batchSize + framedSize > maxDatagramBytes) {
+                emitBatch()
+            }
+            batch.add(message)
+            batchSize += framedSize
+        }
+        emitBatch()
+        queued.clear()
+        return datagrams
+    }
+
+    private fun fragment(payload: ByteArray, id: Int, datagrams: MutableList<ByteArray>) {
+        val partSize = maxDatagramBytes - FRAGMENT_HEADER_RESERVE
+        val count = (payload.size + partSize - 1) / partSize
+        for (index in 0 until count) {
+            val start = index * partSize
+            val end = minOf(payload.size, start + partSize)
+            datagrams.add("FRAG $id $index $count ".toByteArray() + payload.copyOfRange(start, end))
+        }
+    }
+}
+
+/**
+ * Inbound half of the framing: unpacks AGG datagrams and reassembles FRAG parts per sender.
+ * Partial payloads are dropped if the rest doesn't arrive within the timeout; fragments are
+ * never retransmitted, reliability stays with the layers above.
+ */
+class UdpReassembler(
+    private val maxFragments: Int = 64,
+    private val maxPendingPerSender: Int = 16,
+    private val timeoutMs: Long = 1000L
+) {
+    private class PartialPayload(count: Int, val firstSeenMs: Long) {
+        val parts = arrayOfNulls<ByteArray>(count)
+        var received = 0
+    }
+
+    private val pending = HashMap<InetSocketAddress, HashMap<Int, PartialPayload>>()
+
+    var malformedCount: Long = 0
+        private set
+
+    /**
+     * Decode a datagram into the complete messages it yields
+     */
+    @Synchronized
+    fun receive(sender: InetSocketAddress, datagram: ByteArray, nowMs: Long): List<String> {
+        val messages = ArrayList<String>()
+        decode(sender, datagram, nowMs, messages, nested = false)
+        return messages
+    }
+
+    /**
+     * Drop partial payloads that timed out
+     */
+    @Synchronized
+    fun expire(nowMs: Long) {
+        pending.values.forEach { partials -> partials.values.removeIf { nowMs - it.firstSeenMs > timeoutMs } }
+        pending.values.removeIf { it.isEmpty() }
+    }
+
+    private fun decode(sender: InetSocketAddress, datagram: ByteArray, nowMs: Long,
+                       messages: MutableList<String>, nested: Boolean) {
+        when {
+            datagram.startsWith(AGGREGATE_PREFIX) -> {
+                if (!unpackAggregate(datagram, messages)) malformedCount++
+            }
+
+            datagram.startsWith(FRAGMENT_PREFIX) -> {
+                // A reassembled payload is never itself fragmented
+                if (nested) malformedCount++ else addFragment(sender, datagram, nowMs, messages)
+            }
+
+            else -> messages.add(String(datagram))
+        }
+    }
+
+    private fun unpackAggregate(datagram: ByteArray, messages: MutableList<String>): Boolean {
+        var position = AGGREGATE_PREFIX.size
+        while (position < datagram.size) {
+            val (length, next) = parseField(datagram, position, ':'.code.toByte()) ?: return false
+            if (length > datagram.size - next) return false
+            messages.add(String(datagram, next, length))
+            position = next + length
+        }
+        return true
+    }
+
+    private fun addFragment(sender: InetSocketAddress, datagram: ByteArray, nowMs: Long, messages: MutableList<String>) {
+        val space = ' '.code.toByte()
+        val id = parseField(datagram, FRAGMENT_PREFIX.size, space)
+        val index = id?.let { parseField(datagram, it.second, space) }
+        val count = index?.let { parseField(datagram, it.second, space) }
+        if (id == null || index == null || count == null ||
+            count.first == 0 || count.first > maxFragments || index.first >= count.first ||
+            count.second >= datagram.size) {
+            malformedCount++
+            return
+        }
+        storeFragment(sender, id.first, index.first, count.first, datagram.copyOfRange(count.second, datagram.size),
+            nowMs, messages)
+    }
+
+    private fun storeFragment(sender: InetSocketAddress, id: Int, index: Int, count: Int, part: ByteArray,
+                              nowMs: Long, messages: MutableList<String>) {
+        val partials = pending.getOrPut(sender) { HashMap() }
+        var partial = partials[id]
+        if (partial == null || partial.parts.size != count) {
+            // Make room by dropping the oldest partial payload from this sender
+            if (partial == null && partials.size >= maxPendingPerSender) {
+                partials.minByOrNull { it.value.firstSeenMs }?.let { partials.remove(it.key) }
+            }
+            partial = PartialPayload(count, nowMs)
+            partials[id] = partial
+        }
+
+        if (partial.parts[index] != null) return // duplicate
+        partial.parts[index] = part
+        if (++partial.received < count) return
+
+        partials.remove(id)
+        if (partials.isEmpty()) pending.remove(sender)
+
+        val payload = ByteArrayOutputStream()
+        partial.parts.forEach { payload.write(it!!) }
+        decode(sender, payload.toByteArray(), nowMs, messages, nested = true)
+    }
+
+    // Parse a decimal number terminated by delimiter; returns it and the offset past the delimiter
+    private fun parseField(data: ByteArray, start: Int, delimiter: Byte): Pair<Int, Int>? {
+        var value = 0
+        var position = start
+        while (position < data.size && data[position].toInt().toChar() in '0'..'9') {
+            value = value * 10 + (data[position].toInt() - '0'.code)
+            if (value > MAX_DATAGRAM_BYTES * maxFragments) return null
+            position++
+        }
+        if (position == start || position >= data.size || data[position] != delimiter) return null
+        return value to position + 1
+    }
+
+    private fun ByteArray.startsWith(prefix: ByteArray): Boolean =
+        size >= prefix.size && prefix.indices.all { this[it] == prefix[it] }
+}
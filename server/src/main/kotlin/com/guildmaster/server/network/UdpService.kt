@@ -2,23 +2,99 @@ package com.guildmaster.server.network
 
 import com.guildmaster.server.Logger
 import com.guildmaster.server.broadcast.Broadcaster
+import com.guildmaster.server.broadcast.InterestManager
+import com.guildmaster.server.broadcast.InterestTransport
+import com.guildmaster.server.gameplay.GameService
+import com.guildmaster.server.gameplay.Movement
+import com.guildmaster.server.gameplay.MAX_INPUT_TICKS
+import com.guildmaster.server.session.PlayerSession
 import com.guildmaster.server.session.Response
 import com.guildmaster.server.session.SessionManager
+import com.guildmaster.server.session.ViewRect
 import java.net.InetSocketAddress
 import java.nio.ByteBuffer
 import java.nio.channels.DatagramChannel
+import java.nio.channels.SelectionKey
+import java.nio.channels.Selector
+import java.nio.channels.SocketChannel
+import java.util.concurrent.ConcurrentHashMap
 import java.util.concurrent.Executors
 import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+
+private const val RELIABLE_TICK_MS = 20L
+private const val RELIABLE_IDLE_TIMEOUT_MS = 60_000L
+private const val INTEREST_REFRESH_MS = 100L
+
+// How long outbound messages wait to be packed together before they are sent
+private const val UDP_FLUSH_MS = 10L
+
+// Length prefix on datagrams carried over a unix stream
+private const val STREAM_PEER_HEADER_BYTES = 4
+
+/**
+ * A unix stream carrying length-prefixed datagrams. The channel is non-blocking, so a
+ * client that stops reading can't stall the thread that sends to everyone: a frame the
+ * socket takes none of is dropped, as a full UDP socket buffer would drop it. A frame
+ * it takes only part of is finished before anything else is written, so the stream
+ * never carries half a frame.
+ */
+private class StreamPeer(val channel: SocketChannel) {
+    private var unsent: ByteBuffer? = null
+
+    init {
+        channel.configureBlocking(false)
+    }
+
+    /** Write [frame] without blocking; false if it was dropped */
+    @Synchronized
+    fun offer(frame: ByteBuffer): Boolean {
+        if (!flushUnsent()) return false
+        channel.write(frame)
+        if (frame.position() == 0) return false
+        if (frame.hasRemaining()) unsent = frame
+        return true
+    }
+
+    /** Continue a partly written frame; true once none is left */
+    @Synchronized
+    fun flushUnsent(): Boolean {
+        val pending = unsent ?: return true
+        channel.write(pending)
+        if (pending.hasRemaining()) return false
+        unsent = null
+        return true
+    }
+}
 
 
 class UdpService(
     private val sessionManager: SessionManager,
     private val broadcaster: Broadcaster,
-    private val port: Int
-) {
+    private val gameService: GameService,
+    private val port: Int,
+    private val maxDatagramBytes: Int = DEFAULT_MAX_DATAGRAM_BYTES
+) : InterestTransport {
     private var isRunning = false
     private lateinit var channel: DatagramChannel
     private val executor = Executors.newSingleThreadExecutor()
+    private val reliableScheduler = Executors.newSingleThreadScheduledExecutor { runnable ->
+        Thread(runnable, "udp-reliable-thread").apply { isDaemon = true }
+    }
+
+    // Reliable channel per remote UDP address
+    private val reliableChannels = ConcurrentHashMap<InetSocketAddress, ReliableUdpChannel>()
+
+    private val interestManager = InterestManager(sessionManager, this)
+
+    // Outbound messages per remote address, packed into datagrams on each flush
+    private val outbound = ConcurrentHashMap<InetSocketAddress, UdpFramer>()
+    private val nextFragmentId = AtomicInteger()
+    private val reassembler = UdpReassembler()
+
+    // Same-host clients whose datagrams arrive length-prefixed over a unix stream
+    private val streamPeers = ConcurrentHashMap<InetSocketAddress, StreamPeer>()
+    private val streamPeerExecutor = Executors.newCachedThreadPool()
 
     fun start() {
         if (isRunning) return
@@ -29,6 +105,7 @@ class UdpService(
             Logger.info { "UDP service started on port $port" }
 
             startListener()
+            startReliableTimer()
         } catch (e: Exception) {
             Logger.error(e) { "Failed to start UDP service" }
             stop()
@@ -45,10 +122,14 @@ class UdpService(
     private fun startListener() {
         executor.submit {
             try {
-                val buffer = ByteArray(1024)
+                val buffer = ByteBuffer.allocate(MAX_DATAGRAM_BYTES)
                 while (isRunning) {
-                    val sender = channel.receive(ByteBuffer.wrap(buffer)) as InetSocketAddress
-                    handlePacket(sender, buffer)
+                    buffer.clear()
+                    val sender = channel.receive(buffer) as InetSocketAddress
+                    buffer.flip()
+                    val data = ByteArray(buffer.remaining())
+                    buffer.get(data)
+                    handlePacket(sender, data)
                 }
             } catch (e: Exception) {
                 if (isRunning) {
@@ -58,21 +139,124 @@ class UdpService(
         }
     }
 
+    /**
+     * Take datagrams from a unix stream connection. Each one is framed with a 4-byte
+     * big-endian length and handled exactly like a UDP packet from [address], and
+     * datagrams sent to [address] are written back the same way.
+     */
+    fun adoptStreamPeer(peer: SocketChannel, address: InetSocketAddress) {
+        streamPeers[address] = StreamPeer(peer)
+        streamPeerExecutor.submit {
+            // Writes must not block, so reads wait on a selector instead
+            val selector = Selector.open()
+            try {
+                peer.register(selector, SelectionKey.OP_READ)
+                val header = ByteBuffer.allocate(STREAM_PEER_HEADER_BYTES)
+                while (isRunning) {
+                    header.clear()
+                    if (!readFully(peer, selector, header)) break
+                    val length = header.flip().int
+                    if (length < 0 || length > MAX_DATAGRAM_BYTES) {
+                        Logger.warn { "Dropping unix datagram peer $address: bad frame length $length" }
+                        break
+                    }
+                    val body = ByteBuffer.allocate(length)
+                    if (!readFully(peer, selector, body)) break
+                    handlePacket(address, body.array())
+                }
+            } catch (e: Exception) {
+                if (isRunning) {
+                    Logger.error(e) { "Unix datagram peer $address failed" }
+                }
+            } finally {
+                streamPeers.remove(address)
+                outbound.remove(address)
+                runCatching { selector.close() }
+                runCatching { peer.close() }
+            }
+        }
+    }
+
+    private fun readFully(peer: SocketChannel, selector: Selector, buffer: ByteBuffer): Boolean {
+        while (buffer.hasRemaining()) {
+            val read = peer.read(buffer)
+            if (read < 0) return false
+            if (read == 0) {
+                selector.select()
+                selector.selectedKeys().clear()
+                if (!peer.isOpen) return false
+            }
+        }
+        return true
+    }
+
+    private fun startReliableTimer() {
+        reliableScheduler.scheduleAtFixedRate({
+            try {
+                val now = System.currentTimeMillis()
+                reliableChannels.forEach { (address, reliable) ->
+                    reliable.update(now).forEach { packet -> sendPacket(address, packet) }
+                    // Skip markers are retransmitted until acknowledged, so a peer that went
+                    // away for good is recognised by its silence, not by an empty channel
+                    if (now - reliable.lastActivityMs > RELIABLE_IDLE_TIMEOUT_MS) {
+                        reliableChannels.remove(address)
+                    }
+                }
+                reassembler.expire(now)
+            } catch (e: Exception) {
+                Logger.error(e) { "Error updating reliable UDP channels" }
+            }
+        }, RELIABLE_TICK_MS, RELIABLE_TICK_MS, TimeUnit.MILLISECONDS)
+
+        reliableScheduler.scheduleAtFixedRate({
+            try {
+                interestManager.refreshAll()
+            } catch (e: Exception) {
+                Logger.error(e) { "Error refreshing interest sets" }
+            }
+        }, INTEREST_REFRESH_MS, INTEREST_REFRESH_MS, TimeUnit.MILLISECONDS)
+
+        reliableScheduler.scheduleAtFixedRate({
+            try {
+                flushOutbound()
+            } catch (e: Exception) {
+                Logger.error(e) { "Error flushing UDP messages" }
+            }
+        }, UDP_FLUSH_MS, UDP_FLUSH_MS, TimeUnit.MILLISECONDS)
+    }
+
     private fun handlePacket(sender: InetSocketAddress, data: ByteArray) {
+        val receivedAt = System.nanoTime()
         try {
-            val message = String(data).trim()
+            reassembler.receive(sender, data, System.currentTimeMillis()).forEach { received ->
+                val message = received.trim()
 
-            when {
-                message.startsWith(Protocol.CMD_POS) -> handlePositionUpdate(sender, message)
-//                message.startsWith(Protocol.CMD_ACTION) -> handleActionPacket(sender, message)
-                message.startsWith(Protocol.CMD_PING) -> sendPacket(sender, "${Protocol.MSG_PONG}\n")
-                message.startsWith(Protocol.CMD_UDP_REGISTER) -> handleUdpRegistration(sender, message)
+                if (ReliableUdpChannel.isChannelPacket(message)) {
+                    val reliable = reliableChannels.computeIfAbsent(sender) { ReliableUdpChannel() }
+                    reliable.receive(message)?.forEach { handleMessage(sender, it, reliable, receivedAt) }
+                } else {
+                    handleMessage(sender, message, null, receivedAt)
+                }
             }
         } catch (e: Exception) {
             Logger.error(e) { "Error processing UDP packet from $sender" }
         }
     }
 
+    private fun handleMessage(sender: InetSocketAddress, message: String, reliable: ReliableUdpChannel?, receivedAt: Long) {
+        when {
+            message.startsWith(Protocol.CMD_INPUT) -> handleInput(sender, message, receivedAt)
+            message.startsWith(Protocol.CMD_POS) -> handlePositionUpdate(sender, message)
+//            message.startsWith(Protocol.CMD_ACTION) -> handleActionPacket(sender, message)
+            message.startsWith(Protocol.CMD_PING) -> handlePing(sender, reliable)
+            message.startsWith(Protocol.CMD_CHAT) -> handleChat(sender, message)
+            message.startsWith(Protocol.CMD_UDP_REGISTER) -> handleUdpRegistration(sender, message, reliable)
+            message.startsWith(Protocol.CMD_MAP_CHANGE) -> handleMapChange(sender, message)
+            message.startsWith(Protocol.CMD_VIEW) -> handleView(sender, message)
+            message.startsWith(Protocol.CMD_CHUNK_REQ) -> handleChunkRequest(sender, message)
+        }
+    }
+
     private fun handlePositionUpdate(sender: InetSocketAddress, message: String) {
         try {
             val data = Protocol.json.decodeFromString<Protocol.PositionMessage>(
@@ -82,8 +266,14 @@ class UdpService(
             when (val sessionResult = sessionManager.getSessionByUdpAddress(sender)) {
                 is Response.Success -> {
                     val session = sessionResult.data
+                    if (!session.acceptPositionSequence(data.seq)) {
+                        Logger.debug { "Dropping stale position ${data.seq} from ${session.player.id}" }
+                        return
+                    }
                     sessionManager.updateMap(session.player.id, data.mapId)
-                    broadcaster.broadcastPositionUpdate(session.player.id, data.position, data.mapId)
+                    sessionManager.updatePosition(session.player.id, data.position)
+                    broadcaster.broadcastPositionUpdate(session.player.id, data.position, data.mapId, data.seq)
+                    interestManager.onPlayerMoved(session, data.seq)
                 }
 
                 is Response.Error -> {
@@ -95,6 +285,64 @@ class UdpService(
         }
     }
 
+    /**
+     * Each INPUT repeats every tick the client hasn't seen acknowledged, so a lost datagram
+     * is recovered from the next one; only ticks not applied yet move the player, at most
+     * [MAX_INPUT_TICKS] per batch and no faster than real time. The ack carries the
+     * position after the newest applied tick, for the client to replay its later inputs
+     * from, and echoes the client's timestamp with the time spent here since [receivedAt],
+     * so the client can tell server time from network time.
+     */
+    private fun handleInput(sender: InetSocketAddress, message: String, receivedAt: Long) {
+        try {
+            val data = Protocol.json.decodeFromString<Protocol.InputMessage>(
+                message.substring(Protocol.CMD_INPUT.length).trim()
+            )
+
+            if (data.moves.length > MAX_INPUT_TICKS) {
+                Logger.warn { "Dropping INPUT of ${data.moves.length} ticks from $sender" }
+                return
+            }
+
+            when (val sessionResult = sessionManager.getSessionByUdpAddress(sender)) {
+                is Response.Success -> {
+                    val session = sessionResult.data
+                    val window = session.acceptInputs(
+                        data.seq, data.moves.length, Movement.tickSeconds(data.dt), System.currentTimeMillis()
+                    )
+                    val ackSeq = window.ackSeq
+                    if (window.count > 0 && ackSeq != null) {
+                        val player = session.player
+                        when (val mapResult = gameService.getOrCreateMap(player.mapId)) {
+                            is Response.Success -> {
+                                val moves = data.moves.substring(window.offset, window.offset + window.count)
+                                val position = Movement.applyMoves(player.position, moves, data.dt, mapResult.data)
+                                sessionManager.updatePosition(player.id, position)
+                                session.updateUdpActivity()
+                                interestManager.onPlayerMoved(session, ackSeq)
+                            }
+
+                            is Response.Error -> {
+                                Logger.warn { "Failed to apply input for ${player.id}: ${mapResult.message}" }
+                            }
+                        }
+                    }
+                    if (ackSeq != null) {
+                        val serverMicros = data.t?.let { (System.nanoTime() - receivedAt) / 1_000 }
+                        val ack = Protocol.createInputAckMessage(ackSeq, data.t, serverMicros, session.player.position)
+                        sendPacket(sender, "$ack\n")
+                    }
+                }
+
+                is Response.Error -> {
+                    Logger.warn { "Session not found for UDP address $sender: ${sessionResult.message}" }
+                }
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling input from $sender" }
+        }
+    }
+
     private fun handleActionPacket(sender: InetSocketAddress, message: String) {
         try {
             val data = Protocol.json.decodeFromString<Protocol.ActionMessage>(
@@ -116,16 +364,21 @@ class UdpService(
         }
     }
 
-    private fun handleUdpRegistration(sender: InetSocketAddress, message: String) {
+    private fun handleUdpRegistration(sender: InetSocketAddress, message: String, reliable: ReliableUdpChannel?) {
         try {
             val data = Protocol.json.decodeFromString<Protocol.UdpRegisterMessage>(
-                message.substring(Protocol.CMD_UDP_REGISTER.length).trim()
+                message.substringAfter(' ').trim()
             )
 
             when (val result = sessionManager.updateUdpAddress(data.id, sender)) {
                 is Response.Success -> {
                     Logger.info { "UDP address registered for session ${data.id}" }
-                    sendPacket(sender, "${Protocol.MSG_UDP_REG}\n")
+                    val reply = "${Protocol.MSG_UDP_REGISTERED} {\"id\":\"${data.id}\"}"
+                    if (reliable != null) {
+                        reliable.send(reply, ReliableUdpChannel.STREAM_CONTROL)
+                    } else {
+                        sendPacket(sender, "$reply\n")
+                    }
                 }
 
                 is Response.Error -> {
@@ -137,12 +390,200 @@ class UdpService(
         }
     }
 
-    fun sendPacket(target: InetSocketAddress, message: String) {
+    private fun handlePing(sender: InetSocketAddress, reliable: ReliableUdpChannel?) {
+        sessionManager.getSessionByUdpAddress(sender).let { result ->
+            if (result is Response.Success) result.data.updateUdpActivity()
+        }
+        if (reliable != null) {
+            reliable.send(Protocol.MSG_PONG, ReliableUdpChannel.STREAM_PING)
+        } else {
+            sendPacket(sender, "${Protocol.MSG_PONG}\n")
+        }
+    }
+
+    private fun handleChat(sender: InetSocketAddress, message: String) {
         try {
-            channel.send(
-                ByteBuffer.wrap(message.toByteArray()),
-                target
+            val data = Protocol.json.decodeFromString<Protocol.ChatRequest>(
+                message.substring(Protocol.CMD_CHAT.length).trim()
             )
+
+            when (val sessionResult = sessionManager.getSessionByUdpAddress(sender)) {
+                is Response.Success -> {
+                    val player = sessionResult.data.player
+                    val chat = "${Protocol.MSG_CHAT} ${Protocol.encodeChatBroadcast(player.name, data.message)}"
+                    val recipients = sessionManager.getSessionsInMap(player.mapId)
+                    if (recipients is Response.Success) {
+                        recipients.data
+                            .filter { it.player.id != player.id }
+                            .forEach { sendReliable(it, chat, ReliableUdpChannel.STREAM_CHAT) }
+                    }
+                }
+
+                is Response.Error -> {
+                    Logger.warn { "Session not found for UDP address $sender: ${sessionResult.message}" }
+                }
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling chat from $sender" }
+        }
+    }
+
+    private fun handleView(sender: InetSocketAddress, message: String) {
+        try {
+            val data = Protocol.json.decodeFromString<Protocol.ViewRequest>(
+                message.substring(Protocol.CMD_VIEW.length).trim()
+            )
+
+            when (val sessionResult = sessionManager.getSessionByUdpAddress(sender)) {
+                is Response.Success -> {
+                    interestManager.setView(sessionResult.data, ViewRect(data.x, data.y, data.width, data.height))
+                }
+
+                is Response.Error -> {
+                    Logger.warn { "Session not found for UDP address $sender: ${sessionResult.message}" }
+                }
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling view update from $sender" }
+        }
+    }
+
+    /**
+     * Chunks are too large for one datagram, so they go back over the TCP stream
+     */
+    private fun handleChunkRequest(sender: InetSocketAddress, message: String) {
+        try {
+            val data = Protocol.json.decodeFromString<Protocol.ChunkRequest>(
+                message.substring(Protocol.CMD_CHUNK_REQ.length).trim()
+            )
+
+            when (val sessionResult = sessionManager.getSessionByUdpAddress(sender)) {
+                is Response.Success -> {
+                    // Only the map the player is on, so requests can't load maps at will
+                    val mapId = sessionResult.data.player.mapId
+                    if (data.mapId != mapId) {
+                        Logger.debug { "Ignoring chunk request for ${data.mapId} from a player on $mapId" }
+                        return
+                    }
+                    when (val mapResult = gameService.getOrCreateMap(mapId)) {
+                        is Response.Success -> {
+                            val chunk = Protocol.createChunkMessage(mapResult.data, data.cx, data.cy)
+                            broadcaster.broadcastToPlayer(sessionResult.data.player, "$chunk\n")
+                        }
+
+                        is Response.Error -> {
+                            Logger.warn { "Failed to serve chunk ${data.cx},${data.cy} of ${data.mapId}: ${mapResult.message}" }
+                        }
+                    }
+                }
+
+                is Response.Error -> {
+                    Logger.warn { "Session not found for UDP address $sender: ${sessionResult.message}" }
+                }
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling chunk request from $sender" }
+        }
+    }
+
+    /**
+     * Send a resumed session what changed while it was detached. Viewers get interest
+     * differences; sessions without a view get their map's roster.
+     */
+    fun resync(session: PlayerSession) {
+        if (session.viewRect != null) {
+            interestManager.resync(session)
+        } else {
+            broadcaster.broadcastPlayersList(session.player.mapId)
+        }
+    }
+
+    /**
+     * Send a must-arrive message on a stream, falling back to TCP for sessions without a UDP address.
+     * Detached sessions are skipped; resync() catches them up if they resume.
+     */
+    fun sendReliable(session: PlayerSession, message: String, stream: Int) {
+        if (session.isDetached) return
+        val address = session.udpAddress
+        if (address == null) {
+            broadcaster.broadcastToPlayer(session.player, "$message\n")
+            return
+        }
+        reliableChannels.computeIfAbsent(address) { ReliableUdpChannel() }.send(message, stream)
+    }
+
+    // Interest ENTER/LEAVE share the map stream so they stay ordered with map changes
+    override fun sendReliable(session: PlayerSession, message: String) =
+        sendReliable(session, message, ReliableUdpChannel.STREAM_MAP)
+
+    override fun sendUnreliable(session: PlayerSession, message: String) {
+        if (session.isDetached) return
+        session.udpAddress?.let { sendPacket(it, "$message\n") }
+            ?: broadcaster.broadcastToPlayer(session.player, "$message\n")
+    }
+
+    private fun handleMapChange(sender: InetSocketAddress, message: String) {
+        try {
+            val data = Protocol.json.decodeFromString<Protocol.MapChangeRequest>(
+                message.substring(Protocol.CMD_MAP_CHANGE.length).trim()
+            )
+
+            when (val sessionResult = sessionManager.getSessionByUdpAddress(sender)) {
+                is Response.Success -> {
+                    val session = sessionResult.data
+                    val previousMapId = session.player.mapId
+                    sessionManager.updateMap(session.player.id, data.mapId)
+                    broadcaster.broadcastPlayersList(previousMapId)
+                    broadcaster.broadcastPlayersList(data.mapId)
+                }
+
+                is Response.Error -> {
+                    Logger.warn { "Session not found for UDP address $sender: ${sessionResult.message}" }
+                }
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error handling map change from $sender" }
+        }
+    }
+
+    /**
+     * Queue a message for [target]; it goes out on the next flush, packed with the other
+     * messages queued for that address
+     */
+    fun sendPacket(target: InetSocketAddress, message: String) {
+        outbound.compute(target) { _, framer ->
+            (framer ?: UdpFramer(maxDatagramBytes)).apply { enqueue(message.toByteArray()) }
+        }
+    }
+
+    private fun flushOutbound() {
+        // Finish frames a backed-up unix peer only took part of
+        streamPeers.values.forEach { peer -> runCatching { peer.flushUnsent() } }
+
+        outbound.keys.forEach { target ->
+            var datagrams: List<ByteArray> = emptyList()
+            outbound.computeIfPresent(target) { _, framer ->
+                datagrams = framer.flush { nextFragmentId.getAndIncrement() }
+                null
+            }
+            datagrams.forEach { sendDatagram(target, it) }
+        }
+    }
+
+    private fun sendDatagram(target: InetSocketAddress, datagram: ByteArray) {
+        try {
+            val peer = streamPeers[target]
+            if (peer != null) {
+                val frame = ByteBuffer.allocate(STREAM_PEER_HEADER_BYTES + datagram.size)
+                    .putInt(datagram.size)
+                    .put(datagram)
+                    .flip()
+                if (!peer.offer(frame)) {
+                    Logger.debug { "Unix datagram peer $target is not reading, dropped ${datagram.size} bytes" }
+                }
+            } else {
+                channel.send(ByteBuffer.wrap(datagram), target)
+            }
         } catch (e: Exception) {
             Logger.error(e) { "Error sending UDP packet to $target" }
         }
@@ -156,6 +597,10 @@ class UdpService(
 
         try {
             channel.close()
+            streamPeers.values.forEach { runCatching { it.channel.close() } }
+            streamPeers.clear()
+            reliableScheduler.shutdown()
+            streamPeerExecutor.shutdownNow()
             executor.shutdown()
 
             if (!executor.awaitTermination(5, TimeUnit.SECONDS)) {
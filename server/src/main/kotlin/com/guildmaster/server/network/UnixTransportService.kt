@@ -0,0 +1,136 @@
+package com.guildmaster.server.network
+
+import com.guildmaster.server.Logger
+import java.net.InetSocketAddress
+import java.net.StandardProtocolFamily
+import java.net.UnixDomainSocketAddress
+import java.nio.ByteBuffer
+import java.nio.channels.ServerSocketChannel
+import java.nio.channels.SocketChannel
+import java.nio.file.Files
+import java.nio.file.Path
+import java.util.concurrent.Executors
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+
+// Longest first line a connection may send to say what it carries
+private const val MAX_HELLO_BYTES = 16
+
+private const val HELLO_STREAM = "STREAM"
+private const val HELLO_DGRAM = "DGRAM"
+
+// Host of the synthetic addresses unix clients are known by
+private const val UNIX_PEER_HOST = "unix"
+
+/**
+ * Accepts same-host clients on a unix domain socket, which skips the loopback IP stack.
+ *
+ * A client opens two connections to [path]. The first line of each names its channel:
+ * `STREAM` connections are served by [tcpService] exactly like TCP clients, and `DGRAM`
+ * connections carry length-prefixed datagrams into [udpService]. The JVM has no unix
+ * datagram sockets, so both are streams. Each connection gets an unresolved
+ * `unix:<n>` address standing in for its peer address, so sessions, registration and
+ * broadcasting need no changes.
+ */
+class UnixTransportService(
+    private val path: String,
+    private val tcpService: TcpService,
+    private val udpService: UdpService,
+) {
+    private var isRunning = false
+    private lateinit var channel: ServerSocketChannel
+    private val executor = Executors.newCachedThreadPool()
+    private val nextPeerId = AtomicInteger(1)
+
+    fun start() {
+        if (isRunning) return
+
+        try {
+            // A socket file left by a previous run would make the bind fail
+            Files.deleteIfExists(Path.of(path))
+            channel = ServerSocketChannel.open(StandardProtocolFamily.UNIX).apply {
+                configureBlocking(true)
+                bind(UnixDomainSocketAddress.of(path))
+            }
+            isRunning = true
+            Logger.info { "Unix socket service started on $path" }
+
+            startListener()
+        } catch (e: Exception) {
+            Logger.error(e) { "Failed to start unix socket service" }
+            stop()
+        }
+    }
+
+    private fun startListener() {
+        executor.submit {
+            try {
+                while (isRunning) {
+                    val clientChannel = channel.accept() ?: continue
+                    // The hello is read off the accept thread so a slow client can't stall it
+                    executor.submit { handleNewConnection(clientChannel) }
+                }
+            } catch (e: Exception) {
+                if (isRunning) {
+                    Logger.error(e) { "Unix socket listener error" }
+                }
+            }
+        }
+    }
+
+    private fun handleNewConnection(clientChannel: SocketChannel) {
+        // Ids wrap within the port range; connections that old are long gone
+        val address = InetSocketAddress.createUnresolved(UNIX_PEER_HOST, nextPeerId.getAndIncrement() and 0xFFFF)
+
+        try {
+            when (val hello = readHello(clientChannel)) {
+                HELLO_STREAM -> tcpService.adopt(clientChannel, address)
+                HELLO_DGRAM -> udpService.adoptStreamPeer(clientChannel, address)
+                else -> {
+                    Logger.warn { "Unknown unix socket channel '$hello', closing" }
+                    clientChannel.close()
+                }
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error accepting unix socket client" }
+            runCatching { clientChannel.close() }
+        }
+    }
+
+    /**
+     * Read the first line a byte at a time, so nothing after it is consumed before the
+     * connection is handed over
+     */
+    private fun readHello(clientChannel: SocketChannel): String? {
+        val hello = StringBuilder()
+        val byte = ByteBuffer.allocate(1)
+        while (hello.length < MAX_HELLO_BYTES) {
+            byte.clear()
+            if (clientChannel.read(byte) < 0) return null
+            val c = byte.get(0).toInt().toChar()
+            if (c == '\n') return hello.toString()
+            hello.append(c)
+        }
+        return null
+    }
+
+    fun stop() {
+        if (!isRunning) return
+        isRunning = false
+
+        Logger.info { "Stopping unix socket service..." }
+        try {
+            channel.close()
+            Files.deleteIfExists(Path.of(path))
+
+            executor.shutdown()
+            if (!executor.awaitTermination(5, TimeUnit.SECONDS)) {
+                executor.shutdownNow()
+            }
+
+            Logger.info { "Unix socket service stopped" }
+        } catch (e: Exception) {
+            Logger.error(e) { "Error stopping unix socket service" }
+        }
+    }
+}
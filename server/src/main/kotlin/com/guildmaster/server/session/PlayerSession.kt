@@ -1,9 +1,26 @@
 package com.guildmaster.server.session
 
+import com.guildmaster.server.network.SequenceNumbers
 import com.guildmaster.server.player.Player
 import java.net.InetSocketAddress
+import java.security.SecureRandom
+import java.util.HexFormat
+import java.util.concurrent.ConcurrentHashMap
 import org.joml.Vector2f
 
+// Input ticks are simulated no faster than wall-clock time, times this slack for jitter
+private const val INPUT_ALLOWANCE_RATE = 1.1f
+
+// Simulated seconds that may build up while a client is quiet; just over a full input
+// history at 60 ticks per second
+private const val INPUT_ALLOWANCE_MAX_SECONDS = 2.5f
+
+/**
+ * The ticks of an INPUT batch to simulate: [count] moves starting [offset] characters
+ * into it. [ackSeq] is the newest tick applied so far, null before the first.
+ */
+data class InputWindow(val offset: Int, val count: Int, val ackSeq: Int?)
+
 /**
  * Represents a connected player session on the server.
  * Stores all relevant information about the player during the session.
@@ -22,6 +39,37 @@ data class PlayerSession(
     
     private var lastUdpActivity: Long = System.currentTimeMillis()
 ) {
+    // Newest position sequence number accepted from this player
+    private var lastPositionSeq: Int? = null
+
+    // Newest input tick applied for this player
+    private var lastInputSeq: Int? = null
+
+    // Simulated seconds of input this player may still be moved by
+    private var inputAllowanceSeconds = INPUT_ALLOWANCE_MAX_SECONDS
+    private var inputAllowanceAt = System.currentTimeMillis()
+
+    // Number of stale or duplicate position datagrams dropped
+    var stalePositionCount: Long = 0
+        private set
+
+    // Area this client wants updates for; null keeps the legacy whole-map broadcasts
+    @Volatile
+    var viewRect: ViewRect? = null
+
+    // Players this client has been sent ENTER for and not yet LEAVE
+    val interestSet: MutableSet<String> = ConcurrentHashMap.newKeySet()
+
+    // Secret the client presents to take this session back after its connection drops
+    val resumeToken: String = newResumeToken()
+
+    // When the connection dropped; null while a client is attached
+    @Volatile
+    var detachedAt: Long? = null
+
+    val isDetached: Boolean
+        get() = detachedAt != null
+
     // Constructor for simplified session creation
     constructor(id: String, name: String, color: String) : this(
         player = Player(id = id, name = name, color = color)
@@ -49,6 +97,49 @@ data class PlayerSession(
         updateUdpActivity()
     }
     
+    /**
+     * Accept a position sequence number, rejecting datagrams older than the last one accepted.
+     * Messages without a sequence number are always accepted.
+     */
+    @Synchronized
+    fun acceptPositionSequence(seq: Int?): Boolean {
+        if (seq == null) return true
+        val last = lastPositionSeq
+        if (last != null && !SequenceNumbers.isNewer(seq, last)) {
+            stalePositionCount++
+            return false
+        }
+        lastPositionSeq = seq
+        return true
+    }
+
+    /**
+     * Accept a batch of [count] consecutive input ticks of [tickSeconds] each, ending at
+     * [seq]. Batches repeat unacknowledged ticks, so only the ticks not applied yet are
+     * returned, and of those no more than wall-clock time since the last batches allows.
+     * Ticks held back stay unacknowledged, so the client sends them again.
+     */
+    @Synchronized
+    fun acceptInputs(seq: Int, count: Int, tickSeconds: Float, nowMs: Long): InputWindow {
+        val last = lastInputSeq
+        val fresh = when {
+            last == null -> count
+            !SequenceNumbers.isNewer(seq, last) -> 0
+            else -> minOf(count, (seq - last) and 0xFFFF)
+        }
+
+        inputAllowanceSeconds = minOf(
+            INPUT_ALLOWANCE_MAX_SECONDS,
+            inputAllowanceSeconds + (nowMs - inputAllowanceAt).coerceAtLeast(0) / 1000f * INPUT_ALLOWANCE_RATE
+        )
+        inputAllowanceAt = nowMs
+        val allowed = if (tickSeconds > 0f) minOf(fresh, (inputAllowanceSeconds / tickSeconds).toInt()) else fresh
+        inputAllowanceSeconds -= allowed * tickSeconds
+
+        if (allowed > 0) lastInputSeq = (seq - (fresh - allowed)) and 0xFFFF
+        return InputWindow(offset = count - fresh, count = allowed, ackSeq = lastInputSeq)
+    }
+
     /**
      * Convert the session to a simplified representation for sending to the client
      */
@@ -61,4 +152,11 @@ data class PlayerSession(
         val now = System.currentTimeMillis()
         return (now - lastTcpActivity > timeoutMs) && (now - lastUdpActivity > timeoutMs)
     }
-} 
\ No newline at end of file
+
+    private companion object {
+        val random = SecureRandom()
+
+        fun newResumeToken(): String =
+            HexFormat.of().formatHex(ByteArray(16).also { random.nextBytes(it) })
+    }
+}
@@ -4,6 +4,7 @@ import com.guildmaster.server.Logger
 import com.guildmaster.server.player.Player
 import org.joml.Vector2f
 import java.net.InetSocketAddress
+import java.security.MessageDigest
 import java.util.*
 import java.util.concurrent.ConcurrentHashMap
 import java.util.concurrent.Executors
@@ -12,6 +13,7 @@ import java.util.concurrent.locks.ReentrantLock
 import kotlin.concurrent.withLock
 
 private const val INACTIVITY_TIMEOUT_MS = 30_000L
+private const val RESUME_GRACE_MS = 20_000L
 private const val INACTIVITY_CHECK_INTERVAL_S = 10L
 private const val SCHEDULER_SHUTDOWN_TIMEOUT_S = 5L
 
@@ -20,6 +22,7 @@ class SessionManager {
     private val tcpAddressToSessionId = ConcurrentHashMap<InetSocketAddress, String>()
     private val udpAddressToSessionId = ConcurrentHashMap<InetSocketAddress, String>()
     private val mapToSessions = ConcurrentHashMap<String, MutableSet<String>>()
+    private val mapGrids = ConcurrentHashMap<String, SpatialGrid>()
     private val lock = ReentrantLock()
     private val scheduler = Executors.newSingleThreadScheduledExecutor { runnable ->
         Thread(runnable, "session-cleanup-thread").apply { isDaemon = true }
@@ -42,7 +45,7 @@ class SessionManager {
         }
     }
 
-    fun createSession(name: String, color: String): Response<PlayerSession> {
+    fun createSession(name: String, color: String, tcpAddress: InetSocketAddress? = null): Response<PlayerSession> {
         return try {
             val playerId = UUID.randomUUID().toString()
             val player = Player(
@@ -52,8 +55,9 @@ class SessionManager {
                 position = Vector2f(0f, 0f),
                 mapId = "default"
             )
-            val session = PlayerSession(player, null)
+            val session = PlayerSession(player, tcpAddress)
             sessions[playerId] = session
+            tcpAddress?.let { tcpAddressToSessionId[it] = playerId }
             addSessionToMap(playerId, "default")
             Response.Success(session)
         } catch (e: Exception) {
@@ -99,6 +103,7 @@ class SessionManager {
             val session = sessions[playerId]
                 ?: return Response.Error("Session not found for player ID: $playerId")
             session.player.position.set(newPos)
+            mapGrids[session.player.mapId]?.update(playerId, newPos.x, newPos.y)
             Response.Success(Unit)
         } catch (e: Exception) {
             Logger.error(e) { "Failed to update position for player $playerId" }
@@ -120,6 +125,23 @@ class SessionManager {
         }
     }
 
+    fun getSessionsInArea(mapId: String, area: ViewRect): Response<List<PlayerSession>> {
+        if (mapId.isBlank()) {
+            return Response.Error("Map ID cannot be blank")
+        }
+        return try {
+            val grid = mapGrids[mapId] ?: return Response.Success(emptyList())
+            Response.Success(
+                grid.query(area)
+                    .mapNotNull { sessions[it] }
+                    .filter { area.contains(it.player.position.x, it.player.position.y) }
+            )
+        } catch (e: Exception) {
+            Logger.error(e) { "Failed to get sessions in area of map $mapId" }
+            Response.Error("Failed to get sessions in area: ${e.message}")
+        }
+    }
+
     fun getAllPlayers(): Response<List<Player>> {
         return try {
             Response.Success(sessions.values.map { it.player })
@@ -144,6 +166,75 @@ class SessionManager {
         }
     }
 
+    /**
+     * Keep a session whose connection from [tcpAddress] dropped, so the client can resume it
+     * within the grace period. Does nothing if the session has already moved to another
+     * connection.
+     */
+    fun detachSession(playerId: String, tcpAddress: InetSocketAddress): Response<Unit> {
+        return try {
+            lock.withLock {
+                val session = sessions[playerId]
+                    ?: return Response.Error("Session not found for player ID: $playerId")
+                if (session.tcpAddress != tcpAddress) {
+                    return Response.Success(Unit)
+                }
+                tcpAddressToSessionId.remove(tcpAddress)
+                session.udpAddress?.let { udpAddressToSessionId.remove(it) }
+                session.tcpAddress = null
+                session.udpAddress = null
+                session.detachedAt = System.currentTimeMillis()
+            }
+            Logger.info { "Session $playerId detached, resumable for ${RESUME_GRACE_MS / 1000}s" }
+            Response.Success(Unit)
+        } catch (e: Exception) {
+            Logger.error(e) { "Failed to detach session for player $playerId" }
+            Response.Error("Failed to detach session: ${e.message}")
+        }
+    }
+
+    /**
+     * End a session its client logged out of over the connection at [tcpAddress]. Does
+     * nothing if the session has already moved to another connection.
+     */
+    fun endSession(playerId: String, tcpAddress: InetSocketAddress): Response<Unit> {
+        return lock.withLock {
+            val session = sessions[playerId]
+                ?: return Response.Error("Session not found for player ID: $playerId")
+            if (session.tcpAddress != tcpAddress) {
+                return Response.Success(Unit)
+            }
+            removeSession(playerId)
+        }
+    }
+
+    /**
+     * Move a session to the connection at [tcpAddress] if [token] matches its resume token.
+     * The session may still be attached when the server has not noticed its old connection
+     * drop yet; that connection no longer owns it afterwards. UDP registers again.
+     */
+    fun resumeSession(playerId: String, token: String, tcpAddress: InetSocketAddress): Response<PlayerSession> {
+        return try {
+            lock.withLock {
+                val session = sessions[playerId]
+                if (session == null || !MessageDigest.isEqual(session.resumeToken.toByteArray(), token.toByteArray())) {
+                    return Response.Error("Session expired")
+                }
+                session.tcpAddress?.let { tcpAddressToSessionId.remove(it) }
+                session.udpAddress?.let { udpAddressToSessionId.remove(it) }
+                session.tcpAddress = tcpAddress
+                session.udpAddress = null
+                session.detachedAt = null
+                session.updateTcpActivity()
+                tcpAddressToSessionId[tcpAddress] = playerId
+                Response.Success(session)
+            }
+        } catch (e: Exception) {
+            Logger.error(e) { "Failed to resume session for player $playerId" }
+            Response.Error("Failed to resume session: ${e.message}")
+        }
+    }
+
     fun updateMap(targetSessionId: String, newMapId: String): Response<Unit> {
         val session = sessions[targetSessionId]
             ?: return Response.Error("Session not found for player ID: $targetSessionId")
@@ -183,6 +274,11 @@ class SessionManager {
 
     private fun addSessionToMap(targetSessionId: String, targetMapId: String) {
         mapToSessions.computeIfAbsent(targetMapId) { mutableSetOf() }.add(targetSessionId)
+        sessions[targetSessionId]?.player?.position?.let { position ->
+            mapGrids.compute(targetMapId) { _, grid ->
+                (grid ?: SpatialGrid()).also { it.update(targetSessionId, position.x, position.y) }
+            }
+        }
     }
 
     private fun removeSessionFromMap(targetSessionId: String, sourceMapId: String) {
@@ -190,6 +286,10 @@ class SessionManager {
         if (mapToSessions[sourceMapId]?.isEmpty() == true) {
             mapToSessions.remove(sourceMapId)
         }
+        mapGrids.computeIfPresent(sourceMapId) { _, grid ->
+            grid.remove(targetSessionId)
+            if (grid.isEmpty()) null else grid
+        }
     }
 
     private fun cleanupSessionResources(session: PlayerSession) {
@@ -209,7 +309,8 @@ class SessionManager {
 
     private fun removeInactiveSessions() {
         sessions.values.forEach { session ->
-            if (session.isInactive(INACTIVITY_TIMEOUT_MS)) {
+            val expired = session.detachedAt?.let { System.currentTimeMillis() - it > RESUME_GRACE_MS } ?: false
+            if (expired || session.isInactive(INACTIVITY_TIMEOUT_MS)) {
                 removeSession(session.player.id)
             }
         }
@@ -0,0 +1,77 @@
+package com.guildmaster.server.session
+
+import kotlin.math.floor
+
+private const val DEFAULT_CELL_SIZE = 256f
+
+/**
+ * Axis-aligned rectangle in world coordinates, used for client view areas.
+ */
+data class ViewRect(val x: Float, val y: Float, val width: Float, val height: Float) {
+    fun contains(px: Float, py: Float): Boolean =
+        px >= x && px < x + width && py >= y && py < y + height
+
+    fun expanded(margin: Float): ViewRect =
+        ViewRect(x - margin, y - margin, width + 2 * margin, height + 2 * margin)
+
+    fun clamped(maxExtent: Float): ViewRect =
+        ViewRect(x, y, width.coerceIn(0f, maxExtent), height.coerceIn(0f, maxExtent))
+}
+
+/**
+ * Uniform grid over the player positions of one map. Area queries only visit the
+ * cells overlapping the area, so their cost follows local density rather than the
+ * number of players in the map.
+ */
+class SpatialGrid(private val cellSize: Float = DEFAULT_CELL_SIZE) {
+    private val cells = HashMap<Long, MutableSet<String>>()
+    private val cellOfPlayer = HashMap<String, Long>()
+
+    /**
+     * Insert a player or move it to the cell containing (x, y)
+     */
+    @Synchronized
+    fun update(playerId: String, x: Float, y: Float) {
+        val key = cellKey(cellCoord(x), cellCoord(y))
+        val previous = cellOfPlayer[playerId]
+        if (previous == key) return
+
+        previous?.let { removeFromCell(playerId, it) }
+        cells.getOrPut(key) { HashSet() }.add(playerId)
+        cellOfPlayer[playerId] = key
+    }
+
+    @Synchronized
+    fun remove(playerId: String) {
+        cellOfPlayer.remove(playerId)?.let { removeFromCell(playerId, it) }
+    }
+
+    /**
+     * Ids of players in cells overlapping the area. Callers filter by exact position.
+     */
+    @Synchronized
+    fun query(area: ViewRect): List<String> {
+        val result = ArrayList<String>()
+        for (cx in cellCoord(area.x)..cellCoord(area.x + area.width)) {
+            for (cy in cellCoord(area.y)..cellCoord(area.y + area.height)) {
+                cells[cellKey(cx, cy)]?.let { result.addAll(it) }
+            }
+        }
+        return result
+    }
+
+    @Synchronized
+    fun isEmpty(): Boolean = cellOfPlayer.isEmpty()
+
+    private fun removeFromCell(playerId: String, key: Long) {
+        val cell = cells[key] ?: return
+        cell.remove(playerId)
+        if (cell.isEmpty()) {
+            cells.remove(key)
+        }
+    }
+
+    private fun cellCoord(value: Float): Int = floor(value / cellSize).toInt()
+
+    private fun cellKey(cx: Int, cy: Int): Long = (cx.toLong() shl 32) or (cy.toLong() and 0xFFFFFFFFL)
+}